@@ -0,0 +1,96 @@
+/** @headerfile bench.h
+ *  @brief Function prototypes for the runtime benchmark engine
+ *
+ *  @author Yll Kryeziu (ge94noh)
+ */
+
+#ifndef IMPLEMENTIERUNG_BENCH_H
+#define IMPLEMENTIERUNG_BENCH_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "parser.h"
+
+#define BENCH_WARMUP 5      // Untimed calls before the measurement, to fault in pages and warm up caches and branch predictors
+#define BENCH_REPS 101      // Maximum number of timed calls, odd so that the median is one of the measured values
+#define BENCH_MIN_REPS 11   // Minimum number of timed calls
+#define BENCH_MAX_TIME 0.25 // Time in seconds after which no more calls are timed once BENCH_MIN_REPS are reached
+#define BENCH_CHAIN 256     // Number of dependent calls timed together by bench_latency
+#define BENCH_CHAIN_REPS 51 // Number of timed chains of bench_latency, odd so that the median is one of the measured values
+
+/**
+ * @brief Statistics of the timed calls of one kernel
+ */
+struct BenchResult
+{
+    double median;           // Median time of one call in seconds
+    double p5;               // 5th percentile of the time of one call in seconds
+    double p95;              // 95th percentile of the time of one call in seconds
+    double p99;              // 99th percentile of the time of one call in seconds
+    double cyclesPerElement; // Median number of time stamp counter cycles per element
+    double gbps;             // Bytes read and written per second at the median time, in GB/s
+};
+
+/**
+ * @brief Measure the runtime of a kernel on the given input
+ *
+ * @details The calling thread is pinned to the core it currently runs on for the duration of the
+ * measurement. After BENCH_WARMUP untimed calls, the kernel is called BENCH_REPS times, or at least
+ * BENCH_MIN_REPS times until BENCH_MAX_TIME seconds are spent for large arrays. Every call
+ * is timed with clock_gettime and with the time stamp counter (rdtsc/rdtscp, fenced so that the kernel
+ * cannot be reordered around it). Note that the time stamp counter runs at a constant reference
+ * frequency, which is not necessarily the current core clock.
+ *
+ * @param db db = 0 if fn is a float kernel; db = 1 if fn is a double kernel
+ * @param fn Kernel to measure
+ * @param n Number of values in the arrays
+ * @param vals Pointer to the input array
+ * @param out Pointer to the output array
+ * @param res Pointer to the struct where the statistics are written
+ */
+void bench_run(int db, Func fn, size_t n, void *vals, void *out, struct BenchResult *res);
+
+/**
+ * @brief Function that calls a kernel calls times in place on buf, so that every call depends on the result
+ * of the previous one
+ *
+ * @param arg Kernel specific argument as passed to bench_latency
+ * @param n Number of values in buf
+ * @param buf Pointer to the array that is input and output of every call
+ * @param calls Number of calls
+ */
+typedef void (*BenchChain)(const void *arg, size_t n, void *buf, size_t calls);
+
+/**
+ * @brief Measure the latency of a kernel for small n with a dependent chain of calls
+ *
+ * @details bench_run measures independent calls, which the CPU can overlap, so for small n it shows
+ * the throughput. Here chain calls the kernel BENCH_CHAIN times in place, each call reading the
+ * results of the previous one, and the chain is timed with the time stamp counter. The median over
+ * BENCH_CHAIN_REPS chains is divided by BENCH_CHAIN. The thread is pinned as in bench_run.
+ * For the Fast Inverse Square Root the values converge towards 1 in such a chain and stay finite.
+ *
+ * @param chain Function calling the kernel
+ * @param arg Argument passed to chain
+ * @param n Number of values in buf
+ * @param buf Pointer to the array of n values, initialized with positive values
+ * @return Median number of time stamp counter cycles of one call
+ */
+double bench_latency(BenchChain chain, const void *arg, size_t n, void *buf);
+
+/**
+ * @brief Write the header of the .csv format used by bench_print to file
+ */
+void bench_print_header(FILE *file);
+
+/**
+ * @brief Write one line with sample size, kernel name and statistics to a .csv file
+ *
+ * @param file File to write to
+ * @param n Number of values the kernel was measured with
+ * @param name Name of the kernel
+ * @param res Statistics as measured by bench_run
+ */
+void bench_print(FILE *file, size_t n, const char *name, const struct BenchResult *res);
+
+#endif // IMPLEMENTIERUNG_BENCH_H
@@ -0,0 +1,82 @@
+/** @headerfile binio.h
+ *  @brief Function prototypes for reading and writing raw float32/float64 files
+ *
+ *  @author Ngoc Kim Ngan Nguyen (ge23fak)
+ */
+
+#ifndef IMPLEMENTIERUNG_BINIO_H
+#define IMPLEMENTIERUNG_BINIO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BIN_MAGIC "ISQ1" // First 4 bytes of a binary file
+
+/**
+ * @brief Header at the start of a binary file, followed by count little-endian IEEE values.
+ * The header is 16 bytes long, so the values are 16-byte aligned in a mapped file.
+ */
+struct BinHeader
+{
+    char magic[4];  // BIN_MAGIC
+    uint32_t type;  // 0 for float32, 1 for float64, same as db
+    uint64_t count; // Number of values
+};
+
+/**
+ * @brief A binary file mapped into memory
+ */
+struct BinFile
+{
+    void *base;    // Start of the mapping
+    size_t length; // Length of the mapping in bytes
+    int db;        // db = 0 if the file contains floats; db = 1 if it contains doubles
+    size_t n;      // Number of values
+    void *data;    // Pointer to the first value, directly behind the header
+};
+
+/**
+ * @brief Check whether the file given by path starts with a complete header with BIN_MAGIC and return the type of its values
+ *
+ * @details Only the header is read, so the type is known before the version is selected. The header is
+ * validated completely by bin_open.
+ *
+ * @param path Path to a file
+ * @return db of the values (0 for floats, 1 for doubles) if the file is a binary file, -1 otherwise or if it cannot be read
+ */
+int bin_type(const char *path);
+
+/**
+ * @brief Map the binary file given by path read-only into memory
+ *
+ * @details The header is validated and, if positive is set, all values are checked to be positive. The values are not copied,
+ * f->data points directly into the mapping and can be passed to the functions in inverse_sqrt.h.
+ * On error a message is printed.
+ *
+ * @param path Path to a binary file
+ * @param f Set to the mapped file
+ * @param positive 1 to reject values which are not positive, 0 for versions handling all inputs
+ * @return 0 on success, -1 on error
+ */
+int bin_open(const char *path, struct BinFile *f, int positive);
+
+/**
+ * @brief Create (or truncate) the binary file given by path for n values of type float/double and map it writable into memory
+ *
+ * @details The header is written immediately, the values can be written through f->data and
+ * reach the file when it is closed with bin_close. On error a message is printed.
+ *
+ * @param path Path to the output file
+ * @param db db = 0 if considering float; db = 1 if considering double
+ * @param n Number of values
+ * @param f Set to the mapped file
+ * @return 0 on success, -1 on error
+ */
+int bin_create(const char *path, int db, size_t n, struct BinFile *f);
+
+/**
+ * @brief Unmap a file opened by bin_open or bin_create
+ */
+void bin_close(struct BinFile *f);
+
+#endif // IMPLEMENTIERUNG_BINIO_H
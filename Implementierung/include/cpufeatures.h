@@ -0,0 +1,61 @@
+/** @headerfile cpufeatures.h
+ *  @brief Function prototypes for the runtime detection of CPU features
+ *  used to select the SIMD implementations
+ *
+ *  @author Yll Kryeziu (ge94noh)
+ */
+
+#ifndef IMPLEMENTIERUNG_CPUFEATURES_H
+#define IMPLEMENTIERUNG_CPUFEATURES_H
+
+#include <stddef.h>
+
+#define CPU_LLC_DEFAULT (8ul << 20) // Assumed size of the last-level cache in bytes if it cannot be determined
+
+/**
+ * @brief Bit flags for the instruction set extensions the implementations depend on
+ */
+enum CpuFeature
+{
+    CPU_SSE2 = 1 << 0,
+    CPU_AVX2 = 1 << 1,
+    CPU_FMA = 1 << 2,
+    CPU_AVX512F = 1 << 3,
+    CPU_F16C = 1 << 4,
+};
+
+/**
+ * @brief Return the instruction set extensions usable on this machine as a combination of CpuFeature flags
+ *
+ * @details The method executes CPUID on its first call and caches the result, later calls only return
+ * the cached value. AVX2, FMA, F16C and AVX-512F are only reported if the operating system also saves the
+ * corresponding register state (checked with XGETBV), as executing them would fault otherwise.
+ */
+int cpu_features(void);
+
+/**
+ * @brief Check whether all features given by the CpuFeature flags in required are usable on this machine
+ *
+ * @param required Combination of CpuFeature flags, 0 if no extension is required
+ * @return 1 if all required features are supported, otherwise 0
+ */
+int cpu_supports(int required);
+
+/**
+ * @brief Write a human readable list of the CpuFeature flags in features into buf, e.g. "AVX2 FMA"
+ *
+ * @param features Combination of CpuFeature flags
+ * @param buf Output buffer for the null-terminated string
+ * @param size Size of buf in bytes
+ */
+void cpu_feature_names(int features, char *buf, size_t size);
+
+/**
+ * @brief Return the size of the last-level cache in bytes
+ *
+ * @details The size of the L3 cache (or L2 if there is no L3) as reported by sysconf, cached after the
+ * first call. If it cannot be determined, CPU_LLC_DEFAULT is returned.
+ */
+size_t cpu_llc_size(void);
+
+#endif // IMPLEMENTIERUNG_CPUFEATURES_H
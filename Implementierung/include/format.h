@@ -0,0 +1,126 @@
+/** @headerfile format.h
+ *  @brief Function prototypes for the fast conversion of float/double to decimal text
+ *  and buffered output
+ *
+ *  @author Ngoc Kim Ngan Nguyen (ge23fak)
+ */
+
+#ifndef IMPLEMENTIERUNG_FORMAT_H
+#define IMPLEMENTIERUNG_FORMAT_H
+
+#include <stddef.h>
+
+#define FORMAT_PRECISION 10   // Number of decimal places of FORMAT_FIXED, same as the former printf("%10.10f ")
+#define FORMAT_MAX 400        // Maximum length of one formatted number, %f of DBL_MAX has 309 digits before the point
+#define WRITER_SIZE (1 << 20) // Size of the output buffer, the buffer is written with a single write call when full
+
+/**
+ * @brief Text representations of the values
+ */
+enum OutputFormat
+{
+    FORMAT_FIXED,    // Fixed number of decimal places, e.g. 0.4991540611
+    FORMAT_SHORTEST, // Shortest text which is read back as exactly the same value, e.g. 0.49915406
+};
+
+/**
+ * @brief Buffered output to a file descriptor
+ */
+struct Writer
+{
+    int fd;     // File descriptor the buffer is written to
+    char *buf;  // Buffer of WRITER_SIZE bytes
+    size_t len; // Number of bytes in the buffer
+    int error;  // Set if a write failed
+};
+
+/**
+ * @brief Format x with precision decimal places, the result is identical to snprintf(dst, FORMAT_MAX, "%.*f", precision, x)
+ *
+ * @details The exact binary value of x is scaled by 10^precision with 128 bit integer arithmetic and rounded
+ * to nearest, ties to even, like glibc does. Only infinite values, NaN and values which do not fit
+ * into 128 bits after scaling are passed to snprintf.
+ *
+ * @param dst Output buffer of at least FORMAT_MAX bytes, the result is not null-terminated
+ * @param x Value to format
+ * @param precision Number of decimal places, at most 18
+ * @return Number of characters written
+ */
+size_t format_fixed(char *dst, double x, int precision);
+
+/**
+ * @brief Format x with the fewest significant digits which are read back as exactly x (round trip)
+ *
+ * @details Ryu algorithm (Adams, "Ryu: Fast Float-to-String Conversion", PLDI 2018): the bounds of the interval of
+ * numbers which are rounded to x are scaled by a power of ten with integer multiplications by precomputed powers
+ * of five, and digits are removed as long as the interval contains a number with fewer digits. Of the shortest
+ * numbers the one closest to x is written. No floating point arithmetic and no parsing is needed.
+ * Numbers with a decimal exponent in [-5, 9) are written in positional notation, others in scientific notation.
+ *
+ * @param dst Output buffer of at least FORMAT_MAX bytes, the result is not null-terminated
+ * @param x Value to format
+ * @return Number of characters written
+ */
+size_t format_shortest_flt(char *dst, float x);
+
+/**
+ * @brief Format x with the fewest significant digits which are read back as exactly x (round trip)
+ *
+ * @details Same as format_shortest_flt with up to 17 significant digits and 128 bit multiplications.
+ * Numbers with a decimal exponent in [-5, 17) are written in positional notation.
+ *
+ * @param dst Output buffer of at least FORMAT_MAX bytes, the result is not null-terminated
+ * @param x Value to format
+ * @return Number of characters written
+ */
+size_t format_shortest_dbl(char *dst, double x);
+
+/**
+ * @brief Allocate the buffer of the writer
+ *
+ * @param w Writer to initialise
+ * @param fd File descriptor, e.g. STDOUT_FILENO. Pending output of stdio streams on it has to be flushed before.
+ * @return 0 on success, -1 if the buffer could not be allocated
+ */
+int writer_init(struct Writer *w, int fd);
+
+/**
+ * @brief Write the buffered text to the file descriptor
+ *
+ * @return 0 on success, -1 if a write failed
+ */
+int writer_flush(struct Writer *w);
+
+/**
+ * @brief Flush the writer and release its buffer
+ *
+ * @return 0 on success, -1 if a write failed
+ */
+int writer_close(struct Writer *w);
+
+/**
+ * @brief Append a single character to the writer
+ */
+void writer_putc(struct Writer *w, char c);
+
+/**
+ * @brief Append an array of n floats to the writer, each value followed by a space
+ *
+ * @param w Writer
+ * @param n Number of values
+ * @param vals Values to format
+ * @param format FORMAT_FIXED or FORMAT_SHORTEST
+ */
+void write_flt(struct Writer *w, size_t n, const float vals[n], int format);
+
+/**
+ * @brief Append an array of n doubles to the writer, each value followed by a space
+ *
+ * @param w Writer
+ * @param n Number of values
+ * @param vals Values to format
+ * @param format FORMAT_FIXED or FORMAT_SHORTEST
+ */
+void write_dbl(struct Writer *w, size_t n, const double vals[n], int format);
+
+#endif // IMPLEMENTIERUNG_FORMAT_H
@@ -8,6 +8,25 @@
 #ifndef IMPLEMENTIERUNG_INVERSE_SQRT_H
 #define IMPLEMENTIERUNG_INVERSE_SQRT_H
 
+#include <stddef.h>
+#include <stdint.h>
+
+// MagicNumbers and Newton coefficients of the tuned versions, as printed by ./main --tune (floats) and ./main --tune -d (doubles)
+#define TUNED_MAGIC_FLT 0x5F200000
+#define TUNED_K1_FLT 1.6819138526916504f
+#define TUNED_K2_FLT 0.70395195484161377f
+#define TUNED_K3_FLT 1.5000003576278687f
+#define TUNED_K4_FLT 0.50000005960464478f
+#define TUNED_MAGIC_DBL 0x5FE3FFFFF2AAAAB3
+#define TUNED_K1_DBL 1.6819139615833236
+#define TUNED_K2_DBL 0.70395207562540119
+#define TUNED_K3_DBL 1.500000369767416
+#define TUNED_K4_DBL 0.50000005282391535
+
+// MagicNumbers applied to the 16-bit patterns of half precision and bfloat16 values, as printed by ./main --magic16 half and --magic16 bfloat16
+#define MAGIC_F16 0x59BA
+#define MAGIC_BF16 0x5F37
+
 /**
  * @brief Calculate the reciprocal square root of input array of n floats
  * using 1/sqrtf(x) and write results into output array.
@@ -84,6 +103,151 @@ void fastInvSqrt_flt_V1(size_t n, float vals[n], float out[n]);
  */
 void fastInvSqrt_flt(size_t n, float vals[n], float out[n]);
 
+/**
+ * @brief Calculate the reciprocal square root of input array of n floats
+ * using the AVX2 implementation of the Fast Inverse Square Root algorithm
+ * and write results into output array.
+ *
+ * @details Same algorithm as fastInvSqrt_flt, but 256-bit AVX2 vectors are used so that
+ * 8 floats are read and processed at once. The Newton-Raphson iteration is computed with
+ * a fused multiply-add (FMA). If the number of floats is not a multiple of 8, the rest of
+ * the floats is processed using scalar instructions.
+ * Requires a CPU supporting AVX2 and FMA.
+ *
+ * @param n Number of float values in the arrays
+ * @param vals Pointer to the input array with float values
+ * @param out Pointer to the float output array, where the results are written
+ */
+void fastInvSqrt_flt_AVX2(size_t n, float vals[n], float out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n floats
+ * using the AVX2 implementation of the Fast Inverse Square Root algorithm
+ * with 2 Newton-Raphson iterations and write results into output array.
+ *
+ * @details Same as fastInvSqrt_flt_AVX2, but an additional Newton-Raphson iteration
+ * is applied to further improve accuracy of the results.
+ * Requires a CPU supporting AVX2 and FMA.
+ *
+ * @param n Number of float values in the arrays
+ * @param vals Pointer to the input array with float values
+ * @param out Pointer to the float output array, where the results are written
+ */
+void fastInvSqrt_flt_AVX2_DoubleNewton(size_t n, float vals[n], float out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n floats
+ * using the AVX-512 implementation of the Fast Inverse Square Root algorithm
+ * and write results into output array.
+ *
+ * @details Same algorithm as fastInvSqrt_flt_AVX2, but 512-bit AVX-512F vectors are used so that
+ * 16 floats are read and processed at once. If the number of floats is not a multiple of 16,
+ * the remaining floats are processed with a masked load and store instead of a scalar loop.
+ * Requires a CPU supporting AVX-512F.
+ *
+ * @param n Number of float values in the arrays
+ * @param vals Pointer to the input array with float values
+ * @param out Pointer to the float output array, where the results are written
+ */
+void fastInvSqrt_flt_AVX512(size_t n, float vals[n], float out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n floats
+ * using the AVX-512 implementation of the Fast Inverse Square Root algorithm
+ * with 2 Newton-Raphson iterations and write results into output array.
+ *
+ * @details Same as fastInvSqrt_flt_AVX512, but an additional Newton-Raphson iteration
+ * is applied to further improve accuracy of the results.
+ * Requires a CPU supporting AVX-512F.
+ *
+ * @param n Number of float values in the arrays
+ * @param vals Pointer to the input array with float values
+ * @param out Pointer to the float output array, where the results are written
+ */
+void fastInvSqrt_flt_AVX512_DoubleNewton(size_t n, float vals[n], float out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n floats
+ * using the SIMD implementation of the Fast Inverse Square Root algorithm with
+ * tuned MagicNumber and Newton coefficients and write results into output array.
+ *
+ * @details Same as fastInvSqrt_flt, but the MagicNumber TUNED_MAGIC_FLT and the Newton iteration
+ * y * (k1 - k2 * x * y * y) with the coefficients TUNED_K1_FLT and TUNED_K2_FLT are used, which were
+ * optimized together by ./main --tune. With the same number of instructions, the maximum relative error
+ * is 0.065 % instead of 0.175 %.
+ *
+ * @param n Number of float values in the arrays
+ * @param vals Pointer to the input array with float values
+ * @param out Pointer to the float output array, where the results are written
+ */
+void fastInvSqrt_flt_Tuned(size_t n, float vals[n], float out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n floats
+ * using the SIMD implementation of the Fast Inverse Square Root algorithm with
+ * tuned MagicNumber and 2 tuned Newton-Raphson iterations and write results into output array.
+ *
+ * @details Same as fastInvSqrt_flt_Tuned, followed by a second iteration with the coefficients
+ * TUNED_K3_FLT and TUNED_K4_FLT. The maximum relative error is 4.9e-5 % instead of 4.7e-4 %
+ * of fastInvSqrt_flt_DoubleNewton.
+ *
+ * @param n Number of float values in the arrays
+ * @param vals Pointer to the input array with float values
+ * @param out Pointer to the float output array, where the results are written
+ */
+void fastInvSqrt_flt_Tuned_DoubleNewton(size_t n, float vals[n], float out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n floats
+ * like fastInvSqrt_flt, but with non-temporal stores for arrays larger than the last-level cache.
+ *
+ * @details Whole 64-byte cache lines of the output are written with streaming stores, which bypass the cache
+ * and avoid reading every output line from memory before it is overwritten (read-for-ownership). The input is
+ * prefetched ahead. The floats before the first aligned cache line and after the last full one are processed by
+ * fastInvSqrtSmall_flt (inverse_sqrt_inline.h), which computes them like fastInvSqrt_flt but without its aligned
+ * stores, so out may have any alignment and for a 64-byte aligned output array the results are identical to fastInvSqrt_flt.
+ * Only faster if the arrays do not fit into the cache, as the results are not kept in the cache.
+ *
+ * @param n Number of float values in the arrays
+ * @param vals Pointer to the input array with float values
+ * @param out Pointer to the float output array, where the results are written
+ */
+void fastInvSqrt_flt_NT(size_t n, float vals[n], float out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n floats
+ * like fastInvSqrt_flt_AVX2, but with non-temporal stores for arrays larger than the last-level cache.
+ *
+ * @details Whole 64-byte cache lines of the output are written with streaming stores, which bypass the cache
+ * and avoid reading every output line from memory before it is overwritten (read-for-ownership). The input is
+ * prefetched ahead. The floats before the first aligned cache line and after the last full one are processed by
+ * fastInvSqrt_flt_AVX2, so for a 64-byte aligned output array the results are identical to it.
+ * Only faster if the arrays do not fit into the cache, as the results are not kept in the cache.
+ * Requires a CPU supporting AVX2 and FMA.
+ *
+ * @param n Number of float values in the arrays
+ * @param vals Pointer to the input array with float values
+ * @param out Pointer to the float output array, where the results are written
+ */
+void fastInvSqrt_flt_AVX2_NT(size_t n, float vals[n], float out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n floats
+ * like fastInvSqrt_flt_AVX512, but with non-temporal stores for arrays larger than the last-level cache.
+ *
+ * @details Whole 64-byte cache lines of the output are written with streaming stores, which bypass the cache
+ * and avoid reading every output line from memory before it is overwritten (read-for-ownership). The input is
+ * prefetched ahead. The floats before the first aligned cache line and after the last full one are processed by
+ * fastInvSqrt_flt_AVX512, so for a 64-byte aligned output array the results are identical to it.
+ * Only faster if the arrays do not fit into the cache, as the results are not kept in the cache.
+ * Requires a CPU supporting AVX-512F.
+ *
+ * @param n Number of float values in the arrays
+ * @param vals Pointer to the input array with float values
+ * @param out Pointer to the float output array, where the results are written
+ */
+void fastInvSqrt_flt_AVX512_NT(size_t n, float vals[n], float out[n]);
+
 /**
  * @brief Calculate the reciprocal square root of input array of n doubles
  * using 1/sqrt(x) and write results into output array.
@@ -159,4 +323,482 @@ void fastInvSqrt_dbl_V1(size_t n, double vals[n], double out[n]);
  * @param out Pointer to the double output array, where the results are written
  */
 void fastInvSqrt_dbl(size_t n, double vals[n], double out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n doubles
+ * using the AVX2 implementation of the Fast Inverse Square Root algorithm
+ * and write results into output array.
+ *
+ * @details Same algorithm as fastInvSqrt_dbl, but 256-bit AVX2 vectors are used so that
+ * 4 doubles are read and processed at once. The Newton-Raphson iteration is computed with
+ * a fused multiply-add (FMA). If the number of doubles is not a multiple of 4, the rest of
+ * the doubles is processed using scalar instructions.
+ * Requires a CPU supporting AVX2 and FMA.
+ *
+ * @param n Number of double values in the arrays
+ * @param vals Pointer to the input array with double values
+ * @param out Pointer to the double output array, where the results are written
+ */
+void fastInvSqrt_dbl_AVX2(size_t n, double vals[n], double out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n doubles
+ * using the AVX2 implementation of the Fast Inverse Square Root algorithm
+ * with 2 Newton-Raphson iterations and write results into output array.
+ *
+ * @details Same as fastInvSqrt_dbl_AVX2, but an additional Newton-Raphson iteration
+ * is applied to further improve accuracy of the results.
+ * Requires a CPU supporting AVX2 and FMA.
+ *
+ * @param n Number of double values in the arrays
+ * @param vals Pointer to the input array with double values
+ * @param out Pointer to the double output array, where the results are written
+ */
+void fastInvSqrt_dbl_AVX2_DoubleNewton(size_t n, double vals[n], double out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n doubles
+ * using the AVX-512 implementation of the Fast Inverse Square Root algorithm
+ * and write results into output array.
+ *
+ * @details Same algorithm as fastInvSqrt_dbl_AVX2, but 512-bit AVX-512F vectors are used so that
+ * 8 doubles are read and processed at once. If the number of doubles is not a multiple of 8,
+ * the remaining doubles are processed with a masked load and store instead of a scalar loop.
+ * Requires a CPU supporting AVX-512F.
+ *
+ * @param n Number of double values in the arrays
+ * @param vals Pointer to the input array with double values
+ * @param out Pointer to the double output array, where the results are written
+ */
+void fastInvSqrt_dbl_AVX512(size_t n, double vals[n], double out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n doubles
+ * using the AVX-512 implementation of the Fast Inverse Square Root algorithm
+ * with 2 Newton-Raphson iterations and write results into output array.
+ *
+ * @details Same as fastInvSqrt_dbl_AVX512, but an additional Newton-Raphson iteration
+ * is applied to further improve accuracy of the results.
+ * Requires a CPU supporting AVX-512F.
+ *
+ * @param n Number of double values in the arrays
+ * @param vals Pointer to the input array with double values
+ * @param out Pointer to the double output array, where the results are written
+ */
+void fastInvSqrt_dbl_AVX512_DoubleNewton(size_t n, double vals[n], double out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n doubles
+ * using the SIMD implementation of the Fast Inverse Square Root algorithm with
+ * tuned MagicNumber and Newton coefficients and write results into output array.
+ *
+ * @details Same as fastInvSqrt_dbl, but the MagicNumber TUNED_MAGIC_DBL and the Newton iteration
+ * y * (k1 - k2 * x * y * y) with the coefficients TUNED_K1_DBL and TUNED_K2_DBL are used, which were
+ * optimized together by ./main --tune -d. With the same number of instructions, the maximum relative error
+ * is 0.065 % instead of 0.175 %.
+ *
+ * @param n Number of double values in the arrays
+ * @param vals Pointer to the input array with double values
+ * @param out Pointer to the double output array, where the results are written
+ */
+void fastInvSqrt_dbl_Tuned(size_t n, double vals[n], double out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n doubles
+ * using the SIMD implementation of the Fast Inverse Square Root algorithm with
+ * tuned MagicNumber and 2 tuned Newton-Raphson iterations and write results into output array.
+ *
+ * @details Same as fastInvSqrt_dbl_Tuned, followed by a second iteration with the coefficients
+ * TUNED_K3_DBL and TUNED_K4_DBL. The maximum relative error is 3.2e-5 % instead of 4.6e-4 %
+ * of fastInvSqrt_dbl_DoubleNewton.
+ *
+ * @param n Number of double values in the arrays
+ * @param vals Pointer to the input array with double values
+ * @param out Pointer to the double output array, where the results are written
+ */
+void fastInvSqrt_dbl_Tuned_DoubleNewton(size_t n, double vals[n], double out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n doubles
+ * like fastInvSqrt_dbl, but with non-temporal stores for arrays larger than the last-level cache.
+ *
+ * @details Whole 64-byte cache lines of the output are written with streaming stores, which bypass the cache
+ * and avoid reading every output line from memory before it is overwritten (read-for-ownership). The input is
+ * prefetched ahead. The doubles before the first aligned cache line and after the last full one are processed by
+ * fastInvSqrtSmall_dbl (inverse_sqrt_inline.h), which computes them like fastInvSqrt_dbl but without its aligned
+ * stores, so out may have any alignment and for a 64-byte aligned output array the results are identical to fastInvSqrt_dbl.
+ * Only faster if the arrays do not fit into the cache, as the results are not kept in the cache.
+ *
+ * @param n Number of double values in the arrays
+ * @param vals Pointer to the input array with double values
+ * @param out Pointer to the double output array, where the results are written
+ */
+void fastInvSqrt_dbl_NT(size_t n, double vals[n], double out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n doubles
+ * like fastInvSqrt_dbl_AVX2, but with non-temporal stores for arrays larger than the last-level cache.
+ *
+ * @details Whole 64-byte cache lines of the output are written with streaming stores, which bypass the cache
+ * and avoid reading every output line from memory before it is overwritten (read-for-ownership). The input is
+ * prefetched ahead. The doubles before the first aligned cache line and after the last full one are processed by
+ * fastInvSqrt_dbl_AVX2, so for a 64-byte aligned output array the results are identical to it.
+ * Only faster if the arrays do not fit into the cache, as the results are not kept in the cache.
+ * Requires a CPU supporting AVX2 and FMA.
+ *
+ * @param n Number of double values in the arrays
+ * @param vals Pointer to the input array with double values
+ * @param out Pointer to the double output array, where the results are written
+ */
+void fastInvSqrt_dbl_AVX2_NT(size_t n, double vals[n], double out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n doubles
+ * like fastInvSqrt_dbl_AVX512, but with non-temporal stores for arrays larger than the last-level cache.
+ *
+ * @details Whole 64-byte cache lines of the output are written with streaming stores, which bypass the cache
+ * and avoid reading every output line from memory before it is overwritten (read-for-ownership). The input is
+ * prefetched ahead. The doubles before the first aligned cache line and after the last full one are processed by
+ * fastInvSqrt_dbl_AVX512, so for a 64-byte aligned output array the results are identical to it.
+ * Only faster if the arrays do not fit into the cache, as the results are not kept in the cache.
+ * Requires a CPU supporting AVX-512F.
+ *
+ * @param n Number of double values in the arrays
+ * @param vals Pointer to the input array with double values
+ * @param out Pointer to the double output array, where the results are written
+ */
+void fastInvSqrt_dbl_AVX512_NT(size_t n, double vals[n], double out[n]);
+
+/**
+ * @brief Calculate a[i] / sqrt(b[i]) for arrays of n floats in one pass using the Fast Inverse Square Root
+ *
+ * @details Same algorithm and SSE vectors as fastInvSqrt_flt, the result of 4 floats is multiplied by the
+ * corresponding values of a before it is stored. This replaces fastInvSqrt_flt into a temporary array
+ * followed by a second pass for the multiplication. The rest of the floats is processed using scalar instructions.
+ *
+ * @param n Number of float values in the arrays
+ * @param a Pointer to the array of factors
+ * @param b Pointer to the array of values of which the reciprocal square root is taken
+ * @param out Pointer to the float output array, may be equal to a or b
+ */
+void mulInvSqrt_flt(size_t n, const float *a, const float *b, float *out);
+
+/**
+ * @brief Calculate a[i] / sqrt(b[i]) for arrays of n floats like mulInvSqrt_flt, but with 256-bit
+ * AVX2 vectors and FMA as in fastInvSqrt_flt_AVX2. Requires a CPU supporting AVX2 and FMA.
+ */
+void mulInvSqrt_flt_AVX2(size_t n, const float *a, const float *b, float *out);
+
+/**
+ * @brief Calculate the square root of an array of n floats as x * (1/sqrt(x)) using the Fast Inverse Square Root
+ *
+ * @details Same algorithm and SSE vectors as fastInvSqrt_flt, the relative error is the same as that of
+ * the reciprocal square root. sqrt(0) is 0, as the finite estimate for 1/sqrt(0) is multiplied by 0.
+ *
+ * @param n Number of float values in the arrays
+ * @param x Pointer to the input array with float values
+ * @param out Pointer to the float output array, may be equal to x
+ */
+void fastSqrt_flt(size_t n, const float *x, float *out);
+
+/**
+ * @brief Calculate the square root of an array of n floats like fastSqrt_flt, but with 256-bit
+ * AVX2 vectors and FMA as in fastInvSqrt_flt_AVX2. Requires a CPU supporting AVX2 and FMA.
+ */
+void fastSqrt_flt_AVX2(size_t n, const float *x, float *out);
+
+/**
+ * @brief Calculate a[i] / sqrt(b[i]) for arrays of n doubles in one pass using the Fast Inverse Square Root
+ *
+ * @details Same algorithm and SSE vectors as fastInvSqrt_dbl, the result of 2 doubles is multiplied by the
+ * corresponding values of a before it is stored. If n is odd, the last double is processed using scalar instructions.
+ *
+ * @param n Number of double values in the arrays
+ * @param a Pointer to the array of factors
+ * @param b Pointer to the array of values of which the reciprocal square root is taken
+ * @param out Pointer to the double output array, may be equal to a or b
+ */
+void mulInvSqrt_dbl(size_t n, const double *a, const double *b, double *out);
+
+/**
+ * @brief Calculate a[i] / sqrt(b[i]) for arrays of n doubles like mulInvSqrt_dbl, but with 256-bit
+ * AVX2 vectors and FMA as in fastInvSqrt_dbl_AVX2. Requires a CPU supporting AVX2 and FMA.
+ */
+void mulInvSqrt_dbl_AVX2(size_t n, const double *a, const double *b, double *out);
+
+/**
+ * @brief Calculate the square root of an array of n doubles as x * (1/sqrt(x)) using the Fast Inverse Square Root
+ *
+ * @details Same algorithm and SSE vectors as fastInvSqrt_dbl. sqrt(0) is 0.
+ *
+ * @param n Number of double values in the arrays
+ * @param x Pointer to the input array with double values
+ * @param out Pointer to the double output array, may be equal to x
+ */
+void fastSqrt_dbl(size_t n, const double *x, double *out);
+
+/**
+ * @brief Calculate the square root of an array of n doubles like fastSqrt_dbl, but with 256-bit
+ * AVX2 vectors and FMA as in fastInvSqrt_dbl_AVX2. Requires a CPU supporting AVX2 and FMA.
+ */
+void fastSqrt_dbl_AVX2(size_t n, const double *x, double *out);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n floats
+ * using the hardware estimate of the SSE instruction rsqrtps and write results into output array.
+ *
+ * @details rsqrtps replaces the MagicNumber and the Newton iteration: its estimate has a relative error of
+ * at most 1.5 * 2^-12 (about 0.04 %), 4 floats are processed at once. The exact values of the estimate
+ * depend on the CPU vendor. rsqrtps(0) is inf, subnormal inputs are treated as 0.
+ *
+ * @param n Number of float values in the arrays
+ * @param vals Pointer to the input array with float values
+ * @param out Pointer to the float output array, where the results are written
+ */
+void fastInvSqrt_flt_RSQRT(size_t n, float vals[n], float out[n]);
+
+/**
+ * @brief Like fastInvSqrt_flt_RSQRT, but the estimate is refined with one Newton iteration, which gives almost
+ * full float precision. For 0 the Newton iteration computes 0 * inf, so the result is NaN.
+ */
+void fastInvSqrt_flt_RSQRT_Newton(size_t n, float vals[n], float out[n]);
+
+/**
+ * @brief Like fastInvSqrt_flt_RSQRT, but the estimate is refined with 2 Newton iterations
+ */
+void fastInvSqrt_flt_RSQRT_DoubleNewton(size_t n, float vals[n], float out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n floats
+ * using the hardware estimate of the AVX-512 instruction vrsqrt14ps and write results into output array.
+ *
+ * @details The estimate has a relative error of at most 2^-14 and is the same on all CPUs supporting AVX-512F.
+ * 16 floats are processed at once, the rest with a mask as in fastInvSqrt_flt_AVX512.
+ * Requires a CPU supporting AVX-512F.
+ *
+ * @param n Number of float values in the arrays
+ * @param vals Pointer to the input array with float values
+ * @param out Pointer to the float output array, where the results are written
+ */
+void fastInvSqrt_flt_AVX512_RSQRT14(size_t n, float vals[n], float out[n]);
+
+/**
+ * @brief Like fastInvSqrt_flt_AVX512_RSQRT14, but the estimate is refined with one Newton iteration (with FMA)
+ */
+void fastInvSqrt_flt_AVX512_RSQRT14_Newton(size_t n, float vals[n], float out[n]);
+
+/**
+ * @brief Like fastInvSqrt_flt_AVX512_RSQRT14, but the estimate is refined with 2 Newton iterations (with FMA)
+ */
+void fastInvSqrt_flt_AVX512_RSQRT14_DoubleNewton(size_t n, float vals[n], float out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n doubles
+ * using the hardware estimate of the SSE instruction rsqrtps and write results into output array.
+ *
+ * @details SSE has no estimate for doubles, so each double x = m * 4^h is split into m in [1, 4) and the
+ * exponent with integer operations, the estimate of rsqrtps for m (converted to float) is scaled with 2^-h.
+ * This works for all normal doubles and has the precision of rsqrtps (about 0.04 %).
+ * For 0 and subnormal inputs the result is a large finite number.
+ *
+ * @param n Number of double values in the arrays
+ * @param vals Pointer to the input array with double values
+ * @param out Pointer to the double output array, where the results are written
+ */
+void fastInvSqrt_dbl_RSQRT(size_t n, double vals[n], double out[n]);
+
+/**
+ * @brief Like fastInvSqrt_dbl_RSQRT, but the estimate is refined with one Newton iteration
+ */
+void fastInvSqrt_dbl_RSQRT_Newton(size_t n, double vals[n], double out[n]);
+
+/**
+ * @brief Like fastInvSqrt_dbl_RSQRT, but the estimate is refined with 2 Newton iterations
+ */
+void fastInvSqrt_dbl_RSQRT_DoubleNewton(size_t n, double vals[n], double out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n doubles
+ * using the hardware estimate of the AVX-512 instruction vrsqrt14pd and write results into output array.
+ *
+ * @details The estimate has a relative error of at most 2^-14, 8 doubles are processed at once, the rest
+ * with a mask. Requires a CPU supporting AVX-512F.
+ *
+ * @param n Number of double values in the arrays
+ * @param vals Pointer to the input array with double values
+ * @param out Pointer to the double output array, where the results are written
+ */
+void fastInvSqrt_dbl_AVX512_RSQRT14(size_t n, double vals[n], double out[n]);
+
+/**
+ * @brief Like fastInvSqrt_dbl_AVX512_RSQRT14, but the estimate is refined with one Newton iteration (with FMA)
+ */
+void fastInvSqrt_dbl_AVX512_RSQRT14_Newton(size_t n, double vals[n], double out[n]);
+
+/**
+ * @brief Like fastInvSqrt_dbl_AVX512_RSQRT14, but the estimate is refined with 2 Newton iterations (with FMA)
+ */
+void fastInvSqrt_dbl_AVX512_RSQRT14_DoubleNewton(size_t n, double vals[n], double out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n doubles using a float estimate
+ * refined with one double Newton iteration and write results into output array.
+ *
+ * @details Every double is split with integer operations into m in [1, 4) and a power of two, so that the
+ * estimate works for all positive normal doubles. The m of 8 doubles are narrowed into one AVX2 float vector,
+ * which gets the Fast Inverse Square Root of fastInvSqrt_flt_AVX2 and a second float Newton iteration, both at
+ * twice the lane width of doubles. The estimate (relative error about 5e-6) is widened, scaled and refined with
+ * one Newton iteration in double precision, giving a relative error of about 3e-11 without the 64-bit MagicNumber.
+ * Requires a CPU supporting AVX2 and FMA.
+ *
+ * @param n Number of double values in the arrays
+ * @param vals Pointer to the input array with double values
+ * @param out Pointer to the double output array, where the results are written
+ */
+void fastInvSqrt_dbl_AVX2_Mixed(size_t n, double vals[n], double out[n]);
+
+/**
+ * @brief Like fastInvSqrt_dbl_AVX2_Mixed, but with 2 double Newton iterations, which gives almost full double precision
+ */
+void fastInvSqrt_dbl_AVX2_Mixed_DoubleNewton(size_t n, double vals[n], double out[n]);
+
+/**
+ * @brief Like fastInvSqrt_dbl_AVX2_Mixed, but 16 doubles are processed at once with AVX-512, so the float estimate
+ * is computed for 16 values per vector. Requires a CPU supporting AVX-512F.
+ */
+void fastInvSqrt_dbl_AVX512_Mixed(size_t n, double vals[n], double out[n]);
+
+/**
+ * @brief Like fastInvSqrt_dbl_AVX512_Mixed, but with 2 double Newton iterations
+ */
+void fastInvSqrt_dbl_AVX512_Mixed_DoubleNewton(size_t n, double vals[n], double out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n half precision values (IEEE 754 binary16)
+ * and write the results as half precision values into output array.
+ *
+ * @details The values are stored as 16-bit patterns (e.g. of _Float16). The seed MAGIC_F16 - (x >> 1) is
+ * computed on the 16-bit patterns of 8 values at once, then the values and seeds are converted to float with F16C
+ * in registers for one Newton iteration in float arithmetic, and the results are rounded back to half precision.
+ * Compared to converting the arrays to float, calling fastInvSqrt_flt and converting back, only 2 bytes per value
+ * are read and written. The inputs have to be positive normal half precision values. Requires a CPU supporting F16C.
+ *
+ * @param n Number of values in the arrays
+ * @param vals Pointer to the input array of half precision values
+ * @param out Pointer to the output array of half precision values, may be equal to vals
+ */
+void fastInvSqrt_f16(size_t n, const uint16_t *vals, uint16_t *out);
+
+/**
+ * @brief Like fastInvSqrt_f16, but 16 values are processed at once with AVX-512. Requires a CPU supporting AVX-512F.
+ */
+void fastInvSqrt_f16_AVX512(size_t n, const uint16_t *vals, uint16_t *out);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n bfloat16 values and write the results as
+ * bfloat16 values into output array.
+ *
+ * @details bfloat16 is the upper half of a float. The seed MAGIC_BF16 - (x >> 1) is computed on the 16-bit
+ * patterns of 8 values at once, values and seeds are widened to float with a shift in registers for one Newton
+ * iteration, and the results are rounded to nearest even bfloat16. The inputs have to be positive normal values.
+ * Requires a CPU supporting AVX2.
+ *
+ * @param n Number of values in the arrays
+ * @param vals Pointer to the input array of bfloat16 values
+ * @param out Pointer to the output array of bfloat16 values, may be equal to vals
+ */
+void fastInvSqrt_bf16(size_t n, const uint16_t *vals, uint16_t *out);
+
+/**
+ * @brief Like fastInvSqrt_bf16, but 16 values are processed at once with AVX-512. Requires a CPU supporting AVX-512F.
+ */
+void fastInvSqrt_bf16_AVX512(size_t n, const uint16_t *vals, uint16_t *out);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n doubles and write the results as floats into output array
+ *
+ * @details 4 doubles are narrowed to float in registers and go through the operations of fastInvSqrt_flt, so the
+ * results are identical to converting the array to float and calling fastInvSqrt_flt, but without the float array
+ * in between: 12 instead of 20 bytes are moved per value. The inputs have to be in the range of positive normal floats.
+ *
+ * @param n Number of values in the arrays
+ * @param vals Pointer to the input array with double values
+ * @param out Pointer to the float output array, where the results are written
+ */
+void fastInvSqrt_dbl_flt(size_t n, const double *vals, float *out);
+
+/**
+ * @brief Like fastInvSqrt_dbl_flt, but 8 doubles are narrowed at once and go through the operations of
+ * fastInvSqrt_flt_AVX2, whose results they match. Requires a CPU supporting AVX2 and FMA.
+ */
+void fastInvSqrt_dbl_flt_AVX2(size_t n, const double *vals, float *out);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n floats and write the results as doubles into output array
+ *
+ * @details The floats are widened to double in registers and go through the operations of fastInvSqrt_dbl, so the
+ * results are identical to converting the array to double and calling fastInvSqrt_dbl, but without the double array
+ * in between: 12 instead of 28 bytes are moved per value.
+ *
+ * @param n Number of values in the arrays
+ * @param vals Pointer to the input array with float values
+ * @param out Pointer to the double output array, where the results are written
+ */
+void fastInvSqrt_flt_dbl(size_t n, const float *vals, double *out);
+
+/**
+ * @brief Like fastInvSqrt_flt_dbl, but 8 floats are widened at once and go through the operations of
+ * fastInvSqrt_dbl_AVX2, whose results they match. Requires a CPU supporting AVX2 and FMA.
+ */
+void fastInvSqrt_flt_dbl_AVX2(size_t n, const float *vals, double *out);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n floats like fastInvSqrt_flt, but with sane results for
+ * all inputs
+ *
+ * @details The other kernels return meaningless values for inputs which are not positive. Here these lanes are
+ * detected with vector compares and replaced with and/andnot/or after the regular computation, only vectors
+ * containing such a lane take the replacement branch. So no validation pass is needed: +0 gives +inf, -0 gives -inf, +inf gives +0 like 1/sqrt(), negative values, -inf and NaN give
+ * the default NaN of x86. The results for positive finite values are identical to those of fastInvSqrt_flt.
+ *
+ * @param n Number of values in the arrays
+ * @param vals Pointer to the input array with float values
+ * @param out Pointer to the output array, may be equal to vals
+ */
+void fastInvSqrt_flt_Special(size_t n, float vals[n], float out[n]);
+
+/**
+ * @brief Like fastInvSqrt_flt_Special, but with the operations of fastInvSqrt_flt_AVX2, whose results it matches for
+ * positive finite values. The special values are selected with blendv. Requires a CPU supporting AVX2 and FMA.
+ */
+void fastInvSqrt_flt_AVX2_Special(size_t n, float vals[n], float out[n]);
+
+/**
+ * @brief Like fastInvSqrt_flt_Special, but with the operations of fastInvSqrt_flt_AVX512, whose results it matches for
+ * positive finite values. All special values are replaced with a single vfixupimmps. Requires a CPU supporting AVX-512F.
+ */
+void fastInvSqrt_flt_AVX512_Special(size_t n, float vals[n], float out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of input array of n doubles like fastInvSqrt_dbl, but with sane results for
+ * all inputs, see fastInvSqrt_flt_Special. The results for positive finite values are identical to those of fastInvSqrt_dbl.
+ *
+ * @param n Number of values in the arrays
+ * @param vals Pointer to the input array with double values
+ * @param out Pointer to the output array, may be equal to vals
+ */
+void fastInvSqrt_dbl_Special(size_t n, double vals[n], double out[n]);
+
+/**
+ * @brief Like fastInvSqrt_dbl_Special, but with the operations of fastInvSqrt_dbl_AVX2, whose results it matches for
+ * positive finite values. Requires a CPU supporting AVX2 and FMA.
+ */
+void fastInvSqrt_dbl_AVX2_Special(size_t n, double vals[n], double out[n]);
+
+/**
+ * @brief Like fastInvSqrt_dbl_Special, but with the operations of fastInvSqrt_dbl_AVX512, whose results it matches for
+ * positive finite values. Requires a CPU supporting AVX-512F.
+ */
+void fastInvSqrt_dbl_AVX512_Special(size_t n, double vals[n], double out[n]);
+
 #endif // IMPLEMENTIERUNG_INVERSE_SQRT_H
@@ -0,0 +1,137 @@
+/** @headerfile inverse_sqrt_inline.h
+ *  @brief Header-only inline versions of the Fast Inverse Square Root for single values and small batches
+ *
+ *  @details The array kernels in inverse_sqrt.h are meant for large arrays; called for one or a handful of
+ *  values, the call through a function pointer and the SIMD setup dominate. The functions in this header
+ *  are static inline and can be inlined into the caller. They use exactly the operations of
+ *  fastInvSqrt_flt and fastInvSqrt_dbl (MagicNumbers of Lomont and Robertson, one Newton iteration): the vector
+ *  functions those of the SIMD loop, which computes xhalf * (y * y), and the scalar functions those of the scalar
+ *  tail, which computes (xhalf * y) * y. These can differ in the last bit, so a value matches the array kernel
+ *  only if it takes the same path there, which the Small functions guarantee for the same n.
+ *  Only SSE2 is used, which every x86-64 CPU supports.
+ *
+ *  @author Yll Kryeziu (ge94noh)
+ */
+
+#ifndef IMPLEMENTIERUNG_INVERSE_SQRT_INLINE_H
+#define IMPLEMENTIERUNG_INVERSE_SQRT_INLINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <immintrin.h>
+
+/**
+ * @brief Calculate the reciprocal square root of one float using the Fast Inverse Square Root
+ *
+ * @param x Input value
+ * @return Approximation of 1/sqrt(x), identical to the scalar tail of fastInvSqrt_flt (not necessarily to its SIMD lanes)
+ */
+static inline float fastInvSqrt1_flt(float x)
+{
+    union
+    {
+        float x;
+        uint32_t u;
+    } conv = {x};
+    float xhalf = x * 0.5f;
+    conv.u = 0x5F375A86 - (conv.u >> 1);
+    return conv.x * (1.5f - (xhalf * conv.x * conv.x));
+}
+
+/**
+ * @brief Calculate the reciprocal square root of 4 floats at once using the Fast Inverse Square Root with SSE
+ *
+ * @param x Vector of 4 input values
+ * @return Vector of the approximations of 1/sqrt(x), identical to the SIMD lanes of fastInvSqrt_flt
+ */
+static inline __m128 fastInvSqrt4_flt(__m128 x)
+{
+    __m128 xhalf = _mm_mul_ps(x, _mm_set1_ps(0.5f));
+    __m128 y = _mm_castsi128_ps(_mm_sub_epi32(_mm_set1_epi32(0x5F375A86), _mm_srli_epi32(_mm_castps_si128(x), 1)));
+    return _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(xhalf, _mm_mul_ps(y, y))));
+}
+
+/**
+ * @brief Calculate the reciprocal square root of a small array of n floats using fastInvSqrt4_flt
+ * for groups of 4 and fastInvSqrt1_flt for the rest
+ *
+ * @details In contrast to fastInvSqrt_flt there are no alignment requirements for out and the function
+ * can be inlined. The values are split into vector and scalar path like in fastInvSqrt_flt, so the results are
+ * identical to fastInvSqrt_flt with the same n. For n known at compile time the loops are resolved completely.
+ *
+ * @param n Number of values
+ * @param vals Pointer to the input array
+ * @param out Pointer to the output array, may be equal to vals
+ */
+static inline void fastInvSqrtSmall_flt(size_t n, const float *vals, float *out)
+{
+    size_t j;
+    for (j = 0; j + 4 <= n; j += 4)
+    {
+        _mm_storeu_ps(&out[j], fastInvSqrt4_flt(_mm_loadu_ps(&vals[j])));
+    }
+    for (; j < n; j++)
+    {
+        out[j] = fastInvSqrt1_flt(vals[j]);
+    }
+}
+
+/**
+ * @brief Calculate the reciprocal square root of one double using the Fast Inverse Square Root
+ *
+ * @param x Input value
+ * @return Approximation of 1/sqrt(x), identical to the scalar tail of fastInvSqrt_dbl (not necessarily to its SIMD lanes)
+ */
+static inline double fastInvSqrt1_dbl(double x)
+{
+    union
+    {
+        double x;
+        uint64_t u;
+    } conv = {x};
+    double xhalf = x * 0.5;
+    conv.u = 0x5FE6EB50C7B537A9 - (conv.u >> 1);
+    return conv.x * (1.5 - (xhalf * conv.x * conv.x));
+}
+
+/**
+ * @brief Calculate the reciprocal square root of 2 doubles at once using the Fast Inverse Square Root with SSE2
+ *
+ * @details 4 doubles need 256 bit registers (AVX), which would have to be enabled for the caller as well
+ * to allow inlining, so the double version is 2 wide.
+ *
+ * @param x Vector of 2 input values
+ * @return Vector of the approximations of 1/sqrt(x), identical to the SIMD lanes of fastInvSqrt_dbl
+ */
+static inline __m128d fastInvSqrt2_dbl(__m128d x)
+{
+    __m128d xhalf = _mm_mul_pd(x, _mm_set1_pd(0.5));
+    __m128d y = _mm_castsi128_pd(_mm_sub_epi64(_mm_set1_epi64x(0x5FE6EB50C7B537A9), _mm_srli_epi64(_mm_castpd_si128(x), 1)));
+    return _mm_mul_pd(y, _mm_sub_pd(_mm_set1_pd(1.5), _mm_mul_pd(xhalf, _mm_mul_pd(y, y))));
+}
+
+/**
+ * @brief Calculate the reciprocal square root of a small array of n doubles using fastInvSqrt2_dbl
+ * for pairs and fastInvSqrt1_dbl for the last value
+ *
+ * @details The split into vector and scalar path is the same as in fastInvSqrt_dbl, so the results are
+ * identical to fastInvSqrt_dbl with the same n.
+ *
+ * @param n Number of values
+ * @param vals Pointer to the input array
+ * @param out Pointer to the output array, may be equal to vals
+ */
+static inline void fastInvSqrtSmall_dbl(size_t n, const double *vals, double *out)
+{
+    size_t j;
+    for (j = 0; j + 2 <= n; j += 2)
+    {
+        _mm_storeu_pd(&out[j], fastInvSqrt2_dbl(_mm_loadu_pd(&vals[j])));
+    }
+    if (j < n)
+    {
+        out[j] = fastInvSqrt1_dbl(vals[j]);
+    }
+}
+
+#endif // IMPLEMENTIERUNG_INVERSE_SQRT_INLINE_H
@@ -0,0 +1,107 @@
+/** @headerfile kernelgen.h
+ *  @brief Kernel matrix of Fast Inverse Square Root versions generated from parameters at compile time
+ *
+ *  @details The hand-written kernels in inverse_sqrt.h differ only in vector width, number of Newton
+ *  iterations and MagicNumber. The kernels listed in KERNEL_MATRIX_FLT and KERNEL_MATRIX_DBL are instead
+ *  generated by kernelgen.c from one macro template. Every row has the parameters
+ *  X(T, W, U, N, MAGIC, TAG, ERR, COST):
+ *  - T: element type, flt or dbl
+ *  - W: SIMD width, scalar, sse (SSE2), avx2 (AVX2/FMA) or avx512 (AVX-512F)
+ *  - U: unroll factor, 1, 2, 4 or 8 vectors per loop iteration
+ *  - N: number of Newton iterations, 0 to 3
+ *  - MAGIC, TAG: MagicNumber and its name in the version name
+ *  - ERR, COST: error bound and measured cost for the versions table, see struct Version in parser.h
+ *
+ *  A kernel is called fastInvSqrt_gen_T_W_uU_nN_TAG and registered in the versions table as
+ *  gen_W_uU_nN_TAG, so a new combination only needs a new row here. The remaining values after the
+ *  unrolled loop are computed one vector at a time and the last ones with a masked (AVX-512) or padded
+ *  vector of the same width, so every value gets the same result wherever it is in the array.
+ *  benchmarkKernelMatrix (tests.h) measures all rows and reports the fastest configuration for the CPU.
+ *
+ *  @author Yll Kryeziu (ge94noh)
+ */
+
+#ifndef IMPLEMENTIERUNG_KERNELGEN_H
+#define IMPLEMENTIERUNG_KERNELGEN_H
+
+#include <stddef.h>
+#include "cpufeatures.h"
+
+#define MAGIC_LOMONT_FLT 0x5F375A86            // MagicNumber of Lomont, also used by fastInvSqrt_flt
+#define MAGIC_QUAKE_FLT 0x5F3759DF             // MagicNumber of Quake III Arena
+#define MAGIC_ROBERTSON_DBL 0x5FE6EB50C7B537A9 // MagicNumber of Robertson, also used by fastInvSqrt_dbl
+#define MAGIC_LOMONT_DBL 0x5FE6EC85E7DE30DA    // Double MagicNumber of Lomont
+
+// X(T, W, U, N, MAGIC, TAG, ERR, COST) for every generated float kernel
+#define KERNEL_MATRIX_FLT(X)                                              \
+    X(flt, scalar, 1, 1, MAGIC_LOMONT_FLT, lomont, 1.76e-3, 1.87)         \
+    X(flt, sse, 1, 1, MAGIC_LOMONT_FLT, lomont, 1.76e-3, 0.47)            \
+    X(flt, sse, 2, 1, MAGIC_LOMONT_FLT, lomont, 1.76e-3, 0.45)            \
+    X(flt, sse, 4, 1, MAGIC_LOMONT_FLT, lomont, 1.76e-3, 0.45)            \
+    X(flt, sse, 2, 2, MAGIC_LOMONT_FLT, lomont, 4.9e-6, 0.73)             \
+    X(flt, sse, 2, 1, MAGIC_QUAKE_FLT, quake, 1.76e-3, 0.46)              \
+    X(flt, avx2, 1, 1, MAGIC_LOMONT_FLT, lomont, 1.76e-3, 0.25)           \
+    X(flt, avx2, 2, 1, MAGIC_LOMONT_FLT, lomont, 1.76e-3, 0.24)           \
+    X(flt, avx2, 4, 1, MAGIC_LOMONT_FLT, lomont, 1.76e-3, 0.24)           \
+    X(flt, avx2, 2, 0, MAGIC_LOMONT_FLT, lomont, 3.5e-2, 0.22)            \
+    X(flt, avx2, 2, 2, MAGIC_LOMONT_FLT, lomont, 4.9e-6, 0.38)            \
+    X(flt, avx2, 2, 1, MAGIC_QUAKE_FLT, quake, 1.76e-3, 0.24)             \
+    X(flt, avx512, 1, 1, MAGIC_LOMONT_FLT, lomont, 1.76e-3, 0.24)         \
+    X(flt, avx512, 2, 1, MAGIC_LOMONT_FLT, lomont, 1.76e-3, 0.23)         \
+    X(flt, avx512, 4, 1, MAGIC_LOMONT_FLT, lomont, 1.76e-3, 0.22)         \
+    X(flt, avx512, 2, 2, MAGIC_LOMONT_FLT, lomont, 4.9e-6, 0.23)
+
+// X(T, W, U, N, MAGIC, TAG, ERR, COST) for every generated double kernel
+#define KERNEL_MATRIX_DBL(X)                                              \
+    X(dbl, scalar, 1, 1, MAGIC_ROBERTSON_DBL, robertson, 1.76e-3, 2.18)   \
+    X(dbl, sse, 1, 1, MAGIC_ROBERTSON_DBL, robertson, 1.76e-3, 0.94)      \
+    X(dbl, sse, 2, 1, MAGIC_ROBERTSON_DBL, robertson, 1.76e-3, 0.90)      \
+    X(dbl, sse, 4, 1, MAGIC_ROBERTSON_DBL, robertson, 1.76e-3, 0.90)      \
+    X(dbl, sse, 2, 2, MAGIC_ROBERTSON_DBL, robertson, 4.6e-6, 1.44)       \
+    X(dbl, sse, 2, 1, MAGIC_LOMONT_DBL, lomont, 1.78e-3, 0.89)            \
+    X(dbl, avx2, 1, 1, MAGIC_ROBERTSON_DBL, robertson, 1.76e-3, 0.50)     \
+    X(dbl, avx2, 2, 1, MAGIC_ROBERTSON_DBL, robertson, 1.76e-3, 0.47)     \
+    X(dbl, avx2, 4, 1, MAGIC_ROBERTSON_DBL, robertson, 1.76e-3, 0.48)     \
+    X(dbl, avx2, 2, 0, MAGIC_ROBERTSON_DBL, robertson, 3.5e-2, 0.42)      \
+    X(dbl, avx2, 2, 2, MAGIC_ROBERTSON_DBL, robertson, 4.6e-6, 0.76)      \
+    X(dbl, avx2, 2, 1, MAGIC_LOMONT_DBL, lomont, 1.78e-3, 0.47)           \
+    X(dbl, avx512, 1, 1, MAGIC_ROBERTSON_DBL, robertson, 1.76e-3, 0.48)   \
+    X(dbl, avx512, 2, 1, MAGIC_ROBERTSON_DBL, robertson, 1.76e-3, 0.44)   \
+    X(dbl, avx512, 4, 1, MAGIC_ROBERTSON_DBL, robertson, 1.76e-3, 0.44)   \
+    X(dbl, avx512, 2, 2, MAGIC_ROBERTSON_DBL, robertson, 4.6e-6, 0.44)
+
+#define GEN_ELEM_flt float
+#define GEN_ELEM_dbl double
+
+// CpuFeature flags required by the kernels of each width
+#define GEN_FEATURES_scalar 0
+#define GEN_FEATURES_sse CPU_SSE2
+#define GEN_FEATURES_avx2 (CPU_AVX2 | CPU_FMA)
+#define GEN_FEATURES_avx512 CPU_AVX512F
+
+// Name of the generated kernel function
+#define GEN_NAME(T, W, U, N, TAG) fastInvSqrt_gen_##T##_##W##_u##U##_n##N##_##TAG
+
+// Prototype of a generated kernel, used with the matrices below
+#define GEN_PROTOTYPE(T, W, U, N, MAGIC, TAG, ERR, COST) \
+    void GEN_NAME(T, W, U, N, TAG)(size_t n, GEN_ELEM_##T vals[n], GEN_ELEM_##T out[n]);
+
+// Entry of the versions table (see parser.h) for a generated kernel
+#define GEN_VERSION(T, W, U, N, MAGIC, TAG, ERR, COST) \
+    {"gen_" #W "_u" #U "_n" #N "_" #TAG, {.fn_##T = GEN_NAME(T, W, U, N, TAG)}, GEN_FEATURES_##W, {NULL}, ERR, COST, 0},
+
+/**
+ * @brief Calculate the reciprocal square root of an array of n floats or doubles with the generated kernel
+ * fastInvSqrt_gen_T_W_uU_nN_TAG for every row of KERNEL_MATRIX_FLT and KERNEL_MATRIX_DBL
+ *
+ * @details The MagicNumber gives the initial guess, followed by N Newton iterations y * (1.5 - xhalf * (y * y)),
+ * with FMA for avx2 and avx512. There are no alignment requirements for vals and out.
+ *
+ * @param n Number of values
+ * @param vals Pointer to the input array
+ * @param out Pointer to the output array, may be equal to vals
+ */
+KERNEL_MATRIX_FLT(GEN_PROTOTYPE)
+KERNEL_MATRIX_DBL(GEN_PROTOTYPE)
+
+#endif // IMPLEMENTIERUNG_KERNELGEN_H
@@ -17,4 +17,30 @@
  */
 void print_magicnumber(int db);
 
+/**
+ * @brief Print out the jointly tuned MagicNumber and Newton coefficients for the given data type float/double
+ *
+ * @details Instead of the fixed Newton iteration y * (1.5 - 0.5 * x * y * y), the iterations
+ * y * (k1 - k2 * x * y * y) and y * (k3 - k4 * x * y * y) are used. For every MagicNumber the best coefficients
+ * follow from the range of the initial approximation, so the MagicNumber minimizing the ratio of its largest and
+ * smallest relative approximation is searched (exhaustively for floats), and the coefficients giving the smallest
+ * maximum relative error are calculated for 1 and 2 iterations.
+ * The maximum errors and the constants as defines for inverse_sqrt.h are printed to the console.
+ *
+ * @param db db = 0 if considering float; db = 1 if considering double
+ */
+void print_tuning(int db);
+
+/**
+ * @brief Print out the MagicNumber for the 16-bit formats half precision (IEEE 754 binary16) or bfloat16
+ *
+ * @details The seed MagicNumber - (x >> 1) is computed on the 16-bit patterns, so it needs no conversion
+ * to float. The MagicNumber giving the smallest maximum relative error after one Newton iteration in float
+ * arithmetic is searched exhaustively over all MagicNumbers and all values in [0.5, 2). It is printed with its
+ * relative error to the console.
+ *
+ * @param bf bf = 0 if considering half precision; bf = 1 if considering bfloat16
+ */
+void print_magicnumber16(int bf);
+
 #endif // IMPLEMENTIERUNG_MAGICNUMBER_H
\ No newline at end of file
@@ -0,0 +1,127 @@
+/** @headerfile normalize.h
+ *  @brief Function prototypes for the normalization of 3D vectors and matrix rows with the Fast Inverse Square Root
+ *
+ *  @details Normalizing with the array kernels takes three passes: squared lengths into a temporary
+ *  array, fastInvSqrt_flt on it and the scaling of the components. The kernels here do all three in
+ *  one pass over the vectors with SSE, so every loaded component is used for the dot product and the
+ *  scaling without going through memory in between. Vectors are either stored interleaved (AoS,
+ *  x0 y0 z0 x1 y1 z1 ...) or as three separate arrays (SoA). The _DoubleNewton versions apply a second
+ *  Newton iteration. A zero vector stays zero, the result for vectors containing inf or NaN is undefined.
+ *  The normalizeRows kernels do the same for the rows of a matrix of arbitrary width.
+ *
+ *  @author Yll Kryeziu (ge94noh)
+ */
+
+#ifndef IMPLEMENTIERUNG_NORMALIZE_H
+#define IMPLEMENTIERUNG_NORMALIZE_H
+
+#include <stddef.h>
+
+/**
+ * @brief Normalize n interleaved float 3D vectors using the Fast Inverse Square Root with one Newton iteration
+ *
+ * @details 4 vectors (12 floats) are processed at once: the squared components are regrouped with shuffles
+ * into the sums x*x + y*y + z*z of the 4 vectors, and the 4 scaling factors are broadcast back to the
+ * interleaved layout. The last n % 4 vectors are copied into a zero-padded buffer of 4 vectors and normalized
+ * with the same SIMD step, so the result does not depend on the position of a vector in the array.
+ *
+ * @param n Number of vectors
+ * @param vals Pointer to the input array of 3 * n floats (x0, y0, z0, x1, ...)
+ * @param out Pointer to the output array of 3 * n floats, may be equal to vals
+ */
+void normalizeAoS_flt(size_t n, const float *vals, float *out);
+
+/**
+ * @brief Normalize n interleaved float 3D vectors like normalizeAoS_flt, but with 2 Newton iterations
+ */
+void normalizeAoS_flt_DoubleNewton(size_t n, const float *vals, float *out);
+
+/**
+ * @brief Normalize n float 3D vectors stored as separate arrays of the components using the Fast Inverse
+ * Square Root with one Newton iteration, 4 vectors at once
+ *
+ * @details The last n % 4 vectors are normalized with the same SIMD step in zero-padded buffers.
+ *
+ * @param n Number of vectors
+ * @param x, y, z Pointers to the input arrays of n floats each
+ * @param outX, outY, outZ Pointers to the output arrays of n floats each, may be equal to the input arrays
+ */
+void normalizeSoA_flt(size_t n, const float *x, const float *y, const float *z, float *outX, float *outY, float *outZ);
+
+/**
+ * @brief Normalize n float 3D vectors like normalizeSoA_flt, but with 2 Newton iterations
+ */
+void normalizeSoA_flt_DoubleNewton(size_t n, const float *x, const float *y, const float *z, float *outX, float *outY, float *outZ);
+
+/**
+ * @brief Normalize n interleaved double 3D vectors using the Fast Inverse Square Root with one Newton iteration
+ *
+ * @details 2 vectors (6 doubles) are processed at once, a remaining vector with the same SIMD step in a
+ * zero-padded buffer of 2 vectors.
+ *
+ * @param n Number of vectors
+ * @param vals Pointer to the input array of 3 * n doubles (x0, y0, z0, x1, ...)
+ * @param out Pointer to the output array of 3 * n doubles, may be equal to vals
+ */
+void normalizeAoS_dbl(size_t n, const double *vals, double *out);
+
+/**
+ * @brief Normalize n interleaved double 3D vectors like normalizeAoS_dbl, but with 2 Newton iterations
+ */
+void normalizeAoS_dbl_DoubleNewton(size_t n, const double *vals, double *out);
+
+/**
+ * @brief Normalize n double 3D vectors stored as separate arrays of the components using the Fast Inverse
+ * Square Root with one Newton iteration, 2 vectors at once
+ *
+ * @details A remaining vector is normalized with the same SIMD step in zero-padded buffers.
+ *
+ * @param n Number of vectors
+ * @param x, y, z Pointers to the input arrays of n doubles each
+ * @param outX, outY, outZ Pointers to the output arrays of n doubles each, may be equal to the input arrays
+ */
+void normalizeSoA_dbl(size_t n, const double *x, const double *y, const double *z, double *outX, double *outY, double *outZ);
+
+/**
+ * @brief Normalize n double 3D vectors like normalizeSoA_dbl, but with 2 Newton iterations
+ */
+void normalizeSoA_dbl_DoubleNewton(size_t n, const double *x, const double *y, const double *z, double *outX, double *outY, double *outZ);
+
+/**
+ * @brief Normalize every row of a row-major float matrix in place to Euclidean length 1 using the Fast
+ * Inverse Square Root with one Newton iteration
+ *
+ * @details For every row the squared norm is reduced with 4 independent vector accumulators (AVX2 with
+ * FMA if supported, SSE otherwise), the scaling factor is computed with the Fast Inverse Square Root and
+ * the row is scaled while it is still in the cache. The rows are distributed over the threads of the pool
+ * (see pool_init), the results do not depend on the number of threads. Rows of zeros stay zero.
+ *
+ * @param rows Number of rows
+ * @param cols Number of elements in each row
+ * @param stride Distance between the starts of two consecutive rows in elements, at least cols
+ * @param matrix Pointer to the first element of the matrix
+ */
+void normalizeRows_flt(size_t rows, size_t cols, size_t stride, float *matrix);
+
+/**
+ * @brief Normalize every row of a row-major float matrix like normalizeRows_flt, but with 2 Newton iterations
+ */
+void normalizeRows_flt_DoubleNewton(size_t rows, size_t cols, size_t stride, float *matrix);
+
+/**
+ * @brief Normalize every row of a row-major double matrix in place to Euclidean length 1 using the Fast
+ * Inverse Square Root with one Newton iteration, see normalizeRows_flt
+ *
+ * @param rows Number of rows
+ * @param cols Number of elements in each row
+ * @param stride Distance between the starts of two consecutive rows in elements, at least cols
+ * @param matrix Pointer to the first element of the matrix
+ */
+void normalizeRows_dbl(size_t rows, size_t cols, size_t stride, double *matrix);
+
+/**
+ * @brief Normalize every row of a row-major double matrix like normalizeRows_dbl, but with 2 Newton iterations
+ */
+void normalizeRows_dbl_DoubleNewton(size_t rows, size_t cols, size_t stride, double *matrix);
+
+#endif // IMPLEMENTIERUNG_NORMALIZE_H
@@ -0,0 +1,77 @@
+/** @headerfile numparse.h
+ *  @brief Function prototypes for the fast conversion of decimal text to float/double
+ *
+ *  @author Ngoc Kim Ngan Nguyen (ge23fak)
+ */
+
+#ifndef IMPLEMENTIERUNG_NUMPARSE_H
+#define IMPLEMENTIERUNG_NUMPARSE_H
+
+#include <stddef.h>
+
+/**
+ * @brief Result of parse_flt and parse_dbl
+ */
+enum ParseStatus
+{
+    PARSE_OK = 0,
+    PARSE_INVALID, // The text up to the next whitespace is not a number
+    PARSE_RANGE,   // The number over- or underflows the data type
+};
+
+/**
+ * @brief Return a pointer to the first non-whitespace character in [p, end), or end if there is none
+ *
+ * @details Whitespace is recognised 16 bytes at a time with SSE2 compares, so long runs of
+ * blank characters and line breaks are skipped quickly.
+ *
+ * @param p Start of the text
+ * @param end End of the text, the text does not need to be null-terminated
+ */
+const char *skip_space(const char *p, const char *end);
+
+/**
+ * @brief Convert the number at *p to the nearest float and advance *p behind it
+ *
+ * @details The number has to be followed by whitespace or end. Decimal numbers are converted without strtof:
+ * 8 digits are combined at once (SWAR) into a mantissa of up to 19 significant digits. If mantissa and power
+ * of ten are exactly representable, a single multiplication or division rounds correctly (Clinger's fast path),
+ * otherwise the mantissa is multiplied with a 128 bit approximation of the power of five (Eisel-Lemire algorithm,
+ * as in fast_float). Longer mantissas are truncated to 19 digits and accepted if rounding up the last digit gives
+ * the same float. Only the rare ambiguous cases, subnormal results, overflow, inf, nan and hexadecimal notation
+ * fall back to strtof, so the result is always rounded correctly.
+ *
+ * @param p Pointer to the text pointer, moved behind the number if PARSE_OK is returned
+ * @param end End of the text, the text does not need to be null-terminated
+ * @param out Converted value
+ * @return PARSE_OK, PARSE_INVALID or PARSE_RANGE
+ */
+int parse_flt(const char **p, const char *end, float *out);
+
+/**
+ * @brief Convert the number at *p to the nearest double and advance *p behind it
+ *
+ * @details Same as parse_flt for doubles, the fallback is strtod.
+ *
+ * @param p Pointer to the text pointer, moved behind the number if PARSE_OK is returned
+ * @param end End of the text, the text does not need to be null-terminated
+ * @param out Converted value
+ * @return PARSE_OK, PARSE_INVALID or PARSE_RANGE
+ */
+int parse_dbl(const char **p, const char *end, double *out);
+
+/**
+ * @brief Return the index of the first value which is not positive (<= 0) in an array of n floats, or n if all are positive
+ *
+ * @details The values are compared 4 at a time with SSE, so a whole array is validated in one pass after parsing.
+ */
+size_t first_nonpositive_flt(size_t n, const float vals[n]);
+
+/**
+ * @brief Return the index of the first value which is not positive (<= 0) in an array of n doubles, or n if all are positive
+ *
+ * @details The values are compared 2 at a time with SSE2.
+ */
+size_t first_nonpositive_dbl(size_t n, const double vals[n]);
+
+#endif // IMPLEMENTIERUNG_NUMPARSE_H
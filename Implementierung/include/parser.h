@@ -7,6 +7,29 @@
 #ifndef IMPLEMENTIERUNG_PARSER_H
 #define IMPLEMENTIERUNG_PARSER_H
 
+#include <stdio.h>
+
+#define MAX_VERSIONS 64 // Maximum number of versions per data type, unused entries stay zero-initialised
+
+typedef union
+{
+    void (*fn_flt)(size_t, float *, float *);   // Function type for floats
+    void (*fn_dbl)(size_t, double *, double *); // Function type for doubles
+} Func;
+
+struct Version
+{
+    const char *name; // Version name
+    Func fn;          // Corresponding function to version name
+    int features;     // CpuFeature flags the function requires
+    Func stream;      // Variant with non-temporal stores for arrays larger than the last-level cache, NULL if there is none
+    double maxError;  // Upper bound of the relative error over all positive normal inputs, see select_version
+    double cost;      // Measured runtime in cycles per element for arrays in the L1/L2 cache, used to rank the versions
+    int special;      // 1 if the function handles 0, inf, negative values and NaN itself, so the input is not validated
+};
+
+extern const struct Version versions[][MAX_VERSIONS]; // Look-up table for functions, row 0 for floats and row 1 for doubles
+
 /**
  * @brief Print out usage description to the console
  */
@@ -22,35 +45,86 @@ void print_help(void);
  */
 void exit_failure(void);
 
+/**
+ * @brief Return the function corresponding to data type float/double and version name
+ *
+ * @details The version name "auto" is resolved to the fastest version supported by the CPU.
+ * If the version name is invalid or the version requires instruction set extensions the CPU
+ * does not support, an error message is printed and the program is terminated with EXIT_FAILURE.
+ *
+ * @param db db = 0 if considering float; db = 1 if considering double
+ * @param version_name Name of the function version
+ */
+Func get_version(int db, const char *version_name);
+
+/**
+ * @brief Return the function corresponding to data type float/double and version name for arrays of n values
+ *
+ * @details Same as get_version, but if the input and output arrays together are larger than the last-level
+ * cache (see cpu_llc_size) and the version has a variant with non-temporal stores, that variant is returned.
+ *
+ * @param db db = 0 if considering float; db = 1 if considering double
+ * @param version_name Name of the function version
+ * @param n Number of values the function is called with
+ */
+Func get_version_for_size(int db, const char *version_name, size_t n);
+
+/**
+ * @brief Return the name of the cheapest version for data type float/double whose relative error does not exceed max_error
+ *
+ * @details The error bounds in the versions table are the maxima of the exhaustive sweep over all positive normal
+ * floats and of the sampled sweep over the doubles (see benchmarkAccuracy_flt/dbl in tests.h, which also check
+ * every bound), rounded up to two digits. The float maxima of the versions with 2 Newton iterations come from
+ * inputs near FLT_MAX, where y * y is subnormal and loses precision. For the
+ * versions seeded with rsqrtps/rsqrt14 the architectural bounds of the estimates (1.5 * 2^-12 and 2^-14) carried
+ * through the Newton iterations are used instead where they are larger, so the bounds hold on every CPU.
+ * Among the versions meeting the bound and supported by the CPU, the one with the lowest cost is returned.
+ * If no version is accurate enough, an error message naming the smallest available bound is printed and the
+ * program is terminated with EXIT_FAILURE.
+ *
+ * @param db db = 0 if considering float; db = 1 if considering double
+ * @param max_error Maximum relative error |result - 1/sqrt(x)| / (1/sqrt(x)) the caller accepts
+ */
+const char *select_version(int db, double max_error);
+
 /**
  * @brief Print out an array with the length n and type float (db = 0) or double (db = 1) to the console
  *
+ * @details The values are formatted by format_fixed or format_shortest_flt/dbl (see format.h) into a large
+ * buffer, which is written to stdout with few write calls instead of one printf call per value.
+ *
  * @param db db = 0 if considering float; db = 1 if considering double
  * @param n Number of values to in input array
  * @param out The given array to be printed out
+ * @param format FORMAT_FIXED for 10 decimal places or FORMAT_SHORTEST for the shortest round-trip representation
  */
-void print_out(int db, size_t n, void *out);
+void print_out(int db, size_t n, void *out, int format);
 
 /**
- * @brief Count the total number of lines in the file given by path
+ * @brief Return 1 if the version of data type float/double handles all inputs including 0, inf, negative values and NaN
+ * (see fastInvSqrt_flt_Special in inverse_sqrt.h), 0 otherwise or if there is no such version
  *
- * @details The method checks if the file given by path is a regular file and returns the total number of lines in it.
- *
- * @param path Path to a file
+ * @param db db = 0 if considering float; db = 1 if considering double
+ * @param version_name Name of the function version
  */
-size_t sizeReadFile(const char *path);
+int version_special(int db, const char *version_name);
 
 /**
- * @brief Read numbers from a the file given by path and return a pointer to an array storing these numbers
+ * @brief Read numbers from the file given by path and return a pointer to an array storing these numbers
  *
- * @details The method reads each line of the file given by path, converts the read string from each line to a float/double,
- * checks if the converted value is valid, stores all converted values in an array and returns a pointer to this array.
+ * @details The method checks if the file given by path is a regular file, maps it into memory and converts
+ * all whitespace separated numbers in a single pass with parse_flt/parse_dbl (see numparse.h).
+ * Afterwards the whole array is checked for values which are not positive if positive is set.
+ * If a number is invalid or not positive, an error message is printed and NULL is returned.
+ * With more than one thread in the pool the values are finally moved into an array from pool_alloc,
+ * so its pages are first-touched by the threads processing them (see threadpool.h).
  *
  * @param db db = 0 if considering float; db = 1 if considering double
- * @param count Number of values to be stored in returned array
+ * @param count Set to the number of values stored in the returned array
  * @param path Path to a file
+ * @param positive 1 to reject values which are not positive, 0 for versions handling all inputs (see version_special)
  */
-void *readFile(int db, size_t count, const char *path);
+void *readFile(int db, size_t *count, const char *path, int positive);
 
 /**
  * @brief Read floating point numbers directly from terminal and return a pointer to an array storing these numbers
@@ -61,8 +135,24 @@ void *readFile(int db, size_t count, const char *path);
  * @param db db = 0 if considering float; db = 1 if considering double
  * @param argc Number of arguments on the command line
  * @param argv Arguments passed to the program through the command line
+ * @param positive 1 to reject values which are not positive, 0 for versions handling all inputs (see version_special)
  */
-void *readTerminal(int db, int argc, char *argv[]);
+void *readTerminal(int db, int argc, char *argv[], int positive);
+
+/**
+ * @brief Execute the function specified by version_name and type float/double with arguments n, vals, out in "loop" iterations
+ *
+ * @details The arrays are split among the threads of the worker pool (see threadpool.h). Nothing is printed,
+ * so out can e.g. point into a file mapped with bin_create (see binio.h). The method returns the total runtime.
+ *
+ * @param db db = 0 if considering float; db = 1 if considering double
+ * @param version_name Name of the funtion to be executed
+ * @param n Number of values to be used as input
+ * @param vals Pointer to the input array
+ * @param out Pointer to the output array
+ * @param loop Number of function iterations to run
+ */
+double compute(int db, const char *version_name, size_t n, void *vals, void *out, int loop);
 
 /**
  * @brief Execute the function specified by version_name and type float/double with arguments n, vals in "loop" iterations
@@ -76,7 +166,39 @@ void *readTerminal(int db, int argc, char *argv[]);
  * @param n Number of values to be used as input
  * @param vals Pointer to the input array
  * @param loop Number of function iterations to run
+ * @param format FORMAT_FIXED or FORMAT_SHORTEST, see print_out
+ * @param echo echo = 1 if the input array is printed out before the results, otherwise 0
+ */
+double execute(int db, const char *version_name, size_t n, void *vals, int loop, int format, int echo);
+
+/**
+ * @brief Execute the mixed-type kernel reading type float/double and writing the other type with arguments n, vals, out
+ * in "loop" iterations
+ *
+ * @details fastInvSqrt_dbl_flt or fastInvSqrt_flt_dbl (their AVX2 versions if the CPU supports AVX2 and FMA) convert the
+ * values in registers, which saves the conversion pass over the whole array. The arrays are split among the threads of the
+ * worker pool. Doubles are computed in float, so if one of them is outside the range of normal floats, an error message is
+ * printed and the program is terminated with EXIT_FAILURE. Nothing is printed otherwise, the method returns the total runtime.
+ *
+ * @param db db = 0 for float input and double output; db = 1 for double input and float output
+ * @param n Number of values to be used as input
+ * @param vals Pointer to the input array
+ * @param out Pointer to the output array of the other type
+ * @param loop Number of function iterations to run
+ */
+double computeConvert(int db, size_t n, void *vals, void *out, int loop);
+
+/**
+ * @brief Like execute, but with the mixed-type kernel of computeConvert: the input array of type float/double is printed
+ * unless echo = 0, and the results are printed as the other type
+ *
+ * @param db db = 0 for float input and double output; db = 1 for double input and float output
+ * @param n Number of values to be used as input
+ * @param vals Pointer to the input array
+ * @param loop Number of function iterations to run
+ * @param format FORMAT_FIXED or FORMAT_SHORTEST, see print_out
+ * @param echo echo = 1 if the input array is printed out before the results, otherwise 0
  */
-double execute(int db, const char *version_name, size_t n, void *vals, int loop);
+double executeConvert(int db, size_t n, void *vals, int loop, int format, int echo);
 
 #endif // IMPLEMENTIERUNG_PARSER_H
@@ -0,0 +1,38 @@
+/** @headerfile stream.h
+ *  @brief Function prototypes for processing input of arbitrary size in fixed-size blocks
+ *
+ *  @author Ngoc Kim Ngan Nguyen (ge23fak)
+ */
+
+#ifndef IMPLEMENTIERUNG_STREAM_H
+#define IMPLEMENTIERUNG_STREAM_H
+
+#include <stdio.h>
+
+#define STREAM_BLOCK 65536 // Number of values per block
+#define STREAM_BLOCKS 4    // Number of blocks in flight, bounds the memory usage of the pipeline
+
+/**
+ * @brief Read whitespace separated numbers from in, calculate their inverse square roots with the function
+ * specified by version_name and type float/double and print the results to stdout, using bounded memory
+ *
+ * @details The input is processed in blocks of STREAM_BLOCK values by a pipeline of three stages:
+ * a reader thread parses and validates the numbers, the calling thread runs the function on each
+ * block (split among the worker pool, see threadpool.h) and a writer thread formats the results into a large buffer and writes it to stdout.
+ * The stages work on different blocks at the same time. Only STREAM_BLOCKS blocks exist, so the memory
+ * usage does not depend on the size of the input. In contrast to execute, the input values are not echoed.
+ * Values which are not positive are invalid unless the version handles them (see version_special in parser.h).
+ * If an invalid number is read, an error message is printed and processing stops after the
+ * results of the preceding values are printed. Numbers may have any length, like in readFile, and input
+ * without any number is an error as well.
+ *
+ * @param db db = 0 if considering float; db = 1 if considering double
+ * @param version_name Name of the funtion to be executed
+ * @param in Opened input file, e.g. stdin
+ * @param format FORMAT_FIXED or FORMAT_SHORTEST, see format.h
+ * @param time Set to the total runtime of the function calls
+ * @return 0 on success, -1 if the input contained an invalid number, no number at all or could not be read
+ */
+int executeStream(int db, const char *version_name, FILE *in, int format, double *time);
+
+#endif // IMPLEMENTIERUNG_STREAM_H
@@ -19,6 +19,13 @@ void basicFunctionality_flt(void);
  */
 void basicFunctionality_dbl(void);
 
+/**
+ * @brief Test the versions with special value handling (fastInvSqrt_flt_Special, fastInvSqrt_dbl_Special and their
+ * AVX2 and AVX-512 versions) with 0, -0, inf, -inf, a negative value, NaN and some positive values.
+ * Prints sample, the results of 1/sqrt() and of the kernels supported by the CPU to console.
+ */
+void specialValues(void);
+
 /**
  * @brief Generates result_plot_flt.csv in ./benchmark_outputs for plotting
  * with gnuplot. The function calculates the invsqrt using the SIMD-implementation
@@ -28,14 +35,19 @@ void basicFunctionality_dbl(void);
 void plotRange_flt(void);
 
 /**
- * @brief Iterates through every float and calculates the error for every implementation compared
- * exact result of 1/sqrt(). Maximum relative error for every implementation is printed to console.
+ * @brief Iterates through every positive normal float and calculates the error of every registered version
+ * compared to the exact result of 1/sqrt(). The floats are passed in large blocks to the vector kernels and the
+ * blocks are split among all cores. Maximum and mean error in ULP and relative error (in %) of every version are
+ * printed to console and results_accuracy_flt.csv, the same per binade of the input to results_accuracy_binades_flt.csv
+ * in ./benchmark_outputs. The maximum relative error of every version is checked against its maxError in the
+ * versions table (see select_version in parser.h), every exceeded bound is reported as FAILED.
  */
 void benchmarkAccuracy_flt(void);
 
 /**
- * @brief Iterates through many doubles and calculates the error for every implementation compared
- * exact result of 1/sqrt(). Maximum relative error for every implementation is printed to console.
+ * @brief Same as benchmarkAccuracy_flt for doubles including the check of the error bounds, but only 2^16 doubles
+ * of every binade are tested.
+ * Results are written to results_accuracy_dbl.csv and results_accuracy_binades_dbl.csv in ./benchmark_outputs.
  */
 void benchmarkAccuracy_dbl(void);
 
@@ -49,9 +61,11 @@ void benchmarkTime_flt_wrapper(int maxIncrements);
 
 /**
  * @brief Creates input array depending on sampleSize with floats of random sizes.
- * Repeats calculation of inverse square roots of every implementation according to
- * definition of TRIALS and measures average time. Writes sampleSize and measured times
- * to result_speed_flt.csv in ./benchmark_outputs for plotting.
+ * Measures native 1/sqrtf(), the scalar 2 Newton version and every version of the versions table
+ * supported by the CPU on this array with bench_run (warmup, BENCH_REPS timed calls). Writes sampleSize,
+ * version, median/p5/p95/p99 time, cycles per element and GB/s of every kernel as one line
+ * to result_speed_flt.csv in ./benchmark_outputs for plotting. Versions 18 to 20 against 0, 2 and 4 show the
+ * overhead of the special value handling for valid input.
  * @param sampleSize size of input and output array
  * @param file pointer to file previously openend in benchmark wrapper
  */
@@ -66,15 +80,110 @@ void benchmarkTime_flt(int sampleSize, FILE **file);
 void benchmarkTime_dbl_wrapper(int maxIncrements);
 
 /**
- * @brief Creates input array depending on sampleSize with doubles of random sizes.
- * Repeats calculation of inverse square roots of every implementation according to
- * definition of TRIALS and measures average time. Writes sampleSize and measured times
- * to result_speed_dbl.csv in ./benchmark_outputs for plotting.
+ * @brief Same as benchmarkTime_flt for doubles. Writes the results to result_speed_dbl.csv
+ * in ./benchmark_outputs for plotting.
  * @param sampleSize size of input and output array
  * @param file pointer to file previously openend in benchmark wrapper
  */
 void benchmarkTime_dbl(int sampleSize, FILE **file);
 
+/**
+ * @brief Measures the runtime of the SSE implementations for floats and doubles split among
+ * 1, 2, 4, ... threads of the worker pool up to the number of cores. Writes thread count and
+ * average times to results_threads.csv in ./benchmark_outputs for plotting.
+ * @param sampleSize size of input and output arrays
+ */
+void benchmarkThreads(int sampleSize);
+
+/**
+ * @brief Measures native 1/sqrt() and every version of the versions table supported by the CPU for array sizes
+ * doubling from 4 KiB (L1-resident) up to 2 GiB per array (limited to a quarter of the memory), together with memcpy
+ * and a STREAM-like triad as bandwidth references. Versions with a non-temporal-store variant are measured a second
+ * time with it (version name suffixed with -NT). Writes working set in bytes, size, version, median time,
+ * cycles per element, GB/s and the fraction of the memcpy and triad bandwidth at the same size to
+ * results_sizes_flt.csv or results_sizes_dbl.csv in ./benchmark_outputs.
+ * @param db db = 0 for the float kernels; db = 1 for the double kernels
+ */
+void benchmarkSizes(int db);
+
+/**
+ * @brief Measures the latency of native 1/sqrt(), of every version of the versions table supported by the CPU
+ * (called through the function pointer) and of the inline API of inverse_sqrt_inline.h for n = 1 to 64 values
+ * per call. The calls form a dependent chain, see bench_latency. Writes size, version, cycles per call and
+ * cycles per element to results_latency_flt.csv or results_latency_dbl.csv in ./benchmark_outputs.
+ * @param db db = 0 for the float kernels; db = 1 for the double kernels
+ */
+void benchmarkLatency(int db);
+
+/**
+ * @brief Measures the fused normalization kernels of normalize.h in AoS and SoA layout with 1 and 2 Newton
+ * iterations against the normalization in three passes (squared lengths, fastInvSqrt, scaling) for 2^10 to
+ * 2^22 random vectors. Writes number of vectors, version, median time, ns per vector, GB/s and the largest
+ * deviation of the length of the results from 1 to results_normalize_flt.csv or results_normalize_dbl.csv
+ * in ./benchmark_outputs.
+ * @param db db = 0 for the float kernels; db = 1 for the double kernels
+ */
+void benchmarkNormalize(int db);
+
+/**
+ * @brief Measures the row normalization kernels of normalize.h for matrices with 2^24 random elements and
+ * 64 to 4096 columns against the normalization in three passes (squared norms, fastInvSqrt, scaling).
+ * The kernels run on one thread and on all cores. Writes columns, rows, threads, version, mean time,
+ * GB/s and the largest deviation of the row norms from 1 to results_rows_flt.csv or results_rows_dbl.csv
+ * in ./benchmark_outputs.
+ * @param db db = 0 for the float kernels; db = 1 for the double kernels
+ */
+void benchmarkRows(int db);
+
+/**
+ * @brief Measures fastSqrt and mulInvSqrt (SSE and, if supported, AVX2) against fastInvSqrt followed by a second
+ * pass for the multiplication for 2^12 to 2^24 values. Writes size, version, median time, cycles per element and
+ * GB/s to results_fused_flt.csv or results_fused_dbl.csv in ./benchmark_outputs.
+ * @param db db = 0 for the float kernels; db = 1 for the double kernels
+ */
+void benchmarkFused(int db);
+
+/**
+ * @brief Measures the half precision and bfloat16 kernels fastInvSqrt_f16/bf16 (and their AVX-512 versions)
+ * against widening the 16-bit arrays to float, calling fastInvSqrt_flt_AVX2 and converting the results back,
+ * for 2^12 to 2^24 random positive normal values. Writes size, version, median time, cycles per element, GB/s of
+ * the 16-bit arrays and the maximum relative error to results_half.csv in ./benchmark_outputs.
+ */
+void benchmarkHalf(void);
+
+/**
+ * @brief Measures the mixed-precision double kernels (float estimate refined with 1 or 2 double Newton iterations)
+ * against native 1/sqrt(), fastInvSqrt_dbl_DoubleNewton, the AVX2 and AVX-512 versions with 2 Newton iterations and
+ * the rsqrt14 version with 2 Newton iterations, for 2^14 and 2^24 random positive normal doubles of all binades.
+ * Writes size, version, median time, cycles per element, GB/s and the maximum relative error, so that the throughput
+ * can be compared at equal accuracy, to results_mixed.csv in ./benchmark_outputs.
+ */
+void benchmarkMixed(void);
+
+/**
+ * @brief Measures the mixed-type kernels fastInvSqrt_dbl_flt and fastInvSqrt_flt_dbl (SSE and, if supported, AVX2)
+ * against converting the whole array first and calling fastInvSqrt_flt_AVX2 or fastInvSqrt_dbl_AVX2, for 2^14 and 2^24
+ * values. Writes size, version, median time, cycles per element and GB/s of the input and output array to
+ * results_convert.csv in ./benchmark_outputs.
+ */
+void benchmarkConvert(void);
+
+/**
+ * @brief Measures every generated kernel of the kernel matrix (see kernelgen.h) supported by the CPU for 2^14 and 2^24
+ * values and prints the fastest configuration per type and number of Newton iterations. Writes type, size, version,
+ * width, unroll factor, Newton iterations, MagicNumber, median time, cycles per element, GB/s and the maximum relative
+ * error of the sample to results_kernelmatrix.csv in ./benchmark_outputs.
+ */
+void benchmarkKernelMatrix(void);
+
+/**
+ * @brief Checks and measures the output formatter (see format.h) with 2^18 finite floats and doubles of all binades.
+ * Prints how many texts of format_shortest_flt/dbl are not read back as exactly the same value as the %.9g/%.17g
+ * text, and how many texts of format_fixed differ from printf("%.10f"). Writes type, size, version, median time and
+ * cycles per value of the formatter and of snprintf to results_format.csv in ./benchmark_outputs.
+ */
+void benchmarkFormat(void);
+
 /**
  * @brief Starts all test and benchmark executions
  */
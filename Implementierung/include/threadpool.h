@@ -0,0 +1,119 @@
+/** @headerfile threadpool.h
+ *  @brief Function prototypes for the persistent worker pool used to process
+ *  large arrays on several cores
+ *
+ *  @author Yll Kryeziu (ge94noh)
+ */
+
+#ifndef IMPLEMENTIERUNG_THREADPOOL_H
+#define IMPLEMENTIERUNG_THREADPOOL_H
+
+#include <stddef.h>
+
+#define CACHE_LINE 64 // Size of a cache line in bytes, chunks handed to the threads are multiples of it
+#define POOL_GRAIN 16 // Elements per grain of pool_alloc and parallelInvSqrt, one cache line of floats and two of doubles
+
+/**
+ * @brief Start the persistent worker pool with the given total number of threads
+ *
+ * @details The calling thread counts as thread 0 and takes part in every job, so nthreads - 1
+ * worker threads are created. Every thread, including the caller, is pinned to its own CPU of the
+ * affinity mask of the process (round-robin if there are more threads than CPUs), the caller gets its
+ * previous mask back in pool_destroy. A running pool is shut down first.
+ * With nthreads = 1 no thread is created and all jobs run directly on the caller.
+ *
+ * @param nthreads Total number of threads, has to be greater than 0
+ * @return 0 on success, -1 if the threads could not be created (the pool then runs single-threaded)
+ */
+int pool_init(int nthreads);
+
+/**
+ * @brief Stop and join all worker threads and restore the affinity mask of the caller. The pool falls back to
+ * single-threaded execution afterwards.
+ */
+void pool_destroy(void);
+
+/**
+ * @brief Return the total number of threads of the pool, including the calling thread
+ */
+int pool_size(void);
+
+/**
+ * @brief Split the index range [0, n) into one contiguous chunk per thread and run task on each chunk in parallel
+ *
+ * @details Chunk boundaries are multiples of grain, so that chunks of arrays start on a cache line
+ * and the vector loops of the kernels see exactly the same element groups as a single-threaded call.
+ * Thread i always receives the i-th chunk for the same n and grain, which keeps first-touched pages local.
+ * The method returns when all chunks are processed.
+ *
+ * @param n Number of elements
+ * @param grain Granularity of the chunk boundaries in elements
+ * @param task Function processing the elements [begin, end)
+ * @param arg Argument passed through to task
+ */
+void pool_run(size_t n, size_t grain, void (*task)(size_t begin, size_t end, void *arg), void *arg);
+
+/**
+ * @brief Allocate a cache-line-aligned array of n elements with size bytes each and let every thread
+ * first-touch (zero) the chunk it will later process in pool_run, so the pages are placed on its NUMA node
+ *
+ * @details The chunks are computed with POOL_GRAIN for every element size, like in parallelInvSqrt_flt and the
+ * other parallel kernels, so float and double arrays of the same n are split at the same indices.
+ *
+ * @param n Number of elements
+ * @param size Size of one element in bytes
+ * @return Pointer to the array which has to be released with free(), NULL if the allocation failed
+ */
+void *pool_alloc(size_t n, size_t size);
+
+/**
+ * @brief Calculate the reciprocal square root of n floats with the kernel fn on all threads of the pool
+ *
+ * @details The arrays are split into cache-line-aligned chunks of POOL_GRAIN floats, so the results are
+ * byte-identical to calling fn(n, vals, out) directly.
+ *
+ * @param fn Kernel used for every chunk, e.g. fastInvSqrt_flt
+ * @param n Number of float values in the arrays
+ * @param vals Pointer to the input array with float values
+ * @param out Pointer to the float output array, where the results are written
+ */
+void parallelInvSqrt_flt(void (*fn)(size_t, float *, float *), size_t n, float vals[n], float out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of n doubles with the kernel fn on all threads of the pool
+ *
+ * @details The arrays are split into cache-line-aligned chunks of POOL_GRAIN doubles, so the results are
+ * byte-identical to calling fn(n, vals, out) directly.
+ *
+ * @param fn Kernel used for every chunk, e.g. fastInvSqrt_dbl
+ * @param n Number of double values in the arrays
+ * @param vals Pointer to the input array with double values
+ * @param out Pointer to the double output array, where the results are written
+ */
+void parallelInvSqrt_dbl(void (*fn)(size_t, double *, double *), size_t n, double vals[n], double out[n]);
+
+/**
+ * @brief Calculate the reciprocal square root of n doubles with the mixed-type kernel fn writing floats on all threads of the pool
+ *
+ * @details The arrays are split into chunks of POOL_GRAIN values, which start at cache line boundaries of both
+ * arrays and match the chunks of pool_alloc for both types.
+ *
+ * @param fn Kernel used for every chunk, e.g. fastInvSqrt_dbl_flt
+ * @param n Number of values in the arrays
+ * @param vals Pointer to the input array with double values
+ * @param out Pointer to the float output array, where the results are written
+ */
+void parallelInvSqrt_dbl_flt(void (*fn)(size_t, const double *, float *), size_t n, const double *vals, float *out);
+
+/**
+ * @brief Calculate the reciprocal square root of n floats with the mixed-type kernel fn writing doubles on all threads
+ * of the pool, see parallelInvSqrt_dbl_flt
+ *
+ * @param fn Kernel used for every chunk, e.g. fastInvSqrt_flt_dbl
+ * @param n Number of values in the arrays
+ * @param vals Pointer to the input array with float values
+ * @param out Pointer to the double output array, where the results are written
+ */
+void parallelInvSqrt_flt_dbl(void (*fn)(size_t, const float *, double *), size_t n, const float *vals, double *out);
+
+#endif // IMPLEMENTIERUNG_THREADPOOL_H
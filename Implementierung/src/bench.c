@@ -0,0 +1,148 @@
+/** @file bench.c
+ *  @brief Implementation of the runtime benchmark engine
+ *  @details For details of each function see bench.h
+ *  @author Yll Kryeziu (ge94noh)
+ */
+
+#define _GNU_SOURCE // sched_getcpu, pthread_setaffinity_np
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <x86intrin.h>
+#include "../include/bench.h"
+
+// Call the kernel fn of type float/double
+static inline void call(int db, Func fn, size_t n, void *vals, void *out)
+{
+    if (db)
+    {
+        fn.fn_dbl(n, vals, out);
+    }
+    else
+    {
+        fn.fn_flt(n, vals, out);
+    }
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile p (in [0, 1]) of the sorted array of n values
+static double percentile(const double sorted[], size_t n, double p)
+{
+    return sorted[(size_t)(p * (n - 1) + 0.5)];
+}
+
+// Pin the calling thread to the current core, so the measurement is not disturbed by migrations.
+// Returns 1 if the old affinity mask was saved to old and has to be restored. Failures are ignored.
+static int pin(cpu_set_t *old)
+{
+    int pinned = !pthread_getaffinity_np(pthread_self(), sizeof *old, old);
+    int cpu = sched_getcpu();
+    if (pinned && cpu >= 0)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof set, &set);
+    }
+    return pinned;
+}
+
+void bench_run(int db, Func fn, size_t n, void *vals, void *out, struct BenchResult *res)
+{
+    double times[BENCH_REPS];
+    double cycles[BENCH_REPS];
+
+    cpu_set_t old;
+    int pinned = pin(&old);
+
+    for (int i = 0; i < BENCH_WARMUP; i++)
+    {
+        call(db, fn, n, vals, out);
+    }
+
+    int reps;
+    double total = 0.0;
+    for (reps = 0; reps < BENCH_REPS && (reps < BENCH_MIN_REPS || total < BENCH_MAX_TIME); reps++)
+    {
+        struct timespec start;
+        struct timespec stop;
+        unsigned aux;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        _mm_lfence(); // Earlier instructions complete before the counter is read
+        uint64_t begin = __rdtsc();
+        _mm_lfence();
+        call(db, fn, n, vals, out);
+        uint64_t end = __rdtscp(&aux); // rdtscp waits for the kernel to complete
+        _mm_lfence();
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+
+        times[reps] = stop.tv_sec - start.tv_sec + 1e-9 * (stop.tv_nsec - start.tv_nsec);
+        cycles[reps] = (double)(end - begin);
+        total += times[reps];
+    }
+
+    if (pinned)
+    {
+        pthread_setaffinity_np(pthread_self(), sizeof old, &old);
+    }
+
+    qsort(times, reps, sizeof *times, compare_double);
+    qsort(cycles, reps, sizeof *cycles, compare_double);
+    size_t bytes = 2 * n * (db ? sizeof(double) : sizeof(float)); // Every value is read once and written once
+    res->median = percentile(times, reps, 0.5);
+    res->p5 = percentile(times, reps, 0.05);
+    res->p95 = percentile(times, reps, 0.95);
+    res->p99 = percentile(times, reps, 0.99);
+    res->cyclesPerElement = n ? percentile(cycles, reps, 0.5) / n : 0.0;
+    res->gbps = res->median > 0.0 ? bytes / res->median * 1e-9 : 0.0;
+}
+
+double bench_latency(BenchChain chain, const void *arg, size_t n, void *buf)
+{
+    double cycles[BENCH_CHAIN_REPS];
+
+    cpu_set_t old;
+    int pinned = pin(&old);
+
+    chain(arg, n, buf, BENCH_CHAIN); // Warmup
+    for (int i = 0; i < BENCH_CHAIN_REPS; i++)
+    {
+        unsigned aux;
+        _mm_lfence();
+        uint64_t begin = __rdtsc();
+        _mm_lfence();
+        chain(arg, n, buf, BENCH_CHAIN);
+        uint64_t end = __rdtscp(&aux);
+        _mm_lfence();
+        cycles[i] = (double)(end - begin) / BENCH_CHAIN;
+    }
+
+    if (pinned)
+    {
+        pthread_setaffinity_np(pthread_self(), sizeof old, &old);
+    }
+
+    qsort(cycles, BENCH_CHAIN_REPS, sizeof *cycles, compare_double);
+    return percentile(cycles, BENCH_CHAIN_REPS, 0.5);
+}
+
+void bench_print_header(FILE *file)
+{
+    fprintf(file, "sampleSize, version, timeMedian, timeP5, timeP95, timeP99, cyclesPerElement, GBps\n");
+}
+
+void bench_print(FILE *file, size_t n, const char *name, const struct BenchResult *res)
+{
+    fprintf(file, "%zu, %s, %10.10f, %10.10f, %10.10f, %10.10f, %.4f, %.4f\n",
+            n, name, res->median, res->p5, res->p95, res->p99, res->cyclesPerElement, res->gbps);
+}
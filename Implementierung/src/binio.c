@@ -0,0 +1,129 @@
+/** @file binio.c
+ *  @brief Implementation of reading and writing raw float32/float64 files
+ *  @details For details of each function see binio.h
+ *  @author Ngoc Kim Ngan Nguyen (ge23fak)
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "../include/binio.h"
+#include "../include/numparse.h"
+
+// The values are used in place, so the host has to use the byte order of the file format
+_Static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "binary files are little-endian");
+_Static_assert(sizeof(struct BinHeader) == 16, "header has to keep the values 16-byte aligned");
+
+int bin_type(const char *path)
+{
+    struct BinHeader h;
+    FILE *file = fopen(path, "rb");
+    if (!file)
+    {
+        return -1;
+    }
+    int res = fread(&h, 1, sizeof h, file) == sizeof h && !memcmp(h.magic, BIN_MAGIC, 4) ? (h.type != 0) : -1;
+    fclose(file);
+    return res;
+}
+
+int bin_open(const char *path, struct BinFile *f, int positive)
+{
+    int fd;
+    if ((fd = open(path, O_RDONLY)) == -1)
+    {
+        perror("Error opening file");
+        return -1;
+    }
+
+    struct stat sb;
+    if (fstat(fd, &sb) == -1)
+    {
+        perror("Error retrieving file stats");
+        close(fd);
+        return -1;
+    }
+    if (!S_ISREG(sb.st_mode) || (size_t)sb.st_size < sizeof(struct BinHeader))
+    {
+        fprintf(stderr, "Error processing file: Not a regular file or invalid size \n");
+        close(fd);
+        return -1;
+    }
+
+    f->length = sb.st_size;
+    f->base = mmap(NULL, f->length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (f->base == MAP_FAILED)
+    {
+        perror("Error mapping file");
+        return -1;
+    }
+
+    // Validate the header, the file has to contain exactly count values of the given type
+    const struct BinHeader *h = f->base;
+    size_t size = 4 * h->type + 4; // size = 4 if type = 0 (float); size = 8 if type = 1 (double)
+    if (memcmp(h->magic, BIN_MAGIC, 4) || h->type > 1 || !h->count ||
+        h->count > (f->length - sizeof *h) / size || sizeof *h + h->count * size != f->length)
+    {
+        fprintf(stderr, "Error processing file: Invalid header of binary file\n");
+        munmap(f->base, f->length);
+        return -1;
+    }
+    f->db = h->type;
+    f->n = h->count;
+    f->data = (char *)f->base + sizeof *h;
+
+    size_t invalid = !positive ? f->n : !f->db ? first_nonpositive_flt(f->n, f->data) : first_nonpositive_dbl(f->n, f->data);
+    if (invalid < f->n)
+    { // Input is not a positive number
+        fprintf(stderr, "%.10g (value %zu) is not positive\n", !f->db ? ((float *)f->data)[invalid] : ((double *)f->data)[invalid], invalid + 1);
+        munmap(f->base, f->length);
+        return -1;
+    }
+    return 0;
+}
+
+int bin_create(const char *path, int db, size_t n, struct BinFile *f)
+{
+    int fd;
+    if ((fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644)) == -1)
+    {
+        perror("Error opening output file");
+        return -1;
+    }
+
+    size_t size = 4 * db + 4; // size = 4 if db = 0 (float); size = 8 if db = 1 (double)
+    f->length = sizeof(struct BinHeader) + n * size;
+    if (ftruncate(fd, f->length) == -1)
+    {
+        perror("Error resizing output file");
+        close(fd);
+        return -1;
+    }
+    f->base = mmap(NULL, f->length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (f->base == MAP_FAILED)
+    {
+        perror("Error mapping output file");
+        return -1;
+    }
+
+    struct BinHeader *h = f->base;
+    memcpy(h->magic, BIN_MAGIC, 4);
+    h->type = db;
+    h->count = n;
+    f->db = db;
+    f->n = n;
+    f->data = (char *)f->base + sizeof *h;
+    return 0;
+}
+
+void bin_close(struct BinFile *f)
+{
+    munmap(f->base, f->length);
+    f->base = NULL;
+}
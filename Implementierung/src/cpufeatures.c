@@ -0,0 +1,121 @@
+/** @file cpufeatures.c
+ *  @brief Implementation of the runtime detection of CPU features
+ *  @details For details of each function see cpufeatures.h
+ *  @author Yll Kryeziu (ge94noh)
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <cpuid.h>
+#include <unistd.h>
+#include "../include/cpufeatures.h"
+
+// Read the extended control register XCR0, which tells which register states the OS saves on context switches
+static uint64_t xgetbv0(void)
+{
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((uint64_t)edx << 32) | eax;
+}
+
+// Execute CPUID and translate the relevant bits into CpuFeature flags
+static int detect_features(void)
+{
+    unsigned int eax, ebx, ecx, edx;
+    int features = 0;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    {
+        return features;
+    }
+    if (edx & bit_SSE2)
+    {
+        features |= CPU_SSE2;
+    }
+
+    // Without OSXSAVE the OS does not save YMM/ZMM registers, so no AVX instruction may be used at all
+    if (!(ecx & bit_OSXSAVE))
+    {
+        return features;
+    }
+    uint64_t xcr0 = xgetbv0();
+    int ymm_enabled = (xcr0 & 0x6) == 0x6;     // XMM and YMM state
+    int zmm_enabled = (xcr0 & 0xE6) == 0xE6;   // additionally opmask and both halves of the ZMM state
+    int fma = (ecx & bit_FMA) != 0;
+    if (ymm_enabled && (ecx & bit_F16C))
+    {
+        features |= CPU_F16C;
+    }
+
+    if (__get_cpuid_max(0, NULL) < 7)
+    {
+        return features;
+    }
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+
+    if (ymm_enabled && (ebx & bit_AVX2))
+    {
+        features |= CPU_AVX2;
+    }
+    if (ymm_enabled && fma)
+    {
+        features |= CPU_FMA;
+    }
+    if (zmm_enabled && (ebx & bit_AVX512F))
+    {
+        features |= CPU_AVX512F;
+    }
+    return features;
+}
+
+int cpu_features(void)
+{
+    static int features = -1; // Cached result, -1 until CPUID was executed once
+
+    if (features < 0)
+    {
+        features = detect_features();
+    }
+    return features;
+}
+
+int cpu_supports(int required)
+{
+    return (cpu_features() & required) == required;
+}
+
+void cpu_feature_names(int features, char *buf, size_t size)
+{
+    const struct
+    {
+        int flag;
+        const char *name;
+    } names[] = {{CPU_SSE2, "SSE2"}, {CPU_AVX2, "AVX2"}, {CPU_FMA, "FMA"}, {CPU_AVX512F, "AVX-512F"}, {CPU_F16C, "F16C"}};
+
+    if (!size)
+    {
+        return;
+    }
+    buf[0] = '\0';
+    for (size_t i = 0; i < sizeof names / sizeof *names; i++)
+    {
+        if (features & names[i].flag)
+        {
+            size_t len = strlen(buf);
+            snprintf(buf + len, size - len, "%s%s", len ? " " : "", names[i].name);
+        }
+    }
+}
+
+size_t cpu_llc_size(void)
+{
+    static size_t size = 0;
+    if (!size)
+    {
+        long l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+        long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+        size = l3 > 0 ? (size_t)l3 : l2 > 0 ? (size_t)l2 : CPU_LLC_DEFAULT;
+    }
+    return size;
+}
@@ -6,9 +6,14 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 #include <math.h>
 #include <immintrin.h>
 #include "../include/inverse_sqrt.h"
+#include "../include/inverse_sqrt_inline.h"
+
+#define NT_LINE 64             // Cache line size, the non-temporal kernels write whole aligned lines
+#define PREFETCH_DISTANCE 4096 // Bytes the non-temporal kernels prefetch the input ahead
 
 void nativeSqrt_flt(size_t n, float vals[n], float out[n])
 {
@@ -220,4 +225,1411 @@ void fastInvSqrt_dbl(size_t n, double vals[n], double out[n])
         conv.x = conv.x * (1.5 - (xhalf * conv.x * conv.x));
         out[j] = conv.x;
     }
-}
\ No newline at end of file
+}
+
+__attribute__((target("avx2,fma"))) void fastInvSqrt_flt_AVX2(size_t n, float vals[n], float out[n])
+{
+    /* Use union instead of casting for type-punning
+    to avoid undefined behaviour, same principle as with SSE */
+    union
+    {
+        __m256 f; // 256 bit vector to store 8 32 bit single precision floating numbers
+        __m256i i;
+    } convAVX;
+
+    // reduce instructions in loop with these constants
+    const __m256 threehalfs = _mm256_set1_ps(1.5f);
+    const __m256i magicnumber = _mm256_set1_epi32(0x5F375A86);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    size_t j;
+
+    /* Read 256 bits from starting adress and load into vector,
+    but only if number of remainting elements >= 8 */
+    for (j = 0; j < (n & ~7ul); j += 8)
+    {
+        convAVX.f = _mm256_loadu_ps(&vals[j]);
+        __m256 xhalf = _mm256_mul_ps(convAVX.f, half);
+
+        convAVX.i = _mm256_sub_epi32(magicnumber, _mm256_srli_epi32(convAVX.i, 1)); // Use magicnumber from Lomont and integer representation to get approximate result
+
+        // Single Newton iteration, threehalfs - xhalf * y * y is computed with one fused negative multiply-add
+        convAVX.f = _mm256_mul_ps(convAVX.f, _mm256_fnmadd_ps(xhalf, _mm256_mul_ps(convAVX.f, convAVX.f), threehalfs));
+        _mm256_storeu_ps(&out[j], convAVX.f);
+    }
+
+    union
+    {
+        float x;
+        uint32_t u;
+    } conv;
+    // Deal with the rest of the elements with scalar operations
+    for (; j < n; j++)
+    {
+        conv.x = vals[j];
+        float xhalf = conv.x * 0.5f;
+        conv.u = 0x5F375A86 - (conv.u >> 1);
+        conv.x = conv.x * (1.5f - (xhalf * conv.x * conv.x));
+        out[j] = conv.x;
+    }
+}
+
+__attribute__((target("avx2,fma"))) void fastInvSqrt_flt_AVX2_DoubleNewton(size_t n, float vals[n], float out[n])
+{
+    union
+    {
+        __m256 f;
+        __m256i i;
+    } convAVX;
+
+    const __m256 threehalfs = _mm256_set1_ps(1.5f);
+    const __m256i magicnumber = _mm256_set1_epi32(0x5F375A86);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    size_t j;
+
+    for (j = 0; j < (n & ~7ul); j += 8)
+    {
+        convAVX.f = _mm256_loadu_ps(&vals[j]);
+        __m256 xhalf = _mm256_mul_ps(convAVX.f, half);
+
+        convAVX.i = _mm256_sub_epi32(magicnumber, _mm256_srli_epi32(convAVX.i, 1));
+
+        convAVX.f = _mm256_mul_ps(convAVX.f, _mm256_fnmadd_ps(xhalf, _mm256_mul_ps(convAVX.f, convAVX.f), threehalfs));
+        convAVX.f = _mm256_mul_ps(convAVX.f, _mm256_fnmadd_ps(xhalf, _mm256_mul_ps(convAVX.f, convAVX.f), threehalfs)); // Use 2nd Newton iteration to further improve accuracy of result
+        _mm256_storeu_ps(&out[j], convAVX.f);
+    }
+
+    union
+    {
+        float x;
+        uint32_t u;
+    } conv;
+    // Deal with the rest of the elements with scalar operations
+    for (; j < n; j++)
+    {
+        conv.x = vals[j];
+        float xhalf = conv.x * 0.5f;
+        conv.u = 0x5F375A86 - (conv.u >> 1);
+        conv.x = conv.x * (1.5f - (xhalf * conv.x * conv.x));
+        conv.x = conv.x * (1.5f - (xhalf * conv.x * conv.x));
+        out[j] = conv.x;
+    }
+}
+
+__attribute__((target("avx2,fma"))) void fastInvSqrt_dbl_AVX2(size_t n, double vals[n], double out[n])
+{
+    union
+    {
+        __m256d d; // 256 bit d-Vector to store 4 64 bit double precision floating numbers
+        __m256i i;
+    } convAVX;
+
+    const __m256d threehalfs = _mm256_set1_pd(1.5);
+    const __m256i magicnumber = _mm256_set1_epi64x(0x5FE6EB50C7B537A9);
+    const __m256d half = _mm256_set1_pd(0.5);
+    size_t j;
+
+    /* Read 256 bits from starting adress and load into vector,
+    but only if number of remainting elements >= 4 */
+    for (j = 0; j < (n & ~3ul); j += 4)
+    {
+        convAVX.d = _mm256_loadu_pd(&vals[j]);
+        __m256d xhalf = _mm256_mul_pd(convAVX.d, half);
+
+        convAVX.i = _mm256_sub_epi64(magicnumber, _mm256_srli_epi64(convAVX.i, 1)); // Use magicnumber from Robertson and integer representation to get approximate result
+
+        convAVX.d = _mm256_mul_pd(convAVX.d, _mm256_fnmadd_pd(xhalf, _mm256_mul_pd(convAVX.d, convAVX.d), threehalfs)); // Use single Newton iteration to improve accuracy of result
+        _mm256_storeu_pd(&out[j], convAVX.d);
+    }
+
+    union
+    {
+        double x;
+        uint64_t u;
+    } conv;
+    // Deal with the rest of the elements with scalar operations
+    for (; j < n; j++)
+    {
+        conv.x = vals[j];
+        double xhalf = conv.x * 0.5;
+        conv.u = 0x5FE6EB50C7B537A9 - (conv.u >> 1);
+        conv.x = conv.x * (1.5 - (xhalf * conv.x * conv.x));
+        out[j] = conv.x;
+    }
+}
+
+__attribute__((target("avx2,fma"))) void fastInvSqrt_dbl_AVX2_DoubleNewton(size_t n, double vals[n], double out[n])
+{
+    union
+    {
+        __m256d d;
+        __m256i i;
+    } convAVX;
+
+    const __m256d threehalfs = _mm256_set1_pd(1.5);
+    const __m256i magicnumber = _mm256_set1_epi64x(0x5FE6EB50C7B537A9);
+    const __m256d half = _mm256_set1_pd(0.5);
+    size_t j;
+
+    for (j = 0; j < (n & ~3ul); j += 4)
+    {
+        convAVX.d = _mm256_loadu_pd(&vals[j]);
+        __m256d xhalf = _mm256_mul_pd(convAVX.d, half);
+
+        convAVX.i = _mm256_sub_epi64(magicnumber, _mm256_srli_epi64(convAVX.i, 1));
+
+        convAVX.d = _mm256_mul_pd(convAVX.d, _mm256_fnmadd_pd(xhalf, _mm256_mul_pd(convAVX.d, convAVX.d), threehalfs));
+        convAVX.d = _mm256_mul_pd(convAVX.d, _mm256_fnmadd_pd(xhalf, _mm256_mul_pd(convAVX.d, convAVX.d), threehalfs)); // Use 2nd Newton iteration to further improve accuracy of result
+        _mm256_storeu_pd(&out[j], convAVX.d);
+    }
+
+    union
+    {
+        double x;
+        uint64_t u;
+    } conv;
+    // Deal with the rest of the elements with scalar operations
+    for (; j < n; j++)
+    {
+        conv.x = vals[j];
+        double xhalf = conv.x * 0.5;
+        conv.u = 0x5FE6EB50C7B537A9 - (conv.u >> 1);
+        conv.x = conv.x * (1.5 - (xhalf * conv.x * conv.x));
+        conv.x = conv.x * (1.5 - (xhalf * conv.x * conv.x));
+        out[j] = conv.x;
+    }
+}
+
+__attribute__((target("avx512f"))) void fastInvSqrt_flt_AVX512(size_t n, float vals[n], float out[n])
+{
+    /* Use union instead of casting for type-punning
+    to avoid undefined behaviour, same principle as with SSE */
+    union
+    {
+        __m512 f; // 512 bit vector to store 16 32 bit single precision floating numbers
+        __m512i i;
+    } convAVX;
+
+    // reduce instructions in loop with these constants
+    const __m512 threehalfs = _mm512_set1_ps(1.5f);
+    const __m512i magicnumber = _mm512_set1_epi32(0x5F375A86);
+    const __m512 half = _mm512_set1_ps(0.5f);
+    __mmask16 mask = 0xFFFF;
+
+    /* Read 512 bits per iteration. For the last iteration only the remaining elements are
+    enabled in the mask, masked-out lanes are neither loaded nor stored, so no scalar loop is needed */
+    for (size_t j = 0; j < n; j += 16)
+    {
+        if (n - j < 16)
+        {
+            mask = (__mmask16)((1u << (n - j)) - 1);
+        }
+        convAVX.f = _mm512_maskz_loadu_ps(mask, &vals[j]);
+        __m512 xhalf = _mm512_mul_ps(convAVX.f, half);
+
+        convAVX.i = _mm512_sub_epi32(magicnumber, _mm512_srli_epi32(convAVX.i, 1)); // Use magicnumber from Lomont and integer representation to get approximate result
+
+        convAVX.f = _mm512_mul_ps(convAVX.f, _mm512_fnmadd_ps(xhalf, _mm512_mul_ps(convAVX.f, convAVX.f), threehalfs)); // Use single Newton iteration to improve accuracy of result
+        _mm512_mask_storeu_ps(&out[j], mask, convAVX.f);
+    }
+}
+
+__attribute__((target("avx512f"))) void fastInvSqrt_flt_AVX512_DoubleNewton(size_t n, float vals[n], float out[n])
+{
+    union
+    {
+        __m512 f;
+        __m512i i;
+    } convAVX;
+
+    const __m512 threehalfs = _mm512_set1_ps(1.5f);
+    const __m512i magicnumber = _mm512_set1_epi32(0x5F375A86);
+    const __m512 half = _mm512_set1_ps(0.5f);
+    __mmask16 mask = 0xFFFF;
+
+    for (size_t j = 0; j < n; j += 16)
+    {
+        if (n - j < 16)
+        {
+            mask = (__mmask16)((1u << (n - j)) - 1);
+        }
+        convAVX.f = _mm512_maskz_loadu_ps(mask, &vals[j]);
+        __m512 xhalf = _mm512_mul_ps(convAVX.f, half);
+
+        convAVX.i = _mm512_sub_epi32(magicnumber, _mm512_srli_epi32(convAVX.i, 1));
+
+        convAVX.f = _mm512_mul_ps(convAVX.f, _mm512_fnmadd_ps(xhalf, _mm512_mul_ps(convAVX.f, convAVX.f), threehalfs));
+        convAVX.f = _mm512_mul_ps(convAVX.f, _mm512_fnmadd_ps(xhalf, _mm512_mul_ps(convAVX.f, convAVX.f), threehalfs)); // Use 2nd Newton iteration to further improve accuracy of result
+        _mm512_mask_storeu_ps(&out[j], mask, convAVX.f);
+    }
+}
+
+__attribute__((target("avx512f"))) void fastInvSqrt_dbl_AVX512(size_t n, double vals[n], double out[n])
+{
+    union
+    {
+        __m512d d; // 512 bit d-Vector to store 8 64 bit double precision floating numbers
+        __m512i i;
+    } convAVX;
+
+    const __m512d threehalfs = _mm512_set1_pd(1.5);
+    const __m512i magicnumber = _mm512_set1_epi64(0x5FE6EB50C7B537A9);
+    const __m512d half = _mm512_set1_pd(0.5);
+    __mmask8 mask = 0xFF;
+
+    // Same masking principle as for floats, but with 8 doubles per vector
+    for (size_t j = 0; j < n; j += 8)
+    {
+        if (n - j < 8)
+        {
+            mask = (__mmask8)((1u << (n - j)) - 1);
+        }
+        convAVX.d = _mm512_maskz_loadu_pd(mask, &vals[j]);
+        __m512d xhalf = _mm512_mul_pd(convAVX.d, half);
+
+        convAVX.i = _mm512_sub_epi64(magicnumber, _mm512_srli_epi64(convAVX.i, 1)); // Use magicnumber from Robertson and integer representation to get approximate result
+
+        convAVX.d = _mm512_mul_pd(convAVX.d, _mm512_fnmadd_pd(xhalf, _mm512_mul_pd(convAVX.d, convAVX.d), threehalfs)); // Use single Newton iteration to improve accuracy of result
+        _mm512_mask_storeu_pd(&out[j], mask, convAVX.d);
+    }
+}
+
+__attribute__((target("avx512f"))) void fastInvSqrt_dbl_AVX512_DoubleNewton(size_t n, double vals[n], double out[n])
+{
+    union
+    {
+        __m512d d;
+        __m512i i;
+    } convAVX;
+
+    const __m512d threehalfs = _mm512_set1_pd(1.5);
+    const __m512i magicnumber = _mm512_set1_epi64(0x5FE6EB50C7B537A9);
+    const __m512d half = _mm512_set1_pd(0.5);
+    __mmask8 mask = 0xFF;
+
+    for (size_t j = 0; j < n; j += 8)
+    {
+        if (n - j < 8)
+        {
+            mask = (__mmask8)((1u << (n - j)) - 1);
+        }
+        convAVX.d = _mm512_maskz_loadu_pd(mask, &vals[j]);
+        __m512d xhalf = _mm512_mul_pd(convAVX.d, half);
+
+        convAVX.i = _mm512_sub_epi64(magicnumber, _mm512_srli_epi64(convAVX.i, 1));
+
+        convAVX.d = _mm512_mul_pd(convAVX.d, _mm512_fnmadd_pd(xhalf, _mm512_mul_pd(convAVX.d, convAVX.d), threehalfs));
+        convAVX.d = _mm512_mul_pd(convAVX.d, _mm512_fnmadd_pd(xhalf, _mm512_mul_pd(convAVX.d, convAVX.d), threehalfs)); // Use 2nd Newton iteration to further improve accuracy of result
+        _mm512_mask_storeu_pd(&out[j], mask, convAVX.d);
+    }
+}
+
+void fastInvSqrt_flt_Tuned(size_t n, float vals[n], float out[n])
+{
+    union
+    {
+        __m128 f;
+        __m128i i;
+    } convSSE;
+
+    // Same operations as fastInvSqrt_flt, x * k2 replaces x * 0.5
+    const __m128 k1 = _mm_set1_ps(TUNED_K1_FLT);
+    const __m128 k2 = _mm_set1_ps(TUNED_K2_FLT);
+    const __m128i magicnumber = _mm_set1_epi32(TUNED_MAGIC_FLT);
+    size_t j;
+
+    for (j = 0; j < (n & ~3ul); j += 4)
+    {
+        convSSE.f = _mm_loadu_ps(&vals[j]);
+        __m128 kx = _mm_mul_ps(convSSE.f, k2);
+
+        convSSE.i = _mm_sub_epi32(magicnumber, _mm_srli_epi32(convSSE.i, 1));
+
+        convSSE.f = _mm_mul_ps(convSSE.f, _mm_sub_ps(k1, _mm_mul_ps(kx, _mm_mul_ps(convSSE.f, convSSE.f)))); // Tuned Newton iteration
+        _mm_storeu_ps(&out[j], convSSE.f);
+    }
+
+    union
+    {
+        float x;
+        uint32_t u;
+    } conv;
+    // Deal with the rest of the elements with scalar operations
+    for (; j < n; j++)
+    {
+        conv.x = vals[j];
+        float kx = conv.x * TUNED_K2_FLT;
+        conv.u = TUNED_MAGIC_FLT - (conv.u >> 1);
+        conv.x = conv.x * (TUNED_K1_FLT - kx * (conv.x * conv.x));
+        out[j] = conv.x;
+    }
+}
+
+void fastInvSqrt_flt_Tuned_DoubleNewton(size_t n, float vals[n], float out[n])
+{
+    union
+    {
+        __m128 f;
+        __m128i i;
+    } convSSE;
+
+    const __m128 k1 = _mm_set1_ps(TUNED_K1_FLT);
+    const __m128 k2 = _mm_set1_ps(TUNED_K2_FLT);
+    const __m128 k3 = _mm_set1_ps(TUNED_K3_FLT);
+    const __m128 k4 = _mm_set1_ps(TUNED_K4_FLT);
+    const __m128i magicnumber = _mm_set1_epi32(TUNED_MAGIC_FLT);
+    size_t j;
+
+    for (j = 0; j < (n & ~3ul); j += 4)
+    {
+        __m128 x = _mm_loadu_ps(&vals[j]);
+        convSSE.f = x;
+
+        convSSE.i = _mm_sub_epi32(magicnumber, _mm_srli_epi32(convSSE.i, 1));
+
+        // Two tuned Newton iterations with their own coefficients
+        convSSE.f = _mm_mul_ps(convSSE.f, _mm_sub_ps(k1, _mm_mul_ps(_mm_mul_ps(x, k2), _mm_mul_ps(convSSE.f, convSSE.f))));
+        convSSE.f = _mm_mul_ps(convSSE.f, _mm_sub_ps(k3, _mm_mul_ps(_mm_mul_ps(x, k4), _mm_mul_ps(convSSE.f, convSSE.f))));
+        _mm_storeu_ps(&out[j], convSSE.f);
+    }
+
+    union
+    {
+        float x;
+        uint32_t u;
+    } conv;
+    // Deal with the rest of the elements with scalar operations
+    for (; j < n; j++)
+    {
+        float x = vals[j];
+        conv.x = x;
+        conv.u = TUNED_MAGIC_FLT - (conv.u >> 1);
+        conv.x = conv.x * (TUNED_K1_FLT - (x * TUNED_K2_FLT) * (conv.x * conv.x));
+        conv.x = conv.x * (TUNED_K3_FLT - (x * TUNED_K4_FLT) * (conv.x * conv.x));
+        out[j] = conv.x;
+    }
+}
+
+void fastInvSqrt_dbl_Tuned(size_t n, double vals[n], double out[n])
+{
+    union
+    {
+        __m128d d;
+        __m128i i;
+    } convSSE;
+
+    // Same operations as fastInvSqrt_dbl, x * k2 replaces x * 0.5
+    const __m128d k1 = _mm_set1_pd(TUNED_K1_DBL);
+    const __m128d k2 = _mm_set1_pd(TUNED_K2_DBL);
+    const __m128i magicnumber = _mm_set1_epi64x(TUNED_MAGIC_DBL);
+    size_t j;
+
+    for (j = 0; j < (n & ~1ul); j += 2)
+    {
+        convSSE.d = _mm_loadu_pd(&vals[j]);
+        __m128d kx = _mm_mul_pd(convSSE.d, k2);
+
+        convSSE.i = _mm_sub_epi64(magicnumber, _mm_srli_epi64(convSSE.i, 1));
+
+        convSSE.d = _mm_mul_pd(convSSE.d, _mm_sub_pd(k1, _mm_mul_pd(kx, _mm_mul_pd(convSSE.d, convSSE.d)))); // Tuned Newton iteration
+        _mm_storeu_pd(&out[j], convSSE.d);
+    }
+
+    union
+    {
+        double x;
+        uint64_t u;
+    } conv;
+    // Deal with the rest of the elements with scalar operations
+    for (; j < n; j++)
+    {
+        conv.x = vals[j];
+        double kx = conv.x * TUNED_K2_DBL;
+        conv.u = TUNED_MAGIC_DBL - (conv.u >> 1);
+        conv.x = conv.x * (TUNED_K1_DBL - kx * (conv.x * conv.x));
+        out[j] = conv.x;
+    }
+}
+
+void fastInvSqrt_dbl_Tuned_DoubleNewton(size_t n, double vals[n], double out[n])
+{
+    union
+    {
+        __m128d d;
+        __m128i i;
+    } convSSE;
+
+    const __m128d k1 = _mm_set1_pd(TUNED_K1_DBL);
+    const __m128d k2 = _mm_set1_pd(TUNED_K2_DBL);
+    const __m128d k3 = _mm_set1_pd(TUNED_K3_DBL);
+    const __m128d k4 = _mm_set1_pd(TUNED_K4_DBL);
+    const __m128i magicnumber = _mm_set1_epi64x(TUNED_MAGIC_DBL);
+    size_t j;
+
+    for (j = 0; j < (n & ~1ul); j += 2)
+    {
+        __m128d x = _mm_loadu_pd(&vals[j]);
+        convSSE.d = x;
+
+        convSSE.i = _mm_sub_epi64(magicnumber, _mm_srli_epi64(convSSE.i, 1));
+
+        // Two tuned Newton iterations with their own coefficients
+        convSSE.d = _mm_mul_pd(convSSE.d, _mm_sub_pd(k1, _mm_mul_pd(_mm_mul_pd(x, k2), _mm_mul_pd(convSSE.d, convSSE.d))));
+        convSSE.d = _mm_mul_pd(convSSE.d, _mm_sub_pd(k3, _mm_mul_pd(_mm_mul_pd(x, k4), _mm_mul_pd(convSSE.d, convSSE.d))));
+        _mm_storeu_pd(&out[j], convSSE.d);
+    }
+
+    union
+    {
+        double x;
+        uint64_t u;
+    } conv;
+    // Deal with the rest of the elements with scalar operations
+    for (; j < n; j++)
+    {
+        double x = vals[j];
+        conv.x = x;
+        conv.u = TUNED_MAGIC_DBL - (conv.u >> 1);
+        conv.x = conv.x * (TUNED_K1_DBL - (x * TUNED_K2_DBL) * (conv.x * conv.x));
+        conv.x = conv.x * (TUNED_K3_DBL - (x * TUNED_K4_DBL) * (conv.x * conv.x));
+        out[j] = conv.x;
+    }
+}
+
+/* One SIMD step of the AVX2 and AVX-512 kernels with exactly the same operations,
+the SSE steps are fastInvSqrt4_flt and fastInvSqrt2_dbl from inverse_sqrt_inline.h */
+__attribute__((target("avx2,fma"))) static inline __m256 invSqrt256_ps(__m256 x)
+{
+    __m256 xhalf = _mm256_mul_ps(x, _mm256_set1_ps(0.5f));
+    __m256 y = _mm256_castsi256_ps(_mm256_sub_epi32(_mm256_set1_epi32(0x5F375A86), _mm256_srli_epi32(_mm256_castps_si256(x), 1)));
+    return _mm256_mul_ps(y, _mm256_fnmadd_ps(xhalf, _mm256_mul_ps(y, y), _mm256_set1_ps(1.5f)));
+}
+
+__attribute__((target("avx512f"))) static inline __m512 invSqrt512_ps(__m512 x)
+{
+    __m512 xhalf = _mm512_mul_ps(x, _mm512_set1_ps(0.5f));
+    __m512 y = _mm512_castsi512_ps(_mm512_sub_epi32(_mm512_set1_epi32(0x5F375A86), _mm512_srli_epi32(_mm512_castps_si512(x), 1)));
+    return _mm512_mul_ps(y, _mm512_fnmadd_ps(xhalf, _mm512_mul_ps(y, y), _mm512_set1_ps(1.5f)));
+}
+
+__attribute__((target("avx2,fma"))) static inline __m256d invSqrt256_pd(__m256d x)
+{
+    __m256d xhalf = _mm256_mul_pd(x, _mm256_set1_pd(0.5));
+    __m256d y = _mm256_castsi256_pd(_mm256_sub_epi64(_mm256_set1_epi64x(0x5FE6EB50C7B537A9), _mm256_srli_epi64(_mm256_castpd_si256(x), 1)));
+    return _mm256_mul_pd(y, _mm256_fnmadd_pd(xhalf, _mm256_mul_pd(y, y), _mm256_set1_pd(1.5)));
+}
+
+__attribute__((target("avx512f"))) static inline __m512d invSqrt512_pd(__m512d x)
+{
+    __m512d xhalf = _mm512_mul_pd(x, _mm512_set1_pd(0.5));
+    __m512d y = _mm512_castsi512_pd(_mm512_sub_epi64(_mm512_set1_epi64(0x5FE6EB50C7B537A9), _mm512_srli_epi64(_mm512_castpd_si512(x), 1)));
+    return _mm512_mul_pd(y, _mm512_fnmadd_pd(xhalf, _mm512_mul_pd(y, y), _mm512_set1_pd(1.5)));
+}
+
+// Number of elements of size elem before the first cache line aligned address of out, at most n
+static inline size_t head_elements(const void *out, size_t elem, size_t n)
+{
+    size_t head = (NT_LINE - (uintptr_t)out % NT_LINE) % NT_LINE / elem;
+    return head < n ? head : n;
+}
+
+/* The non-temporal kernels process whole cache lines of output: one prefetch per line of input and
+streaming stores, which write the line to memory without reading it into the cache first.
+The elements before the first aligned line and after the last full line are passed to the regular kernel,
+so for a cache line aligned output array the results are bit-identical to it (otherwise elements may move
+between the SIMD and the scalar path of the regular kernel and differ in the last bit). fastInvSqrt_flt/dbl
+store with _mm_store_ps/pd, so the SSE variants use fastInvSqrtSmall_flt/dbl with the same operations instead,
+which accept any alignment of out. Streaming stores are weakly ordered,
+the sfence makes them visible before the function returns. */
+void fastInvSqrt_flt_NT(size_t n, float vals[n], float out[n])
+{
+    size_t j = head_elements(out, sizeof(float), n);
+    fastInvSqrtSmall_flt(j, vals, out);
+    for (; j + NT_LINE / sizeof(float) <= n; j += NT_LINE / sizeof(float))
+    {
+        _mm_prefetch((const char *)&vals[j] + PREFETCH_DISTANCE, _MM_HINT_T0);
+        for (size_t k = 0; k < NT_LINE / sizeof(float); k += 4)
+        {
+            _mm_stream_ps(&out[j + k], fastInvSqrt4_flt(_mm_loadu_ps(&vals[j + k])));
+        }
+    }
+    _mm_sfence();
+    fastInvSqrtSmall_flt(n - j, &vals[j], &out[j]);
+}
+
+__attribute__((target("avx2,fma"))) void fastInvSqrt_flt_AVX2_NT(size_t n, float vals[n], float out[n])
+{
+    size_t j = head_elements(out, sizeof(float), n);
+    fastInvSqrt_flt_AVX2(j, vals, out);
+    for (; j + NT_LINE / sizeof(float) <= n; j += NT_LINE / sizeof(float))
+    {
+        _mm_prefetch((const char *)&vals[j] + PREFETCH_DISTANCE, _MM_HINT_T0);
+        for (size_t k = 0; k < NT_LINE / sizeof(float); k += 8)
+        {
+            _mm256_stream_ps(&out[j + k], invSqrt256_ps(_mm256_loadu_ps(&vals[j + k])));
+        }
+    }
+    _mm_sfence();
+    fastInvSqrt_flt_AVX2(n - j, &vals[j], &out[j]);
+}
+
+__attribute__((target("avx512f"))) void fastInvSqrt_flt_AVX512_NT(size_t n, float vals[n], float out[n])
+{
+    size_t j = head_elements(out, sizeof(float), n);
+    fastInvSqrt_flt_AVX512(j, vals, out);
+    for (; j + NT_LINE / sizeof(float) <= n; j += NT_LINE / sizeof(float))
+    {
+        _mm_prefetch((const char *)&vals[j] + PREFETCH_DISTANCE, _MM_HINT_T0);
+        _mm512_stream_ps(&out[j], invSqrt512_ps(_mm512_loadu_ps(&vals[j])));
+    }
+    _mm_sfence();
+    fastInvSqrt_flt_AVX512(n - j, &vals[j], &out[j]);
+}
+
+void fastInvSqrt_dbl_NT(size_t n, double vals[n], double out[n])
+{
+    size_t j = head_elements(out, sizeof(double), n);
+    fastInvSqrtSmall_dbl(j, vals, out);
+    for (; j + NT_LINE / sizeof(double) <= n; j += NT_LINE / sizeof(double))
+    {
+        _mm_prefetch((const char *)&vals[j] + PREFETCH_DISTANCE, _MM_HINT_T0);
+        for (size_t k = 0; k < NT_LINE / sizeof(double); k += 2)
+        {
+            _mm_stream_pd(&out[j + k], fastInvSqrt2_dbl(_mm_loadu_pd(&vals[j + k])));
+        }
+    }
+    _mm_sfence();
+    fastInvSqrtSmall_dbl(n - j, &vals[j], &out[j]);
+}
+
+__attribute__((target("avx2,fma"))) void fastInvSqrt_dbl_AVX2_NT(size_t n, double vals[n], double out[n])
+{
+    size_t j = head_elements(out, sizeof(double), n);
+    fastInvSqrt_dbl_AVX2(j, vals, out);
+    for (; j + NT_LINE / sizeof(double) <= n; j += NT_LINE / sizeof(double))
+    {
+        _mm_prefetch((const char *)&vals[j] + PREFETCH_DISTANCE, _MM_HINT_T0);
+        for (size_t k = 0; k < NT_LINE / sizeof(double); k += 4)
+        {
+            _mm256_stream_pd(&out[j + k], invSqrt256_pd(_mm256_loadu_pd(&vals[j + k])));
+        }
+    }
+    _mm_sfence();
+    fastInvSqrt_dbl_AVX2(n - j, &vals[j], &out[j]);
+}
+
+__attribute__((target("avx512f"))) void fastInvSqrt_dbl_AVX512_NT(size_t n, double vals[n], double out[n])
+{
+    size_t j = head_elements(out, sizeof(double), n);
+    fastInvSqrt_dbl_AVX512(j, vals, out);
+    for (; j + NT_LINE / sizeof(double) <= n; j += NT_LINE / sizeof(double))
+    {
+        _mm_prefetch((const char *)&vals[j] + PREFETCH_DISTANCE, _MM_HINT_T0);
+        _mm512_stream_pd(&out[j], invSqrt512_pd(_mm512_loadu_pd(&vals[j])));
+    }
+    _mm_sfence();
+    fastInvSqrt_dbl_AVX512(n - j, &vals[j], &out[j]);
+}
+
+/* The fused kernels apply the SIMD steps of fastInvSqrt_flt/_dbl and their AVX2 versions and multiply the
+result before it is stored, the scalar rest uses the scalar step of the regular kernels */
+void mulInvSqrt_flt(size_t n, const float *a, const float *b, float *out)
+{
+    size_t j;
+    for (j = 0; j + 4 <= n; j += 4)
+    {
+        _mm_storeu_ps(&out[j], _mm_mul_ps(_mm_loadu_ps(&a[j]), fastInvSqrt4_flt(_mm_loadu_ps(&b[j]))));
+    }
+    for (; j < n; j++)
+    {
+        out[j] = a[j] * fastInvSqrt1_flt(b[j]);
+    }
+}
+
+__attribute__((target("avx2,fma"))) void mulInvSqrt_flt_AVX2(size_t n, const float *a, const float *b, float *out)
+{
+    size_t j;
+    for (j = 0; j + 8 <= n; j += 8)
+    {
+        _mm256_storeu_ps(&out[j], _mm256_mul_ps(_mm256_loadu_ps(&a[j]), invSqrt256_ps(_mm256_loadu_ps(&b[j]))));
+    }
+    for (; j < n; j++)
+    {
+        out[j] = a[j] * fastInvSqrt1_flt(b[j]);
+    }
+}
+
+void fastSqrt_flt(size_t n, const float *x, float *out)
+{
+    size_t j;
+    for (j = 0; j + 4 <= n; j += 4)
+    {
+        __m128 v = _mm_loadu_ps(&x[j]);
+        _mm_storeu_ps(&out[j], _mm_mul_ps(v, fastInvSqrt4_flt(v)));
+    }
+    for (; j < n; j++)
+    {
+        out[j] = x[j] * fastInvSqrt1_flt(x[j]);
+    }
+}
+
+__attribute__((target("avx2,fma"))) void fastSqrt_flt_AVX2(size_t n, const float *x, float *out)
+{
+    size_t j;
+    for (j = 0; j + 8 <= n; j += 8)
+    {
+        __m256 v = _mm256_loadu_ps(&x[j]);
+        _mm256_storeu_ps(&out[j], _mm256_mul_ps(v, invSqrt256_ps(v)));
+    }
+    for (; j < n; j++)
+    {
+        out[j] = x[j] * fastInvSqrt1_flt(x[j]);
+    }
+}
+
+void mulInvSqrt_dbl(size_t n, const double *a, const double *b, double *out)
+{
+    size_t j;
+    for (j = 0; j + 2 <= n; j += 2)
+    {
+        _mm_storeu_pd(&out[j], _mm_mul_pd(_mm_loadu_pd(&a[j]), fastInvSqrt2_dbl(_mm_loadu_pd(&b[j]))));
+    }
+    if (j < n)
+    {
+        out[j] = a[j] * fastInvSqrt1_dbl(b[j]);
+    }
+}
+
+__attribute__((target("avx2,fma"))) void mulInvSqrt_dbl_AVX2(size_t n, const double *a, const double *b, double *out)
+{
+    size_t j;
+    for (j = 0; j + 4 <= n; j += 4)
+    {
+        _mm256_storeu_pd(&out[j], _mm256_mul_pd(_mm256_loadu_pd(&a[j]), invSqrt256_pd(_mm256_loadu_pd(&b[j]))));
+    }
+    for (; j < n; j++)
+    {
+        out[j] = a[j] * fastInvSqrt1_dbl(b[j]);
+    }
+}
+
+void fastSqrt_dbl(size_t n, const double *x, double *out)
+{
+    size_t j;
+    for (j = 0; j + 2 <= n; j += 2)
+    {
+        __m128d v = _mm_loadu_pd(&x[j]);
+        _mm_storeu_pd(&out[j], _mm_mul_pd(v, fastInvSqrt2_dbl(v)));
+    }
+    if (j < n)
+    {
+        out[j] = x[j] * fastInvSqrt1_dbl(x[j]);
+    }
+}
+
+__attribute__((target("avx2,fma"))) void fastSqrt_dbl_AVX2(size_t n, const double *x, double *out)
+{
+    size_t j;
+    for (j = 0; j + 4 <= n; j += 4)
+    {
+        __m256d v = _mm256_loadu_pd(&x[j]);
+        _mm256_storeu_pd(&out[j], _mm256_mul_pd(v, invSqrt256_pd(v)));
+    }
+    for (; j < n; j++)
+    {
+        out[j] = x[j] * fastInvSqrt1_dbl(x[j]);
+    }
+}
+
+/* Hardware seeded versions: the estimate of rsqrtps (relative error <= 1.5 * 2^-12) or vrsqrt14 (<= 2^-14)
+replaces the MagicNumber and is refined with steps Newton iterations, steps is a constant after inlining.
+The rest of the elements goes through the same vector operations with one element (SSE) or a mask (AVX-512),
+so the result of an element does not depend on its position. */
+static inline __m128 rsqrt_ps(__m128 x, int steps)
+{
+    __m128 y = _mm_rsqrt_ps(x);
+    __m128 xhalf = _mm_mul_ps(x, _mm_set1_ps(0.5f));
+    for (int i = 0; i < steps; i++)
+    {
+        y = _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(xhalf, _mm_mul_ps(y, y))));
+    }
+    return y;
+}
+
+static inline void rsqrt_flt(size_t n, const float *vals, float *out, int steps)
+{
+    size_t j;
+    for (j = 0; j + 4 <= n; j += 4)
+    {
+        _mm_storeu_ps(&out[j], rsqrt_ps(_mm_loadu_ps(&vals[j]), steps));
+    }
+    for (; j < n; j++)
+    {
+        out[j] = _mm_cvtss_f32(rsqrt_ps(_mm_set1_ps(vals[j]), steps));
+    }
+}
+
+__attribute__((target("avx512f"))) static inline __m512 rsqrt14_ps(__m512 x, int steps)
+{
+    __m512 y = _mm512_rsqrt14_ps(x);
+    __m512 xhalf = _mm512_mul_ps(x, _mm512_set1_ps(0.5f));
+    for (int i = 0; i < steps; i++)
+    {
+        y = _mm512_mul_ps(y, _mm512_fnmadd_ps(xhalf, _mm512_mul_ps(y, y), _mm512_set1_ps(1.5f)));
+    }
+    return y;
+}
+
+__attribute__((target("avx512f"))) static inline void rsqrt14_flt(size_t n, const float *vals, float *out, int steps)
+{
+    __mmask16 mask = 0xFFFF;
+    for (size_t j = 0; j < n; j += 16)
+    {
+        if (n - j < 16)
+        {
+            mask = (__mmask16)((1u << (n - j)) - 1);
+        }
+        // Masked-out lanes are set to 1, so that no infinities are computed in them
+        __m512 x = _mm512_mask_loadu_ps(_mm512_set1_ps(1.0f), mask, &vals[j]);
+        _mm512_mask_storeu_ps(&out[j], mask, rsqrt14_ps(x, steps));
+    }
+}
+
+/* There is no rsqrt for doubles before AVX-512. x = m * 4^h is split with integer operations into m in [1, 4),
+which fits into a float for rsqrtps, and the exponent, then 1/sqrt(x) = 1/sqrt(m) * 2^-h. The biased exponent of
+m is 1023 or 1024 so that e - em is even, the biased exponent of 2^-h is 1023 - h = (2046 + em - e) / 2. */
+static inline __m128d rsqrt_pd(__m128d x, int steps)
+{
+    __m128i bits = _mm_castpd_si128(x);
+    __m128i e = _mm_srli_epi64(bits, 52);
+    __m128i em = _mm_sub_epi64(_mm_set1_epi64x(1024), _mm_and_si128(e, _mm_set1_epi64x(1)));
+    __m128d m = _mm_castsi128_pd(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi64x(0x000FFFFFFFFFFFFF)), _mm_slli_epi64(em, 52)));
+    __m128i scale = _mm_slli_epi64(_mm_srli_epi64(_mm_sub_epi64(_mm_add_epi64(_mm_set1_epi64x(2046), em), e), 1), 52);
+    __m128d y = _mm_mul_pd(_mm_cvtps_pd(_mm_rsqrt_ps(_mm_cvtpd_ps(m))), _mm_castsi128_pd(scale));
+
+    __m128d xhalf = _mm_mul_pd(x, _mm_set1_pd(0.5));
+    for (int i = 0; i < steps; i++)
+    {
+        y = _mm_mul_pd(y, _mm_sub_pd(_mm_set1_pd(1.5), _mm_mul_pd(xhalf, _mm_mul_pd(y, y))));
+    }
+    return y;
+}
+
+static inline void rsqrt_dbl(size_t n, const double *vals, double *out, int steps)
+{
+    size_t j;
+    for (j = 0; j + 2 <= n; j += 2)
+    {
+        _mm_storeu_pd(&out[j], rsqrt_pd(_mm_loadu_pd(&vals[j]), steps));
+    }
+    if (j < n)
+    {
+        out[j] = _mm_cvtsd_f64(rsqrt_pd(_mm_set1_pd(vals[j]), steps));
+    }
+}
+
+__attribute__((target("avx512f"))) static inline __m512d rsqrt14_pd(__m512d x, int steps)
+{
+    __m512d y = _mm512_rsqrt14_pd(x);
+    __m512d xhalf = _mm512_mul_pd(x, _mm512_set1_pd(0.5));
+    for (int i = 0; i < steps; i++)
+    {
+        y = _mm512_mul_pd(y, _mm512_fnmadd_pd(xhalf, _mm512_mul_pd(y, y), _mm512_set1_pd(1.5)));
+    }
+    return y;
+}
+
+__attribute__((target("avx512f"))) static inline void rsqrt14_dbl(size_t n, const double *vals, double *out, int steps)
+{
+    __mmask8 mask = 0xFF;
+    for (size_t j = 0; j < n; j += 8)
+    {
+        if (n - j < 8)
+        {
+            mask = (__mmask8)((1u << (n - j)) - 1);
+        }
+        __m512d x = _mm512_mask_loadu_pd(_mm512_set1_pd(1.0), mask, &vals[j]);
+        _mm512_mask_storeu_pd(&out[j], mask, rsqrt14_pd(x, steps));
+    }
+}
+
+void fastInvSqrt_flt_RSQRT(size_t n, float vals[n], float out[n])
+{
+    rsqrt_flt(n, vals, out, 0);
+}
+
+void fastInvSqrt_flt_RSQRT_Newton(size_t n, float vals[n], float out[n])
+{
+    rsqrt_flt(n, vals, out, 1);
+}
+
+void fastInvSqrt_flt_RSQRT_DoubleNewton(size_t n, float vals[n], float out[n])
+{
+    rsqrt_flt(n, vals, out, 2);
+}
+
+__attribute__((target("avx512f"))) void fastInvSqrt_flt_AVX512_RSQRT14(size_t n, float vals[n], float out[n])
+{
+    rsqrt14_flt(n, vals, out, 0);
+}
+
+__attribute__((target("avx512f"))) void fastInvSqrt_flt_AVX512_RSQRT14_Newton(size_t n, float vals[n], float out[n])
+{
+    rsqrt14_flt(n, vals, out, 1);
+}
+
+__attribute__((target("avx512f"))) void fastInvSqrt_flt_AVX512_RSQRT14_DoubleNewton(size_t n, float vals[n], float out[n])
+{
+    rsqrt14_flt(n, vals, out, 2);
+}
+
+void fastInvSqrt_dbl_RSQRT(size_t n, double vals[n], double out[n])
+{
+    rsqrt_dbl(n, vals, out, 0);
+}
+
+void fastInvSqrt_dbl_RSQRT_Newton(size_t n, double vals[n], double out[n])
+{
+    rsqrt_dbl(n, vals, out, 1);
+}
+
+void fastInvSqrt_dbl_RSQRT_DoubleNewton(size_t n, double vals[n], double out[n])
+{
+    rsqrt_dbl(n, vals, out, 2);
+}
+
+__attribute__((target("avx512f"))) void fastInvSqrt_dbl_AVX512_RSQRT14(size_t n, double vals[n], double out[n])
+{
+    rsqrt14_dbl(n, vals, out, 0);
+}
+
+__attribute__((target("avx512f"))) void fastInvSqrt_dbl_AVX512_RSQRT14_Newton(size_t n, double vals[n], double out[n])
+{
+    rsqrt14_dbl(n, vals, out, 1);
+}
+
+__attribute__((target("avx512f"))) void fastInvSqrt_dbl_AVX512_RSQRT14_DoubleNewton(size_t n, double vals[n], double out[n])
+{
+    rsqrt14_dbl(n, vals, out, 2);
+}
+
+/* The 16-bit kernels compute the seed on the 16-bit patterns and the Newton iteration in float. The remaining
+values are copied into a zero-padded vector, so they go through the same operations as the others. */
+__attribute__((target("f16c"))) static inline __m128i invSqrt_ph(__m128i h)
+{
+    __m256 x = _mm256_cvtph_ps(h);
+    __m256 xhalf = _mm256_mul_ps(x, _mm256_set1_ps(0.5f));
+    __m256 y = _mm256_cvtph_ps(_mm_sub_epi16(_mm_set1_epi16(MAGIC_F16), _mm_srli_epi16(h, 1)));
+    y = _mm256_mul_ps(y, _mm256_sub_ps(_mm256_set1_ps(1.5f), _mm256_mul_ps(_mm256_mul_ps(xhalf, y), y)));
+    return _mm256_cvtps_ph(y, _MM_FROUND_TO_NEAREST_INT);
+}
+
+__attribute__((target("f16c"))) void fastInvSqrt_f16(size_t n, const uint16_t *vals, uint16_t *out)
+{
+    size_t j;
+    for (j = 0; j + 8 <= n; j += 8)
+    {
+        _mm_storeu_si128((__m128i *)&out[j], invSqrt_ph(_mm_loadu_si128((const __m128i *)&vals[j])));
+    }
+    if (j < n)
+    {
+        uint16_t rest[8] = {0};
+        memcpy(rest, &vals[j], (n - j) * sizeof *rest);
+        _mm_storeu_si128((__m128i *)rest, invSqrt_ph(_mm_loadu_si128((const __m128i *)rest)));
+        memcpy(&out[j], rest, (n - j) * sizeof *rest);
+    }
+}
+
+__attribute__((target("avx512f"))) static inline __m256i invSqrt512_ph(__m256i h)
+{
+    __m512 x = _mm512_cvtph_ps(h);
+    __m512 xhalf = _mm512_mul_ps(x, _mm512_set1_ps(0.5f));
+    __m512 y = _mm512_cvtph_ps(_mm256_sub_epi16(_mm256_set1_epi16(MAGIC_F16), _mm256_srli_epi16(h, 1)));
+    y = _mm512_mul_ps(y, _mm512_sub_ps(_mm512_set1_ps(1.5f), _mm512_mul_ps(_mm512_mul_ps(xhalf, y), y)));
+    return _mm512_cvtps_ph(y, _MM_FROUND_TO_NEAREST_INT);
+}
+
+__attribute__((target("avx512f"))) void fastInvSqrt_f16_AVX512(size_t n, const uint16_t *vals, uint16_t *out)
+{
+    size_t j;
+    for (j = 0; j + 16 <= n; j += 16)
+    {
+        _mm256_storeu_si256((__m256i *)&out[j], invSqrt512_ph(_mm256_loadu_si256((const __m256i *)&vals[j])));
+    }
+    if (j < n)
+    {
+        uint16_t rest[16] = {0};
+        memcpy(rest, &vals[j], (n - j) * sizeof *rest);
+        _mm256_storeu_si256((__m256i *)rest, invSqrt512_ph(_mm256_loadu_si256((const __m256i *)rest)));
+        memcpy(&out[j], rest, (n - j) * sizeof *rest);
+    }
+}
+
+// Round the floats to nearest even bfloat16, the results are in the lower 16 bits of every element
+__attribute__((target("avx2"))) static inline __m256i round_bf16(__m256 y)
+{
+    __m256i u = _mm256_castps_si256(y);
+    __m256i odd = _mm256_and_si256(_mm256_srli_epi32(u, 16), _mm256_set1_epi32(1));
+    return _mm256_srli_epi32(_mm256_add_epi32(u, _mm256_add_epi32(odd, _mm256_set1_epi32(0x7FFF))), 16);
+}
+
+__attribute__((target("avx2"))) static inline __m128i invSqrt_bf16(__m128i h)
+{
+    __m256 x = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(h), 16));
+    __m256 xhalf = _mm256_mul_ps(x, _mm256_set1_ps(0.5f));
+    __m128i seed = _mm_sub_epi16(_mm_set1_epi16(MAGIC_BF16), _mm_srli_epi16(h, 1));
+    __m256 y = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(seed), 16));
+    y = _mm256_mul_ps(y, _mm256_sub_ps(_mm256_set1_ps(1.5f), _mm256_mul_ps(_mm256_mul_ps(xhalf, y), y)));
+    // Pack the 8 results within the 128-bit lanes and gather the two lower quarters
+    __m256i packed = _mm256_packus_epi32(round_bf16(y), _mm256_setzero_si256());
+    return _mm256_castsi256_si128(_mm256_permute4x64_epi64(packed, 0x08));
+}
+
+__attribute__((target("avx2"))) void fastInvSqrt_bf16(size_t n, const uint16_t *vals, uint16_t *out)
+{
+    size_t j;
+    for (j = 0; j + 8 <= n; j += 8)
+    {
+        _mm_storeu_si128((__m128i *)&out[j], invSqrt_bf16(_mm_loadu_si128((const __m128i *)&vals[j])));
+    }
+    if (j < n)
+    {
+        uint16_t rest[8] = {0};
+        memcpy(rest, &vals[j], (n - j) * sizeof *rest);
+        _mm_storeu_si128((__m128i *)rest, invSqrt_bf16(_mm_loadu_si128((const __m128i *)rest)));
+        memcpy(&out[j], rest, (n - j) * sizeof *rest);
+    }
+}
+
+__attribute__((target("avx512f"))) static inline __m256i invSqrt512_bf16(__m256i h)
+{
+    __m512 x = _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_cvtepu16_epi32(h), 16));
+    __m512 xhalf = _mm512_mul_ps(x, _mm512_set1_ps(0.5f));
+    __m256i seed = _mm256_sub_epi16(_mm256_set1_epi16(MAGIC_BF16), _mm256_srli_epi16(h, 1));
+    __m512 y = _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_cvtepu16_epi32(seed), 16));
+    y = _mm512_mul_ps(y, _mm512_sub_ps(_mm512_set1_ps(1.5f), _mm512_mul_ps(_mm512_mul_ps(xhalf, y), y)));
+    __m512i u = _mm512_castps_si512(y);
+    __m512i odd = _mm512_and_si512(_mm512_srli_epi32(u, 16), _mm512_set1_epi32(1));
+    u = _mm512_add_epi32(u, _mm512_add_epi32(odd, _mm512_set1_epi32(0x7FFF))); // Round to nearest even
+    return _mm512_cvtepi32_epi16(_mm512_srli_epi32(u, 16));
+}
+
+__attribute__((target("avx512f"))) void fastInvSqrt_bf16_AVX512(size_t n, const uint16_t *vals, uint16_t *out)
+{
+    size_t j;
+    for (j = 0; j + 16 <= n; j += 16)
+    {
+        _mm256_storeu_si256((__m256i *)&out[j], invSqrt512_bf16(_mm256_loadu_si256((const __m256i *)&vals[j])));
+    }
+    if (j < n)
+    {
+        uint16_t rest[16] = {0};
+        memcpy(rest, &vals[j], (n - j) * sizeof *rest);
+        _mm256_storeu_si256((__m256i *)rest, invSqrt512_bf16(_mm256_loadu_si256((const __m256i *)rest)));
+        memcpy(&out[j], rest, (n - j) * sizeof *rest);
+    }
+}
+
+/* Mixed-precision kernels: x is split into m in [1, 4) and 2^-h as in rsqrt_pd, but directly on the exponent fields
+(em and e are the biased exponents shifted by 52, 2046 + em - e is even, so the shift by 1 gives the exponent of 2^-h).
+The doubles m of two vectors are narrowed into one float vector, which gets the float seed of invSqrt256_ps/invSqrt512_ps
+and a second float Newton iteration at twice the lane width. The estimate is widened, scaled with 2^-h and refined with
+double Newton iterations. (xhalf * y) * y stays in the normal range for all positive normal doubles, unlike y * y. */
+__attribute__((target("avx2,fma"))) static inline __m256d reduce256_pd(__m256d x, __m256d *scale)
+{
+    __m256i bits = _mm256_castpd_si256(x);
+    __m256i em = _mm256_sub_epi64(_mm256_set1_epi64x(1024ll << 52), _mm256_and_si256(bits, _mm256_set1_epi64x(1ll << 52)));
+    __m256i e = _mm256_and_si256(bits, _mm256_set1_epi64x(0x7FF0000000000000));
+    *scale = _mm256_castsi256_pd(_mm256_srli_epi64(_mm256_sub_epi64(_mm256_add_epi64(_mm256_set1_epi64x(2046ll << 52), em), e), 1));
+    return _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFF)), em));
+}
+
+__attribute__((target("avx2,fma"))) static inline __m256d newton256_pd(__m256d x, __m256d y, int steps)
+{
+    __m256d xhalf = _mm256_mul_pd(x, _mm256_set1_pd(0.5));
+    for (int i = 0; i < steps; i++)
+    {
+        y = _mm256_mul_pd(y, _mm256_fnmadd_pd(_mm256_mul_pd(xhalf, y), y, _mm256_set1_pd(1.5)));
+    }
+    return y;
+}
+
+// 8 doubles from vals to out
+__attribute__((target("avx2,fma"))) static inline void mixed256(const double *vals, double *out, int steps)
+{
+    __m256d x0 = _mm256_loadu_pd(vals);
+    __m256d x1 = _mm256_loadu_pd(vals + 4);
+    __m256d scale0;
+    __m256d scale1;
+    __m256 m = _mm256_set_m128(_mm256_cvtpd_ps(reduce256_pd(x1, &scale1)), _mm256_cvtpd_ps(reduce256_pd(x0, &scale0)));
+    __m256 y = invSqrt256_ps(m);
+    __m256 mhalf = _mm256_mul_ps(m, _mm256_set1_ps(0.5f));
+    y = _mm256_mul_ps(y, _mm256_fnmadd_ps(_mm256_mul_ps(mhalf, y), y, _mm256_set1_ps(1.5f)));
+    __m256d y0 = _mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(y)), scale0);
+    __m256d y1 = _mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(y, 1)), scale1);
+    _mm256_storeu_pd(out, newton256_pd(x0, y0, steps));
+    _mm256_storeu_pd(out + 4, newton256_pd(x1, y1, steps));
+}
+
+// The remaining values are padded with ones, so they go through the same operations as the others
+__attribute__((target("avx2,fma"))) static inline void mixed_dbl_avx2(size_t n, const double *vals, double *out, int steps)
+{
+    size_t j;
+    for (j = 0; j + 8 <= n; j += 8)
+    {
+        mixed256(&vals[j], &out[j], steps);
+    }
+    if (j < n)
+    {
+        double rest[8] = {1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0};
+        memcpy(rest, &vals[j], (n - j) * sizeof *rest);
+        mixed256(rest, rest, steps);
+        memcpy(&out[j], rest, (n - j) * sizeof *rest);
+    }
+}
+
+__attribute__((target("avx512f"))) static inline __m512d reduce512_pd(__m512d x, __m512d *scale)
+{
+    __m512i bits = _mm512_castpd_si512(x);
+    __m512i em = _mm512_sub_epi64(_mm512_set1_epi64(1024ll << 52), _mm512_and_si512(bits, _mm512_set1_epi64(1ll << 52)));
+    __m512i e = _mm512_and_si512(bits, _mm512_set1_epi64(0x7FF0000000000000));
+    *scale = _mm512_castsi512_pd(_mm512_srli_epi64(_mm512_sub_epi64(_mm512_add_epi64(_mm512_set1_epi64(2046ll << 52), em), e), 1));
+    return _mm512_castsi512_pd(_mm512_or_si512(_mm512_and_si512(bits, _mm512_set1_epi64(0x000FFFFFFFFFFFFF)), em));
+}
+
+__attribute__((target("avx512f"))) static inline __m512d newton512_pd(__m512d x, __m512d y, int steps)
+{
+    __m512d xhalf = _mm512_mul_pd(x, _mm512_set1_pd(0.5));
+    for (int i = 0; i < steps; i++)
+    {
+        y = _mm512_mul_pd(y, _mm512_fnmadd_pd(_mm512_mul_pd(xhalf, y), y, _mm512_set1_pd(1.5)));
+    }
+    return y;
+}
+
+// 16 doubles from vals to out
+__attribute__((target("avx512f"))) static inline void mixed512(const double *vals, double *out, int steps)
+{
+    __m512d x0 = _mm512_loadu_pd(vals);
+    __m512d x1 = _mm512_loadu_pd(vals + 8);
+    __m512d scale0;
+    __m512d scale1;
+    __m256 m0 = _mm512_cvtpd_ps(reduce512_pd(x0, &scale0));
+    __m256 m1 = _mm512_cvtpd_ps(reduce512_pd(x1, &scale1));
+    __m512 m = _mm512_castpd_ps(_mm512_insertf64x4(_mm512_castpd256_pd512(_mm256_castps_pd(m0)), _mm256_castps_pd(m1), 1));
+    __m512 y = invSqrt512_ps(m);
+    __m512 mhalf = _mm512_mul_ps(m, _mm512_set1_ps(0.5f));
+    y = _mm512_mul_ps(y, _mm512_fnmadd_ps(_mm512_mul_ps(mhalf, y), y, _mm512_set1_ps(1.5f)));
+    __m512d y0 = _mm512_mul_pd(_mm512_cvtps_pd(_mm512_castps512_ps256(y)), scale0);
+    __m512d y1 = _mm512_mul_pd(_mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(y), 1))), scale1);
+    _mm512_storeu_pd(out, newton512_pd(x0, y0, steps));
+    _mm512_storeu_pd(out + 8, newton512_pd(x1, y1, steps));
+}
+
+__attribute__((target("avx512f"))) static inline void mixed_dbl_avx512(size_t n, const double *vals, double *out, int steps)
+{
+    size_t j;
+    for (j = 0; j + 16 <= n; j += 16)
+    {
+        mixed512(&vals[j], &out[j], steps);
+    }
+    if (j < n)
+    {
+        double rest[16];
+        for (size_t k = 0; k < 16; k++)
+        {
+            rest[k] = 1.0;
+        }
+        memcpy(rest, &vals[j], (n - j) * sizeof *rest);
+        mixed512(rest, rest, steps);
+        memcpy(&out[j], rest, (n - j) * sizeof *rest);
+    }
+}
+
+__attribute__((target("avx2,fma"))) void fastInvSqrt_dbl_AVX2_Mixed(size_t n, double vals[n], double out[n])
+{
+    mixed_dbl_avx2(n, vals, out, 1);
+}
+
+__attribute__((target("avx2,fma"))) void fastInvSqrt_dbl_AVX2_Mixed_DoubleNewton(size_t n, double vals[n], double out[n])
+{
+    mixed_dbl_avx2(n, vals, out, 2);
+}
+
+__attribute__((target("avx512f"))) void fastInvSqrt_dbl_AVX512_Mixed(size_t n, double vals[n], double out[n])
+{
+    mixed_dbl_avx512(n, vals, out, 1);
+}
+
+__attribute__((target("avx512f"))) void fastInvSqrt_dbl_AVX512_Mixed_DoubleNewton(size_t n, double vals[n], double out[n])
+{
+    mixed_dbl_avx512(n, vals, out, 2);
+}
+
+/* Mixed-type kernels: the values are converted in registers and go through exactly the operations of the kernels
+of the computation type, so the results are identical to a separate conversion pass followed by that kernel. */
+void fastInvSqrt_dbl_flt(size_t n, const double *vals, float *out)
+{
+    size_t j;
+    for (j = 0; j + 4 <= n; j += 4)
+    {
+        __m128 x = _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(&vals[j])), _mm_cvtpd_ps(_mm_loadu_pd(&vals[j + 2])));
+        _mm_storeu_ps(&out[j], fastInvSqrt4_flt(x));
+    }
+    for (; j < n; j++)
+    {
+        out[j] = fastInvSqrt1_flt((float)vals[j]);
+    }
+}
+
+__attribute__((target("avx2,fma"))) void fastInvSqrt_dbl_flt_AVX2(size_t n, const double *vals, float *out)
+{
+    size_t j;
+    for (j = 0; j + 8 <= n; j += 8)
+    {
+        __m256 x = _mm256_set_m128(_mm256_cvtpd_ps(_mm256_loadu_pd(&vals[j + 4])), _mm256_cvtpd_ps(_mm256_loadu_pd(&vals[j])));
+        _mm256_storeu_ps(&out[j], invSqrt256_ps(x));
+    }
+    for (; j < n; j++)
+    {
+        out[j] = fastInvSqrt1_flt((float)vals[j]);
+    }
+}
+
+void fastInvSqrt_flt_dbl(size_t n, const float *vals, double *out)
+{
+    size_t j;
+    for (j = 0; j + 4 <= n; j += 4)
+    {
+        __m128 x = _mm_loadu_ps(&vals[j]);
+        _mm_storeu_pd(&out[j], fastInvSqrt2_dbl(_mm_cvtps_pd(x)));
+        _mm_storeu_pd(&out[j + 2], fastInvSqrt2_dbl(_mm_cvtps_pd(_mm_movehl_ps(x, x))));
+    }
+    // fastInvSqrt_dbl only leaves the last odd value to the scalar operations, which round differently
+    if (j + 2 <= n)
+    {
+        _mm_storeu_pd(&out[j], fastInvSqrt2_dbl(_mm_cvtps_pd(_mm_loadl_pi(_mm_setzero_ps(), (const __m64 *)&vals[j]))));
+        j += 2;
+    }
+    for (; j < n; j++)
+    {
+        out[j] = fastInvSqrt1_dbl(vals[j]);
+    }
+}
+
+__attribute__((target("avx2,fma"))) void fastInvSqrt_flt_dbl_AVX2(size_t n, const float *vals, double *out)
+{
+    size_t j;
+    for (j = 0; j + 8 <= n; j += 8)
+    {
+        __m256 x = _mm256_loadu_ps(&vals[j]);
+        _mm256_storeu_pd(&out[j], invSqrt256_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(x))));
+        _mm256_storeu_pd(&out[j + 4], invSqrt256_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(x, 1))));
+    }
+    // Like fastInvSqrt_dbl_AVX2, only less than 4 remaining values use the scalar operations
+    if (j + 4 <= n)
+    {
+        _mm256_storeu_pd(&out[j], invSqrt256_pd(_mm256_cvtps_pd(_mm_loadu_ps(&vals[j]))));
+        j += 4;
+    }
+    for (; j < n; j++)
+    {
+        out[j] = fastInvSqrt1_dbl(vals[j]);
+    }
+}
+
+/* Special value handling of the _Special kernels. The lanes which are not positive and finite are replaced after
+the regular computation: +-0 and +inf differ from the results of 1/sqrt() only in the exponent field, x ^ inf gives
++-inf and +0. Negative values, -inf and NaN give the default NaN of x86 (also produced by sqrtps for negative inputs).
+The SSE and AVX2 kernels detect special lanes with two compares and a movemask and only blend vectors containing one,
+so valid input costs 4 instructions and a predictable branch per vector. */
+#define SPECIAL_INF_FLT 0x7F800000
+#define SPECIAL_NAN_FLT 0xFFC00000
+#define SPECIAL_INF_DBL 0x7FF0000000000000
+#define SPECIAL_NAN_DBL 0xFFF8000000000000
+/* Token table of vfixupimm with one response per input class: QNaN, SNaN and the negative classes give the default NaN (3),
++-0 gives +-inf (6), +inf gives +0 (8), +1 and positive values keep the computed result (0) */
+#define SPECIAL_FIXUP 0x03830633
+
+static inline float special1_flt(float x, float y)
+{
+    union
+    {
+        float x;
+        uint32_t u;
+    } conv = {x};
+    if (x > 0.0f && x < INFINITY)
+    {
+        return y;
+    }
+    conv.u = x == 0.0f || x == INFINITY ? conv.u ^ SPECIAL_INF_FLT : SPECIAL_NAN_FLT;
+    return conv.x;
+}
+
+static inline double special1_dbl(double x, double y)
+{
+    union
+    {
+        double x;
+        uint64_t u;
+    } conv = {x};
+    if (x > 0.0 && x < INFINITY)
+    {
+        return y;
+    }
+    conv.u = x == 0.0 || x == INFINITY ? conv.u ^ SPECIAL_INF_DBL : SPECIAL_NAN_DBL;
+    return conv.x;
+}
+
+// SSE2 has no blendv, the lanes are selected with and/andnot/or
+static inline __m128 special4_flt(__m128 x, __m128 y)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 inf = _mm_castsi128_ps(_mm_set1_epi32(SPECIAL_INF_FLT));
+    __m128 zeroOrInf = _mm_or_ps(_mm_cmpeq_ps(x, zero), _mm_cmpeq_ps(x, inf));
+    __m128 invalid = _mm_cmpnge_ps(x, zero); // Negative or NaN
+    y = _mm_or_ps(_mm_andnot_ps(zeroOrInf, y), _mm_and_ps(zeroOrInf, _mm_xor_ps(x, inf)));
+    return _mm_or_ps(_mm_andnot_ps(invalid, y), _mm_and_ps(invalid, _mm_castsi128_ps(_mm_set1_epi32(SPECIAL_NAN_FLT))));
+}
+
+static inline __m128d special2_dbl(__m128d x, __m128d y)
+{
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d inf = _mm_castsi128_pd(_mm_set1_epi64x(SPECIAL_INF_DBL));
+    __m128d zeroOrInf = _mm_or_pd(_mm_cmpeq_pd(x, zero), _mm_cmpeq_pd(x, inf));
+    __m128d invalid = _mm_cmpnge_pd(x, zero); // Negative or NaN
+    y = _mm_or_pd(_mm_andnot_pd(zeroOrInf, y), _mm_and_pd(zeroOrInf, _mm_xor_pd(x, inf)));
+    return _mm_or_pd(_mm_andnot_pd(invalid, y), _mm_and_pd(invalid, _mm_castsi128_pd(_mm_set1_epi64x(SPECIAL_NAN_DBL))));
+}
+
+__attribute__((target("avx2,fma"))) static inline __m256 special256_ps(__m256 x, __m256 y)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 inf = _mm256_castsi256_ps(_mm256_set1_epi32(SPECIAL_INF_FLT));
+    __m256 zeroOrInf = _mm256_or_ps(_mm256_cmp_ps(x, zero, _CMP_EQ_OQ), _mm256_cmp_ps(x, inf, _CMP_EQ_OQ));
+    y = _mm256_blendv_ps(y, _mm256_xor_ps(x, inf), zeroOrInf);
+    return _mm256_blendv_ps(y, _mm256_castsi256_ps(_mm256_set1_epi32(SPECIAL_NAN_FLT)), _mm256_cmp_ps(x, zero, _CMP_NGE_UQ));
+}
+
+__attribute__((target("avx2,fma"))) static inline __m256d special256_pd(__m256d x, __m256d y)
+{
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d inf = _mm256_castsi256_pd(_mm256_set1_epi64x(SPECIAL_INF_DBL));
+    __m256d zeroOrInf = _mm256_or_pd(_mm256_cmp_pd(x, zero, _CMP_EQ_OQ), _mm256_cmp_pd(x, inf, _CMP_EQ_OQ));
+    y = _mm256_blendv_pd(y, _mm256_xor_pd(x, inf), zeroOrInf);
+    return _mm256_blendv_pd(y, _mm256_castsi256_pd(_mm256_set1_epi64x(SPECIAL_NAN_DBL)), _mm256_cmp_pd(x, zero, _CMP_NGE_UQ));
+}
+
+void fastInvSqrt_flt_Special(size_t n, float vals[n], float out[n])
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 inf = _mm_castsi128_ps(_mm_set1_epi32(SPECIAL_INF_FLT));
+    size_t j;
+    for (j = 0; j + 4 <= n; j += 4)
+    {
+        __m128 x = _mm_loadu_ps(&vals[j]);
+        __m128 y = fastInvSqrt4_flt(x);
+        if (_mm_movemask_ps(_mm_and_ps(_mm_cmpgt_ps(x, zero), _mm_cmplt_ps(x, inf))) != 0xF)
+        {
+            y = special4_flt(x, y);
+        }
+        _mm_storeu_ps(&out[j], y);
+    }
+    for (; j < n; j++)
+    {
+        out[j] = special1_flt(vals[j], fastInvSqrt1_flt(vals[j]));
+    }
+}
+
+__attribute__((target("avx2,fma"))) void fastInvSqrt_flt_AVX2_Special(size_t n, float vals[n], float out[n])
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 inf = _mm256_castsi256_ps(_mm256_set1_epi32(SPECIAL_INF_FLT));
+    size_t j;
+    for (j = 0; j + 8 <= n; j += 8)
+    {
+        __m256 x = _mm256_loadu_ps(&vals[j]);
+        __m256 y = invSqrt256_ps(x);
+        if (_mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(x, zero, _CMP_GT_OQ), _mm256_cmp_ps(x, inf, _CMP_LT_OQ))) != 0xFF)
+        {
+            y = special256_ps(x, y);
+        }
+        _mm256_storeu_ps(&out[j], y);
+    }
+    for (; j < n; j++)
+    {
+        out[j] = special1_flt(vals[j], fastInvSqrt1_flt(vals[j]));
+    }
+}
+
+// The classification and replacement of all special values is a single vfixupimmps
+__attribute__((target("avx512f"))) void fastInvSqrt_flt_AVX512_Special(size_t n, float vals[n], float out[n])
+{
+    const __m512i table = _mm512_set1_epi32(SPECIAL_FIXUP);
+    __mmask16 mask = 0xFFFF;
+    for (size_t j = 0; j < n; j += 16)
+    {
+        if (n - j < 16)
+        {
+            mask = (__mmask16)((1u << (n - j)) - 1);
+        }
+        __m512 x = _mm512_maskz_loadu_ps(mask, &vals[j]);
+        _mm512_mask_storeu_ps(&out[j], mask, _mm512_fixupimm_ps(invSqrt512_ps(x), x, table, 0));
+    }
+}
+
+void fastInvSqrt_dbl_Special(size_t n, double vals[n], double out[n])
+{
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d inf = _mm_castsi128_pd(_mm_set1_epi64x(SPECIAL_INF_DBL));
+    size_t j;
+    for (j = 0; j + 2 <= n; j += 2)
+    {
+        __m128d x = _mm_loadu_pd(&vals[j]);
+        __m128d y = fastInvSqrt2_dbl(x);
+        if (_mm_movemask_pd(_mm_and_pd(_mm_cmpgt_pd(x, zero), _mm_cmplt_pd(x, inf))) != 0x3)
+        {
+            y = special2_dbl(x, y);
+        }
+        _mm_storeu_pd(&out[j], y);
+    }
+    if (j < n)
+    {
+        out[j] = special1_dbl(vals[j], fastInvSqrt1_dbl(vals[j]));
+    }
+}
+
+__attribute__((target("avx2,fma"))) void fastInvSqrt_dbl_AVX2_Special(size_t n, double vals[n], double out[n])
+{
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d inf = _mm256_castsi256_pd(_mm256_set1_epi64x(SPECIAL_INF_DBL));
+    size_t j;
+    for (j = 0; j + 4 <= n; j += 4)
+    {
+        __m256d x = _mm256_loadu_pd(&vals[j]);
+        __m256d y = invSqrt256_pd(x);
+        if (_mm256_movemask_pd(_mm256_and_pd(_mm256_cmp_pd(x, zero, _CMP_GT_OQ), _mm256_cmp_pd(x, inf, _CMP_LT_OQ))) != 0xF)
+        {
+            y = special256_pd(x, y);
+        }
+        _mm256_storeu_pd(&out[j], y);
+    }
+    for (; j < n; j++)
+    {
+        out[j] = special1_dbl(vals[j], fastInvSqrt1_dbl(vals[j]));
+    }
+}
+
+__attribute__((target("avx512f"))) void fastInvSqrt_dbl_AVX512_Special(size_t n, double vals[n], double out[n])
+{
+    const __m512i table = _mm512_set1_epi64(SPECIAL_FIXUP);
+    __mmask8 mask = 0xFF;
+    for (size_t j = 0; j < n; j += 8)
+    {
+        if (n - j < 8)
+        {
+            mask = (__mmask8)((1u << (n - j)) - 1);
+        }
+        __m512d x = _mm512_maskz_loadu_pd(mask, &vals[j]);
+        _mm512_mask_storeu_pd(&out[j], mask, _mm512_fixupimm_pd(invSqrt512_pd(x), x, table, 0));
+    }
+}
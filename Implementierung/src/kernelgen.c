@@ -0,0 +1,241 @@
+/** @file kernelgen.c
+ *  @brief Generation of the Fast Inverse Square Root kernels of the kernel matrix
+ *  @details For the parameters see kernelgen.h. Each combination of element type and width defines its
+ *  operations as macros GEN_op_T_W, from which GEN_BLOCK builds a function computing one vector.
+ *  GEN_KERNEL calls it U times per loop iteration, then once per remaining vector and gen_tail for the last values.
+ *  @author Yll Kryeziu (ge94noh)
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <immintrin.h>
+#include "../include/kernelgen.h"
+
+#define GEN_UINT_flt uint32_t
+#define GEN_UINT_dbl uint64_t
+
+#define GEN_TARGET_scalar
+#define GEN_TARGET_sse
+#define GEN_TARGET_avx2 __attribute__((target("avx2,fma")))
+#define GEN_TARGET_avx512 __attribute__((target("avx512f")))
+
+// Initial guess magic - (x >> 1) for one value, selected by the type of x
+static inline float gen_seed_flt(float x, uint32_t magic)
+{
+    union
+    {
+        float x;
+        uint32_t u;
+    } conv = {x};
+    conv.u = magic - (conv.u >> 1);
+    return conv.x;
+}
+
+static inline double gen_seed_dbl(double x, uint64_t magic)
+{
+    union
+    {
+        double x;
+        uint64_t u;
+    } conv = {x};
+    conv.u = magic - (conv.u >> 1);
+    return conv.x;
+}
+
+#define GEN_SEED_SCALAR(x, magic) _Generic((x), float: gen_seed_flt, double: gen_seed_dbl)(x, magic)
+
+/* Operations for each element type and width: vector type, number of lanes, load, store, broadcast,
+multiplication, initial guess and the Newton step y * (1.5 - xhalf * (y * y)) */
+#define GEN_VEC_flt_scalar float
+#define GEN_LANES_flt_scalar 1
+#define GEN_LOAD_flt_scalar(p) (*(p))
+#define GEN_STORE_flt_scalar(p, v) (*(p) = (v))
+#define GEN_SET1_flt_scalar(c) ((float)(c))
+#define GEN_MUL_flt_scalar(a, b) ((a) * (b))
+#define GEN_SEED_flt_scalar(x, magic) GEN_SEED_SCALAR(x, magic)
+#define GEN_NEWTON_flt_scalar(y, xhalf, k) ((y) * ((k) - (xhalf) * ((y) * (y))))
+
+#define GEN_VEC_dbl_scalar double
+#define GEN_LANES_dbl_scalar 1
+#define GEN_LOAD_dbl_scalar(p) (*(p))
+#define GEN_STORE_dbl_scalar(p, v) (*(p) = (v))
+#define GEN_SET1_dbl_scalar(c) ((double)(c))
+#define GEN_MUL_dbl_scalar(a, b) ((a) * (b))
+#define GEN_SEED_dbl_scalar(x, magic) GEN_SEED_SCALAR(x, magic)
+#define GEN_NEWTON_dbl_scalar(y, xhalf, k) ((y) * ((k) - (xhalf) * ((y) * (y))))
+
+#define GEN_VEC_flt_sse __m128
+#define GEN_LANES_flt_sse 4
+#define GEN_LOAD_flt_sse(p) _mm_loadu_ps(p)
+#define GEN_STORE_flt_sse(p, v) _mm_storeu_ps(p, v)
+#define GEN_SET1_flt_sse(c) _mm_set1_ps(c)
+#define GEN_MUL_flt_sse(a, b) _mm_mul_ps(a, b)
+#define GEN_SEED_flt_sse(x, magic) \
+    _mm_castsi128_ps(_mm_sub_epi32(_mm_set1_epi32(magic), _mm_srli_epi32(_mm_castps_si128(x), 1)))
+#define GEN_NEWTON_flt_sse(y, xhalf, k) _mm_mul_ps(y, _mm_sub_ps(k, _mm_mul_ps(xhalf, _mm_mul_ps(y, y))))
+
+#define GEN_VEC_dbl_sse __m128d
+#define GEN_LANES_dbl_sse 2
+#define GEN_LOAD_dbl_sse(p) _mm_loadu_pd(p)
+#define GEN_STORE_dbl_sse(p, v) _mm_storeu_pd(p, v)
+#define GEN_SET1_dbl_sse(c) _mm_set1_pd(c)
+#define GEN_MUL_dbl_sse(a, b) _mm_mul_pd(a, b)
+#define GEN_SEED_dbl_sse(x, magic) \
+    _mm_castsi128_pd(_mm_sub_epi64(_mm_set1_epi64x(magic), _mm_srli_epi64(_mm_castpd_si128(x), 1)))
+#define GEN_NEWTON_dbl_sse(y, xhalf, k) _mm_mul_pd(y, _mm_sub_pd(k, _mm_mul_pd(xhalf, _mm_mul_pd(y, y))))
+
+#define GEN_VEC_flt_avx2 __m256
+#define GEN_LANES_flt_avx2 8
+#define GEN_LOAD_flt_avx2(p) _mm256_loadu_ps(p)
+#define GEN_STORE_flt_avx2(p, v) _mm256_storeu_ps(p, v)
+#define GEN_SET1_flt_avx2(c) _mm256_set1_ps(c)
+#define GEN_MUL_flt_avx2(a, b) _mm256_mul_ps(a, b)
+#define GEN_SEED_flt_avx2(x, magic) \
+    _mm256_castsi256_ps(_mm256_sub_epi32(_mm256_set1_epi32(magic), _mm256_srli_epi32(_mm256_castps_si256(x), 1)))
+#define GEN_NEWTON_flt_avx2(y, xhalf, k) _mm256_mul_ps(y, _mm256_fnmadd_ps(xhalf, _mm256_mul_ps(y, y), k))
+
+#define GEN_VEC_dbl_avx2 __m256d
+#define GEN_LANES_dbl_avx2 4
+#define GEN_LOAD_dbl_avx2(p) _mm256_loadu_pd(p)
+#define GEN_STORE_dbl_avx2(p, v) _mm256_storeu_pd(p, v)
+#define GEN_SET1_dbl_avx2(c) _mm256_set1_pd(c)
+#define GEN_MUL_dbl_avx2(a, b) _mm256_mul_pd(a, b)
+#define GEN_SEED_dbl_avx2(x, magic) \
+    _mm256_castsi256_pd(_mm256_sub_epi64(_mm256_set1_epi64x(magic), _mm256_srli_epi64(_mm256_castpd_si256(x), 1)))
+#define GEN_NEWTON_dbl_avx2(y, xhalf, k) _mm256_mul_pd(y, _mm256_fnmadd_pd(xhalf, _mm256_mul_pd(y, y), k))
+
+#define GEN_VEC_flt_avx512 __m512
+#define GEN_LANES_flt_avx512 16
+#define GEN_LOAD_flt_avx512(p) _mm512_loadu_ps(p)
+#define GEN_STORE_flt_avx512(p, v) _mm512_storeu_ps(p, v)
+#define GEN_SET1_flt_avx512(c) _mm512_set1_ps(c)
+#define GEN_MUL_flt_avx512(a, b) _mm512_mul_ps(a, b)
+#define GEN_SEED_flt_avx512(x, magic) \
+    _mm512_castsi512_ps(_mm512_sub_epi32(_mm512_set1_epi32(magic), _mm512_srli_epi32(_mm512_castps_si512(x), 1)))
+#define GEN_NEWTON_flt_avx512(y, xhalf, k) _mm512_mul_ps(y, _mm512_fnmadd_ps(xhalf, _mm512_mul_ps(y, y), k))
+
+#define GEN_VEC_dbl_avx512 __m512d
+#define GEN_LANES_dbl_avx512 8
+#define GEN_LOAD_dbl_avx512(p) _mm512_loadu_pd(p)
+#define GEN_STORE_dbl_avx512(p, v) _mm512_storeu_pd(p, v)
+#define GEN_SET1_dbl_avx512(c) _mm512_set1_pd(c)
+#define GEN_MUL_dbl_avx512(a, b) _mm512_mul_pd(a, b)
+#define GEN_SEED_dbl_avx512(x, magic) \
+    _mm512_castsi512_pd(_mm512_sub_epi64(_mm512_set1_epi64(magic), _mm512_srli_epi64(_mm512_castpd_si512(x), 1)))
+#define GEN_NEWTON_dbl_avx512(y, xhalf, k) _mm512_mul_pd(y, _mm512_fnmadd_pd(xhalf, _mm512_mul_pd(y, y), k))
+
+/* Function computing one vector of GEN_LANES_T_W values, and one computing them from vals to out. newton and magic
+are constants after inlining, so the unused Newton steps disappear */
+#define GEN_BLOCK(T, W)                                                                                                \
+    static inline GEN_TARGET_##W GEN_VEC_##T##_##W gen_vec_##T##_##W(GEN_VEC_##T##_##W x, int newton,                \
+                                                                     GEN_UINT_##T magic)                             \
+    {                                                                                                                  \
+        GEN_VEC_##T##_##W xhalf = GEN_MUL_##T##_##W(x, GEN_SET1_##T##_##W(0.5));                                       \
+        GEN_VEC_##T##_##W k = GEN_SET1_##T##_##W(1.5);                                                                 \
+        GEN_VEC_##T##_##W y = GEN_SEED_##T##_##W(x, magic);                                                            \
+        if (newton > 0)                                                                                                \
+        {                                                                                                              \
+            y = GEN_NEWTON_##T##_##W(y, xhalf, k);                                                                     \
+        }                                                                                                              \
+        if (newton > 1)                                                                                                \
+        {                                                                                                              \
+            y = GEN_NEWTON_##T##_##W(y, xhalf, k);                                                                     \
+        }                                                                                                              \
+        if (newton > 2)                                                                                                \
+        {                                                                                                              \
+            y = GEN_NEWTON_##T##_##W(y, xhalf, k);                                                                     \
+        }                                                                                                              \
+        return y;                                                                                                      \
+    }                                                                                                                  \
+                                                                                                                       \
+    static inline GEN_TARGET_##W void gen_block_##T##_##W(const GEN_ELEM_##T *vals, GEN_ELEM_##T *out, int newton,    \
+                                                          GEN_UINT_##T magic)                                          \
+    {                                                                                                                  \
+        GEN_STORE_##T##_##W(out, gen_vec_##T##_##W(GEN_LOAD_##T##_##W(vals), newton, magic));                          \
+    }
+
+/* Function computing the last rest < GEN_LANES_T_W values with the operations of a full vector, so that the result
+of a value does not depend on its position in the array or on the chunks of the thread pool. AVX-512 uses a masked
+load and store, the other widths copy the values into a vector padded with ones */
+#define GEN_TAIL_padded(T, W)                                                                                          \
+    static inline GEN_TARGET_##W void gen_tail_##T##_##W(const GEN_ELEM_##T *vals, GEN_ELEM_##T *out, size_t rest,    \
+                                                         int newton, GEN_UINT_##T magic)                               \
+    {                                                                                                                  \
+        GEN_ELEM_##T buf[GEN_LANES_##T##_##W];                                                                         \
+        for (size_t i = 0; i < GEN_LANES_##T##_##W; i++)                                                               \
+        {                                                                                                              \
+            buf[i] = i < rest ? vals[i] : 1;                                                                           \
+        }                                                                                                              \
+        gen_block_##T##_##W(buf, buf, newton, magic);                                                                  \
+        memcpy(out, buf, rest * sizeof *buf);                                                                          \
+    }
+
+#define GEN_TAIL_masked(T, W)                                                                                          \
+    static inline GEN_TARGET_##W void gen_tail_##T##_##W(const GEN_ELEM_##T *vals, GEN_ELEM_##T *out, size_t rest,    \
+                                                         int newton, GEN_UINT_##T magic)                               \
+    {                                                                                                                  \
+        GEN_MASK_##T mask = (GEN_MASK_##T)((1u << rest) - 1);                                                          \
+        GEN_MASK_STORE_##T##_##W(out, mask, gen_vec_##T##_##W(GEN_MASK_LOAD_##T##_##W(mask, vals), newton, magic));    \
+    }
+
+#define GEN_TAIL_scalar GEN_TAIL_padded
+#define GEN_TAIL_sse GEN_TAIL_padded
+#define GEN_TAIL_avx2 GEN_TAIL_padded
+#define GEN_TAIL_avx512 GEN_TAIL_masked
+
+#define GEN_MASK_flt __mmask16
+#define GEN_MASK_dbl __mmask8
+#define GEN_MASK_LOAD_flt_avx512(mask, p) _mm512_maskz_loadu_ps(mask, p)
+#define GEN_MASK_LOAD_dbl_avx512(mask, p) _mm512_maskz_loadu_pd(mask, p)
+#define GEN_MASK_STORE_flt_avx512(p, mask, v) _mm512_mask_storeu_ps(p, mask, v)
+#define GEN_MASK_STORE_dbl_avx512(p, mask, v) _mm512_mask_storeu_pd(p, mask, v)
+
+GEN_BLOCK(flt, scalar)
+GEN_BLOCK(flt, sse)
+GEN_BLOCK(flt, avx2)
+GEN_BLOCK(flt, avx512)
+GEN_BLOCK(dbl, scalar)
+GEN_BLOCK(dbl, sse)
+GEN_BLOCK(dbl, avx2)
+GEN_BLOCK(dbl, avx512)
+
+GEN_TAIL_scalar(flt, scalar)
+GEN_TAIL_sse(flt, sse)
+GEN_TAIL_avx2(flt, avx2)
+GEN_TAIL_avx512(flt, avx512)
+GEN_TAIL_scalar(dbl, scalar)
+GEN_TAIL_sse(dbl, sse)
+GEN_TAIL_avx2(dbl, avx2)
+GEN_TAIL_avx512(dbl, avx512)
+
+// Repeat F(k, ...) for k = 0, ..., U - 1
+#define GEN_REPEAT_1(F, ...) F(0, __VA_ARGS__)
+#define GEN_REPEAT_2(F, ...) GEN_REPEAT_1(F, __VA_ARGS__) F(1, __VA_ARGS__)
+#define GEN_REPEAT_4(F, ...) GEN_REPEAT_2(F, __VA_ARGS__) F(2, __VA_ARGS__) F(3, __VA_ARGS__)
+#define GEN_REPEAT_8(F, ...) GEN_REPEAT_4(F, __VA_ARGS__) F(4, __VA_ARGS__) F(5, __VA_ARGS__) F(6, __VA_ARGS__) F(7, __VA_ARGS__)
+
+// k-th vector of the unrolled loop body
+#define GEN_UNROLLED(k, T, W, N, MAGIC) \
+    gen_block_##T##_##W(&vals[j + (k) * GEN_LANES_##T##_##W], &out[j + (k) * GEN_LANES_##T##_##W], N, MAGIC);
+
+#define GEN_KERNEL(T, W, U, N, MAGIC, TAG, ERR, COST)                                          \
+    GEN_TARGET_##W void GEN_NAME(T, W, U, N, TAG)(size_t n, GEN_ELEM_##T vals[n], GEN_ELEM_##T out[n]) \
+    {                                                                                          \
+        _Static_assert((N) >= 0 && (N) <= 3, "The kernel matrix supports 0 to 3 Newton iterations"); \
+        size_t j = 0;                                                                          \
+        for (; j + (U) * GEN_LANES_##T##_##W <= n; j += (U) * GEN_LANES_##T##_##W)             \
+        {                                                                                      \
+            GEN_REPEAT_##U(GEN_UNROLLED, T, W, N, MAGIC)                                       \
+        }                                                                                      \
+        for (; j + GEN_LANES_##T##_##W <= n; j += GEN_LANES_##T##_##W)                         \
+        {                                                                                      \
+            gen_block_##T##_##W(&vals[j], &out[j], N, MAGIC);                                  \
+        }                                                                                      \
+        if (j < n)                                                                             \
+        {                                                                                      \
+            gen_tail_##T##_##W(&vals[j], &out[j], n - j, N, MAGIC);                            \
+        }                                                                                      \
+    }
+
+KERNEL_MATRIX_FLT(GEN_KERNEL)
+KERNEL_MATRIX_DBL(GEN_KERNEL)
@@ -3,46 +3,355 @@
  *
  *  @author Ngoc Kim Ngan Nguyen (ge23fak)
  */
-
+#define _POSIX_C_SOURCE 199309L
 #include <stdio.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <float.h>
 #include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <immintrin.h>
 
 #include "../include/magicnumber.h"
+#include "../include/cpufeatures.h"
+#include "../include/threadpool.h"
 
-// Calculate MagicNumber for Floats save its relative error in parameter error
-uint32_t magicnumber_flt(double *error)
+#define MAGIC_LOW 0x5F300000      // Lower bound of the interval of MagicNumbers for floats
+#define MAGIC_HIGH 0x5F400000     // Upper bound of the interval of MagicNumbers for floats
+#define MAGIC_PERIOD 0x800000     // Adding 2^23 to the MagicNumber doubles the initial approximation
+#define MANTISSAS (1u << 24)      // Number of floats in [0.5, 2), every one is tested
+#define BOUND_CHECK 8192          // Number of floats after which the running maximum is compared to the bound
+#define SEARCH_BLOCK 256          // Number of MagicNumbers a thread takes at once in the exhaustive search
+#define DBL_MANTISSA (1llu << 52) // Number of doubles in [1, 2)
+#define DBL_STRIDE (1llu << 28)   // Distance of the tested doubles, 2^25 values of doubles in [0.5, 2) are tested
+#define MAGIC16_LOW 0x4000        // Interval of MagicNumbers for the 16-bit formats, all seeds of x in [0.5, 2) stay positive normal numbers
+#define MAGIC16_HIGH 0x8000
+
+// Set up method to measure runtime
+static inline double curtime(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/* Return the maximum of |sqrt(x) * y - 1| over the count floats x in [0.5, 2) with mantissas first, first + stride, ...,
+where y is the result of the fast inverse square root with MagicNumber c and one Newton iteration.
+The evaluation stops early once the maximum exceeds bound, as the candidate is worse anyway. */
+static double max_error_flt_scalar(uint32_t c, uint32_t first, uint32_t stride, uint32_t count, double bound)
 {
     union
     {
         float f;
         uint32_t x;
     } conv;
-    uint32_t minC = 0x5F300000;   // Lower bound
-    uint32_t maxC = 0x5F400000;   // Upper bound
+    double maxError = 0.0;
+    for (uint32_t k = 0; k < count; k++)
+    {
+        conv.x = 0x3F000000 + first + k * stride; // x in [0.5, 2) with mantissa m
+        float xhalf = conv.f * 0.5L;
+        double reference = sqrt(conv.f); // True square root
+        conv.x = c - (conv.x >> 1);
+        float y = conv.f;
+        y = y * (1.5F - (xhalf * y * y)); // Newton's iteration
+        double relativeError = fabs(reference * y - 1.0);
+        maxError = relativeError > maxError ? relativeError : maxError;
+        if (k % BOUND_CHECK == 0 && maxError > bound)
+        {
+            break;
+        }
+    }
+    return maxError;
+}
+
+// Same as max_error_flt_scalar, but 8 floats are evaluated at once. The float operations are the same, so the results are identical.
+__attribute__((target("avx2"))) static double max_error_flt_avx2(uint32_t c, uint32_t first, uint32_t stride, uint32_t count, double bound)
+{
+    const __m256i magicnumber = _mm256_set1_epi32(c);
+    const __m256i step = _mm256_set1_epi32(8 * stride);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 threehalfs = _mm256_set1_ps(1.5f);
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d absmask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFF));
+    __m256i xi = _mm256_add_epi32(_mm256_set1_epi32(0x3F000000 + first),
+                                  _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride)));
+    __m256d maxLow = _mm256_setzero_pd();
+    __m256d maxHigh = _mm256_setzero_pd();
+    double maxError = 0.0;
+    uint32_t k;
+
+    for (k = 0; k + 8 <= count; k += 8)
+    {
+        __m256 x = _mm256_castsi256_ps(xi);
+        __m256 xhalf = _mm256_mul_ps(x, half);
+        __m256 y = _mm256_castsi256_ps(_mm256_sub_epi32(magicnumber, _mm256_srli_epi32(xi, 1)));
+        y = _mm256_mul_ps(y, _mm256_sub_ps(threehalfs, _mm256_mul_ps(_mm256_mul_ps(xhalf, y), y))); // Newton's iteration
+
+        // Relative error in double precision, 4 floats per half
+        __m256d refLow = _mm256_sqrt_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(x)));
+        __m256d refHigh = _mm256_sqrt_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)));
+        __m256d errLow = _mm256_and_pd(_mm256_sub_pd(_mm256_mul_pd(refLow, _mm256_cvtps_pd(_mm256_castps256_ps128(y))), one), absmask);
+        __m256d errHigh = _mm256_and_pd(_mm256_sub_pd(_mm256_mul_pd(refHigh, _mm256_cvtps_pd(_mm256_extractf128_ps(y, 1))), one), absmask);
+        maxLow = _mm256_max_pd(maxLow, errLow);
+        maxHigh = _mm256_max_pd(maxHigh, errHigh);
+        xi = _mm256_add_epi32(xi, step);
+
+        if (k % BOUND_CHECK == 0)
+        {
+            double lanes[4];
+            _mm256_storeu_pd(lanes, _mm256_max_pd(maxLow, maxHigh));
+            for (int i = 0; i < 4; i++)
+            {
+                maxError = lanes[i] > maxError ? lanes[i] : maxError;
+            }
+            if (maxError > bound)
+            {
+                return maxError;
+            }
+        }
+    }
+
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_max_pd(maxLow, maxHigh));
+    for (int i = 0; i < 4; i++)
+    {
+        maxError = lanes[i] > maxError ? lanes[i] : maxError;
+    }
+    // Deal with the rest of the floats with scalar operations
+    double rest = max_error_flt_scalar(c, first + k * stride, stride, count - k, bound);
+    return rest > maxError ? rest : maxError;
+}
+
+static double max_error_flt(uint32_t c, uint32_t first, uint32_t stride, uint32_t count, double bound)
+{
+    if (cpu_supports(CPU_AVX2))
+    {
+        return max_error_flt_avx2(c, first, stride, count, bound);
+    }
+    return max_error_flt_scalar(c, first, stride, count, bound);
+}
+
+/* Compute the range [tmin, tmax] of sqrt(x) * y over the count floats x in [0.5, 2) with mantissas first, first + stride, ...,
+where y is the result of the fast inverse square root with MagicNumber c followed by the given number of tuned Newton iterations
+y = y * (k[2i] - k[2i+1] * x * y * y). The evaluation stops early once tmax / tmin exceeds bound. */
+static void range_flt_scalar(uint32_t c, const float k[], int iterations, uint32_t first, uint32_t stride, uint32_t count,
+                             double bound, double *tmin, double *tmax)
+{
+    union
+    {
+        float f;
+        uint32_t x;
+    } conv;
+    double lo = DBL_MAX;
+    double hi = 0.0;
+    for (uint32_t j = 0; j < count; j++)
+    {
+        conv.x = 0x3F000000 + first + j * stride; // x in [0.5, 2) with mantissa m
+        float x = conv.f;
+        double reference = sqrt(x); // True square root
+        conv.x = c - (conv.x >> 1);
+        float y = conv.f;
+        for (int i = 0; i < iterations; i++)
+        {
+            float kx = k[2 * i + 1] * x;
+            y = y * (k[2 * i] - kx * (y * y)); // Tuned Newton's iteration
+        }
+        double t = reference * y;
+        lo = t < lo ? t : lo;
+        hi = t > hi ? t : hi;
+        if (j % BOUND_CHECK == 0 && hi > bound * lo)
+        {
+            break;
+        }
+    }
+    *tmin = lo;
+    *tmax = hi;
+}
+
+// Same as range_flt_scalar, but 8 floats are evaluated at once. The float operations are the same, so the results are identical.
+__attribute__((target("avx2"))) static void range_flt_avx2(uint32_t c, const float k[], int iterations, uint32_t first, uint32_t stride,
+                                                          uint32_t count, double bound, double *tmin, double *tmax)
+{
+    const __m256i magicnumber = _mm256_set1_epi32(c);
+    const __m256i step = _mm256_set1_epi32(8 * stride);
+    __m256i xi = _mm256_add_epi32(_mm256_set1_epi32(0x3F000000 + first),
+                                  _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride)));
+    __m256d minimum = _mm256_set1_pd(DBL_MAX);
+    __m256d maximum = _mm256_setzero_pd();
+    double lanesMin[4];
+    double lanesMax[4];
+    double lo = DBL_MAX;
+    double hi = 0.0;
+    uint32_t j;
+
+    for (j = 0; j + 8 <= count; j += 8)
+    {
+        __m256 x = _mm256_castsi256_ps(xi);
+        __m256 y = _mm256_castsi256_ps(_mm256_sub_epi32(magicnumber, _mm256_srli_epi32(xi, 1)));
+        for (int i = 0; i < iterations; i++)
+        {
+            __m256 kx = _mm256_mul_ps(_mm256_set1_ps(k[2 * i + 1]), x);
+            y = _mm256_mul_ps(y, _mm256_sub_ps(_mm256_set1_ps(k[2 * i]), _mm256_mul_ps(kx, _mm256_mul_ps(y, y)))); // Tuned Newton's iteration
+        }
+
+        __m256d tLow = _mm256_mul_pd(_mm256_sqrt_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(x))), _mm256_cvtps_pd(_mm256_castps256_ps128(y)));
+        __m256d tHigh = _mm256_mul_pd(_mm256_sqrt_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(x, 1))), _mm256_cvtps_pd(_mm256_extractf128_ps(y, 1)));
+        minimum = _mm256_min_pd(minimum, _mm256_min_pd(tLow, tHigh));
+        maximum = _mm256_max_pd(maximum, _mm256_max_pd(tLow, tHigh));
+        xi = _mm256_add_epi32(xi, step);
+
+        if (j % BOUND_CHECK == 0)
+        {
+            _mm256_storeu_pd(lanesMin, minimum);
+            _mm256_storeu_pd(lanesMax, maximum);
+            for (int i = 0; i < 4; i++)
+            {
+                lo = lanesMin[i] < lo ? lanesMin[i] : lo;
+                hi = lanesMax[i] > hi ? lanesMax[i] : hi;
+            }
+            if (hi > bound * lo)
+            {
+                *tmin = lo;
+                *tmax = hi;
+                return;
+            }
+        }
+    }
+
+    // Deal with the rest of the floats with scalar operations
+    range_flt_scalar(c, k, iterations, first + j * stride, stride, count - j, bound, tmin, tmax);
+    _mm256_storeu_pd(lanesMin, minimum);
+    _mm256_storeu_pd(lanesMax, maximum);
+    for (int i = 0; i < 4; i++)
+    {
+        *tmin = lanesMin[i] < *tmin ? lanesMin[i] : *tmin;
+        *tmax = lanesMax[i] > *tmax ? lanesMax[i] : *tmax;
+    }
+}
+
+static void range_flt(uint32_t c, const float k[], int iterations, uint32_t stride, double bound, double *tmin, double *tmax)
+{
+    if (cpu_supports(CPU_AVX2))
+    {
+        range_flt_avx2(c, k, iterations, 0, stride, MANTISSAS / stride, bound, tmin, tmax);
+    }
+    else
+    {
+        range_flt_scalar(c, k, iterations, 0, stride, MANTISSAS / stride, bound, tmin, tmax);
+    }
+}
+
+// Metrics which are minimized by the search, evaluated on every stride-th float
+static double error_metric_flt(uint32_t c, uint32_t stride, double bound)
+{
+    return max_error_flt(c, 0, stride, MANTISSAS / stride, bound);
+}
+
+/* With tuned coefficients the error after the Newton iteration only depends on the ratio tmax / tmin of the initial approximation,
+since any scaling of y is absorbed by k1 and k2. Minimizing the ratio therefore minimizes the error after 1 and 2 iterations.
+The ratio repeats with period MAGIC_PERIOD, so searching one period around MAGIC_LOW covers every possible MagicNumber.
+Near its minimum the ratio is smooth and very flat, which defeats the pruning of the exhaustive search, so the coarse to fine search is used. */
+static double ratio_metric_flt(uint32_t c, uint32_t stride, double bound)
+{
+    double tmin;
+    double tmax;
+    range_flt(c, NULL, 0, stride, bound, &tmin, &tmax);
+    return tmax / tmin;
+}
+
+// Result of the joint tuning of MagicNumber and Newton coefficients
+struct Tuning
+{
+    uint64_t c;      // MagicNumber
+    double k[4];     // Coefficients k1, k2 of the first and k3, k4 of the second Newton iteration
+    double error[2]; // Maximum relative error in percent after 1 and 2 iterations
+};
+
+// State of the exhaustive search shared by all threads
+struct Search
+{
+    uint32_t low;            // First MagicNumber of the interval
+    uint32_t high;           // End of the interval
+    double (*metric)(uint32_t c, uint32_t stride, double bound); // Value to minimize, evaluated on every stride-th float
+    atomic_uint next;        // Next MagicNumber which has not been taken by a thread
+    atomic_uint done;        // Number of MagicNumbers already evaluated
+    _Atomic double bound;    // Smallest maximum error found so far, read without lock for pruning
+    pthread_mutex_t lock;    // Protects minMaxError and minMaxC
+    double minMaxError;
+    uint32_t minMaxC;
+    double start;            // Start time for the progress report
+    double lastReport;
+};
+
+/* Branch and bound: the metric over a subset of the floats is a lower bound of the metric over all floats.
+A MagicNumber is discarded as soon as the metric over every 65536th, 4096th or 64th float already exceeds the best
+value found so far, only the remaining candidates are evaluated on all 2^24 floats. */
+static void search_task(size_t begin, size_t end, void *arg)
+{
+    struct Search *s = arg;
+    const uint32_t strides[] = {65536, 4096, 64, 1};
+
+    for (size_t thread = begin; thread < end; thread++)
+    {
+        uint32_t first;
+        while ((first = atomic_fetch_add(&s->next, SEARCH_BLOCK)) < s->high - s->low)
+        {
+            uint32_t last = first + SEARCH_BLOCK < s->high - s->low ? first + SEARCH_BLOCK : s->high - s->low;
+            for (uint32_t i = first; i < last; i++)
+            {
+                uint32_t c = s->low + i;
+                double error = 0.0;
+                for (size_t level = 0; level < sizeof strides / sizeof *strides; level++)
+                {
+                    double bound = atomic_load_explicit(&s->bound, memory_order_relaxed);
+                    error = s->metric(c, strides[level], bound);
+                    if (error > bound)
+                    {
+                        break;
+                    }
+                }
+
+                pthread_mutex_lock(&s->lock);
+                // Ties are broken by the smaller MagicNumber, so the result does not depend on the number of threads
+                if (error < s->minMaxError || (error == s->minMaxError && c < s->minMaxC))
+                {
+                    s->minMaxError = error;
+                    s->minMaxC = c;
+                    atomic_store(&s->bound, error);
+                }
+                pthread_mutex_unlock(&s->lock);
+            }
+            unsigned done = atomic_fetch_add(&s->done, last - first) + last - first;
+
+            // Thread 0 reports the progress about once per second
+            if (thread == 0 && curtime() - s->lastReport >= 1.0)
+            {
+                s->lastReport = curtime();
+                pthread_mutex_lock(&s->lock);
+                fprintf(stderr, "\rSearched %u of %u MagicNumbers (%5.1f %%), best 0x%x, %.1f s",
+                        done, s->high - s->low, 100.0 * done / (s->high - s->low), s->minMaxC, s->lastReport - s->start);
+                pthread_mutex_unlock(&s->lock);
+            }
+        }
+    }
+}
+
+// Coarse to fine search, used as the starting bound of the exhaustive search
+static uint32_t coarse_magicnumber_flt(double (*metric)(uint32_t c, uint32_t stride, double bound), uint32_t low, uint32_t high, double *error)
+{
+    uint32_t minC = low;          // Lower bound
+    uint32_t maxC = high;         // Upper bound
     uint32_t delta = 0x10000;     // Increment of MagicNumber for each iteration step
-    double maxError;              // Maximum error of each float with a specific MagicNumber
     double minMaxError = DBL_MAX; // Smallest maximum error which the tested values of MagicNumber can give
-    uint32_t minMaxC = 0;             // MagicNumber of the smallest maximum error minMaxError
+    uint32_t minMaxC = 0;         // MagicNumber of the smallest maximum error minMaxError
     while (delta > 0)
     {
         // Test over circa 16*2*5 = 160 values of MagicNumber
         for (uint32_t c = minC; c < maxC; c += delta)
         {
-            maxError = 0.0;
-            // Test over 2^24 values of float numbers
-            for (uint32_t m = 0; m < (1 << 24); m++)
-            {
-                conv.x = 0x3F000000 + m; // x in [0.5, 2) with mantissa m
-                float xhalf = conv.f * 0.5L;
-                double reference = sqrt(conv.f); // True square root
-                conv.x = c - (conv.x >> 1);
-                float y = conv.f;
-                y = y * (1.5F - (xhalf * y * y)); // Newton's iteration
-                double relativeError = fabs(reference * y - 1.0) * 100.0;
-                maxError = relativeError > maxError ? relativeError : maxError;
-            }
+            double maxError = metric(c, 1, minMaxError);
             if (maxError < minMaxError)
             {
                 minMaxError = maxError;
@@ -58,46 +367,237 @@ uint32_t magicnumber_flt(double *error)
     return minMaxC;
 }
 
-// Calculate MagicNumber for Doubles and save its relative error in parameter error
-uint64_t magicnumber_dbl(double *error)
+// Exhaustive search of the MagicNumber in [low, high) minimizing metric, whose minimum is saved in parameter result
+static uint32_t search_flt(double (*metric)(uint32_t c, uint32_t stride, double bound), uint32_t low, uint32_t high, double *result)
+{
+    struct Search s = {
+        .low = low,
+        .high = high,
+        .metric = metric,
+        .lock = PTHREAD_MUTEX_INITIALIZER,
+    };
+    atomic_init(&s.next, 0);
+    atomic_init(&s.done, 0);
+    s.start = s.lastReport = curtime();
+
+    // The coarse to fine result gives a tight bound from the start, so most MagicNumbers are discarded after few floats
+    s.minMaxC = coarse_magicnumber_flt(metric, low, high, &s.minMaxError);
+    atomic_init(&s.bound, s.minMaxError);
+
+    // Every thread of the pool takes blocks of MagicNumbers until the whole interval is searched
+    pool_run(pool_size(), 1, search_task, &s);
+    fprintf(stderr, "\rSearched %u MagicNumbers in %.2f s using %d thread(s)%20s\n", s.high - s.low, curtime() - s.start, pool_size(), "");
+
+    *result = s.minMaxError;
+    return s.minMaxC;
+}
+
+// Calculate MagicNumber for Floats save its relative error in parameter error
+uint32_t magicnumber_flt(double *error)
+{
+    uint32_t c = search_flt(error_metric_flt, MAGIC_LOW, MAGIC_HIGH, error);
+    *error *= 100.0;
+    return c;
+}
+
+// Same as max_error_flt_scalar for doubles, the mantissas m are first, first + stride, ... of the 2^53 doubles in [0.5, 2)
+static double max_error_dbl_scalar(uint64_t c, uint64_t first, uint64_t stride, uint64_t count)
 {
-    // Initialise lower and upper bound based on the calculated MagicNumber for Floats.
-    double sigma = 127 - magicnumber_flt(error) / (1.5 * pow(2, 23));
-    double init_dbl = 1.5 * pow(2, 52) * (1023 - sigma);
     union
     {
         double d;
         uint64_t x;
     } conv;
+    double maxError = 0.0;
+    for (uint64_t k = 0; k < count; k++)
+    {
+        conv.x = 0x3FE0000000000000 + first + k * stride; // x in [0.5, 2) with mantissa m
+        double xhalf = conv.d * 0.5;
+        double reference = sqrt(conv.d); // True square root
+        conv.x = c - (conv.x >> 1);
+        double y = conv.d;
+        y = y * (1.5 - (xhalf * y * y)); // Newton's iteration
+        double relativeError = fabs(reference * y - 1.0);
+        maxError = relativeError > maxError ? relativeError : maxError;
+    }
+    return maxError;
+}
+
+// Same as max_error_dbl_scalar, but 4 doubles are evaluated at once
+__attribute__((target("avx2"))) static double max_error_dbl_avx2(uint64_t c, uint64_t first, uint64_t stride, uint64_t count)
+{
+    const __m256i magicnumber = _mm256_set1_epi64x(c);
+    const __m256i step = _mm256_set1_epi64x(4 * stride);
+    const __m256d half = _mm256_set1_pd(0.5);
+    const __m256d threehalfs = _mm256_set1_pd(1.5);
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d absmask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFF));
+    __m256i xi = _mm256_add_epi64(_mm256_set1_epi64x(0x3FE0000000000000 + first),
+                                  _mm256_setr_epi64x(0, stride, 2 * stride, 3 * stride));
+    __m256d maxError = _mm256_setzero_pd();
+    uint64_t k;
+
+    for (k = 0; k + 4 <= count; k += 4)
+    {
+        __m256d x = _mm256_castsi256_pd(xi);
+        __m256d xhalf = _mm256_mul_pd(x, half);
+        __m256d y = _mm256_castsi256_pd(_mm256_sub_epi64(magicnumber, _mm256_srli_epi64(xi, 1)));
+        y = _mm256_mul_pd(y, _mm256_sub_pd(threehalfs, _mm256_mul_pd(_mm256_mul_pd(xhalf, y), y))); // Newton's iteration
+        __m256d err = _mm256_and_pd(_mm256_sub_pd(_mm256_mul_pd(_mm256_sqrt_pd(x), y), one), absmask);
+        maxError = _mm256_max_pd(maxError, err);
+        xi = _mm256_add_epi64(xi, step);
+    }
+
+    double lanes[4];
+    _mm256_storeu_pd(lanes, maxError);
+    double res = max_error_dbl_scalar(c, first + k * stride, stride, count - k); // Rest with scalar operations
+    for (int i = 0; i < 4; i++)
+    {
+        res = lanes[i] > res ? lanes[i] : res;
+    }
+    return res;
+}
+
+/* Same as range_flt_scalar for doubles, the mantissas m are first, first + stride, ... of the 2^53 doubles in [0.5, 2).
+The doubles are only sampled, so no early exit is needed. */
+static void range_dbl_scalar(uint64_t c, const double k[], int iterations, uint64_t first, uint64_t stride, uint64_t count,
+                             double *tmin, double *tmax)
+{
+    union
+    {
+        double d;
+        uint64_t x;
+    } conv;
+    double lo = DBL_MAX;
+    double hi = 0.0;
+    for (uint64_t j = 0; j < count; j++)
+    {
+        conv.x = 0x3FE0000000000000 + first + j * stride; // x in [0.5, 2) with mantissa m
+        double x = conv.d;
+        double reference = sqrt(x); // True square root
+        conv.x = c - (conv.x >> 1);
+        double y = conv.d;
+        for (int i = 0; i < iterations; i++)
+        {
+            double kx = k[2 * i + 1] * x;
+            y = y * (k[2 * i] - kx * (y * y)); // Tuned Newton's iteration
+        }
+        double t = reference * y;
+        lo = t < lo ? t : lo;
+        hi = t > hi ? t : hi;
+    }
+    *tmin = lo;
+    *tmax = hi;
+}
+
+// Same as range_dbl_scalar, but 4 doubles are evaluated at once
+__attribute__((target("avx2"))) static void range_dbl_avx2(uint64_t c, const double k[], int iterations, uint64_t first, uint64_t stride,
+                                                          uint64_t count, double *tmin, double *tmax)
+{
+    const __m256i magicnumber = _mm256_set1_epi64x(c);
+    const __m256i step = _mm256_set1_epi64x(4 * stride);
+    __m256i xi = _mm256_add_epi64(_mm256_set1_epi64x(0x3FE0000000000000 + first),
+                                  _mm256_setr_epi64x(0, stride, 2 * stride, 3 * stride));
+    __m256d minimum = _mm256_set1_pd(DBL_MAX);
+    __m256d maximum = _mm256_setzero_pd();
+    uint64_t j;
+
+    for (j = 0; j + 4 <= count; j += 4)
+    {
+        __m256d x = _mm256_castsi256_pd(xi);
+        __m256d y = _mm256_castsi256_pd(_mm256_sub_epi64(magicnumber, _mm256_srli_epi64(xi, 1)));
+        for (int i = 0; i < iterations; i++)
+        {
+            __m256d kx = _mm256_mul_pd(_mm256_set1_pd(k[2 * i + 1]), x);
+            y = _mm256_mul_pd(y, _mm256_sub_pd(_mm256_set1_pd(k[2 * i]), _mm256_mul_pd(kx, _mm256_mul_pd(y, y)))); // Tuned Newton's iteration
+        }
+        __m256d t = _mm256_mul_pd(_mm256_sqrt_pd(x), y);
+        minimum = _mm256_min_pd(minimum, t);
+        maximum = _mm256_max_pd(maximum, t);
+        xi = _mm256_add_epi64(xi, step);
+    }
+
+    double lanesMin[4];
+    double lanesMax[4];
+    _mm256_storeu_pd(lanesMin, minimum);
+    _mm256_storeu_pd(lanesMax, maximum);
+    range_dbl_scalar(c, k, iterations, first + j * stride, stride, count - j, tmin, tmax); // Rest with scalar operations
+    for (int i = 0; i < 4; i++)
+    {
+        *tmin = lanesMin[i] < *tmin ? lanesMin[i] : *tmin;
+        *tmax = lanesMax[i] > *tmax ? lanesMax[i] : *tmax;
+    }
+}
+
+static void range_dbl(uint64_t c, const double k[], int iterations, double *tmin, double *tmax)
+{
+    if (cpu_supports(CPU_AVX2))
+    {
+        range_dbl_avx2(c, k, iterations, 0, DBL_STRIDE, 2 * DBL_MANTISSA / DBL_STRIDE, tmin, tmax);
+    }
+    else
+    {
+        range_dbl_scalar(c, k, iterations, 0, DBL_STRIDE, 2 * DBL_MANTISSA / DBL_STRIDE, tmin, tmax);
+    }
+}
+
+// Metrics which are minimized by the search for doubles, see error_metric_flt and ratio_metric_flt
+static double error_metric_dbl(uint64_t c)
+{
+    return cpu_supports(CPU_AVX2) ? max_error_dbl_avx2(c, 0, DBL_STRIDE, 2 * DBL_MANTISSA / DBL_STRIDE)
+                                  : max_error_dbl_scalar(c, 0, DBL_STRIDE, 2 * DBL_MANTISSA / DBL_STRIDE);
+}
+
+static double ratio_metric_dbl(uint64_t c)
+{
+    double tmin;
+    double tmax;
+    range_dbl(c, NULL, 0, &tmin, &tmax);
+    return tmax / tmin;
+}
+
+// Arguments of dbl_task: evaluates the MagicNumbers minC, minC + delta, ... and stores their metrics
+struct DblLevel
+{
+    double (*metric)(uint64_t c);
+    uint64_t minC;
+    uint64_t delta;
+    double *errors;
+};
+
+static void dbl_task(size_t begin, size_t end, void *arg)
+{
+    struct DblLevel *l = arg;
+    for (size_t i = begin; i < end; i++)
+    {
+        l->errors[i] = l->metric(l->minC + i * l->delta);
+    }
+}
+
+// Coarse to fine search of the MagicNumber for Doubles around the one for Floats c minimizing metric, whose minimum is saved in parameter result
+static uint64_t search_dbl(double (*metric)(uint64_t c), uint32_t c, double *result)
+{
+    // Initialise lower and upper bound based on the calculated MagicNumber for Floats.
+    double sigma = 127 - c / (1.5 * pow(2, 23));
+    double init_dbl = 1.5 * pow(2, 52) * (1023 - sigma);
     uint64_t minC = ((uint64_t)init_dbl) - (1llu << 32); // Lower bound
     uint64_t maxC = minC + (1llu << 32);                 // Upper bound
     uint64_t delta = 1llu << 28;                         // 2^28, Increment of MagicNumber for each iteration step
-    const uint64_t mantissa = 1llu << 52;                // 2^52
-    double maxError;                                     // Maximum error of each float with a specific MagicNumber
-    double minMaxError = DBL_MAX;                        // Smallest maximum error which the tested values of MagicNumber can give
-    uint64_t minMaxC = 0;                                    // MagicNumber of the smallest maximum error minMaxError
+    double minMaxError = DBL_MAX;                        // Smallest metric which the tested values of MagicNumber can give
+    uint64_t minMaxC = 0;                                // MagicNumber of the smallest metric minMaxError
+    double errors[32];                                   // Metrics of the MagicNumbers of one step, at most 2 * 16
     while (delta > 0)
     {
-        // Test over circa 16*2*8 = 256 values of MagicNumber
-        for (uint64_t c = minC; c < maxC; c += delta)
+        // Test over circa 16*2*8 = 256 values of MagicNumber, the values of one step are evaluated in parallel
+        struct DblLevel level = {metric, minC, delta, errors};
+        size_t count = (maxC - minC + delta - 1) / delta;
+        pool_run(count, 1, dbl_task, &level);
+        for (size_t i = 0; i < count; i++)
         {
-            maxError = 0.0;
-            // Test over 2^25 values of float numbers
-            for (uint64_t m = 0; m < mantissa * 2; m += 1llu << 28)
-            {                                  // m += 2^28
-                conv.x = 0x3FE * mantissa + m; // x in [0.5, 2) with mantissa m
-                double xhalf = conv.d * 0.5;
-                double reference = sqrt(conv.d); // True square root
-                conv.x = c - (conv.x >> 1);
-                double y = conv.d;
-                y = y * (1.5 - (xhalf * y * y)); // Newton's iteration
-                double relativeError = fabs(reference * y - 1.0) * 100.0;
-                maxError = relativeError > maxError ? relativeError : maxError;
-            }
-            if (maxError < minMaxError)
+            if (errors[i] < minMaxError)
             {
-                minMaxError = maxError;
-                minMaxC = c;
+                minMaxError = errors[i];
+                minMaxC = minC + i * delta;
             }
         }
         // Update lower and upper bound. Update delta.
@@ -105,14 +605,132 @@ uint64_t magicnumber_dbl(double *error)
         maxC = minMaxC + delta;
         delta = delta >> 4;
     }
-    *error = minMaxError;
+    *result = minMaxError;
     return minMaxC;
 }
 
+// Calculate MagicNumber for Doubles and save its relative error in parameter error
+uint64_t magicnumber_dbl(double *error)
+{
+    uint64_t c = search_dbl(error_metric_dbl, magicnumber_flt(error), error);
+    *error *= 100.0;
+    return c;
+}
+
+// Description of a 16-bit floating point format for the MagicNumber search
+struct Format16
+{
+    const char *name;
+    uint16_t half;              // Bit pattern of 0.5
+    uint32_t count;             // Number of values in [0.5, 2), every one is tested
+    float (*to_float)(uint16_t); // Exact conversion of a positive normal value to float
+};
+
+// IEEE 754 binary16: 5 exponent bits with bias 15 and 10 mantissa bits, rebiased to the float exponent
+static float half_to_float(uint16_t h)
+{
+    union
+    {
+        float f;
+        uint32_t x;
+    } conv = {.x = ((uint32_t)h << 13) + ((127 - 15) << 23)};
+    return conv.f;
+}
+
+// bfloat16 is the upper half of a float
+static float bfloat16_to_float(uint16_t h)
+{
+    union
+    {
+        float f;
+        uint32_t x;
+    } conv = {.x = (uint32_t)h << 16};
+    return conv.f;
+}
+
+static const struct Format16 formats16[] = {
+    {"Half", 0x3800, 1u << 11, half_to_float},
+    {"Bfloat16", 0x3F00, 1u << 8, bfloat16_to_float},
+};
+
+/* Return the maximum of |sqrt(x) * y - 1| over all x in [0.5, 2) of the 16-bit format, where the seed c - (x >> 1) is computed
+on the 16-bit patterns and widened to float for one Newton iteration in float arithmetic like in fastInvSqrt_f16/bf16 */
+static double max_error_16(const struct Format16 *format, uint16_t c)
+{
+    double maxError = 0.0;
+    for (uint32_t k = 0; k < format->count; k++)
+    {
+        uint16_t h = format->half + k;
+        float x = format->to_float(h);
+        float xhalf = x * 0.5f;
+        float y = format->to_float(c - (h >> 1));
+        y = y * (1.5f - (xhalf * y * y)); // Newton's iteration
+        double relativeError = fabs(sqrt(x) * y - 1.0);
+        maxError = relativeError > maxError ? relativeError : maxError;
+    }
+    return maxError;
+}
+
+/* Coefficients k1, k2 of y * (k1 - k2 * x * y * y) with the smallest maximum relative error, if sqrt(x) * y is in [tmin, tmax].
+t * (k1 - k2 * t^2) has its maximum at t* = sqrt(k1 / (3 * k2)), the error equioscillates at tmin, t* and tmax. */
+static void newton_coefficients(double tmin, double tmax, double *k1, double *k2)
+{
+    double s = tmin * tmin + tmin * tmax + tmax * tmax; // k1 / k2, so that tmin and tmax give the same value
+    double t = sqrt(s / 3.0);
+    *k2 = 2.0 / (2.0 / 3.0 * s * t + tmin * (s - tmin * tmin));
+    *k1 = s * *k2;
+}
+
+// Jointly tune MagicNumber and Newton coefficients for floats
+static void tune_flt(struct Tuning *tuning)
+{
+    double ratio;
+    double tmin;
+    double tmax;
+    double k1;
+    double k2;
+    float k[4];
+
+    tuning->c = coarse_magicnumber_flt(ratio_metric_flt, MAGIC_LOW - MAGIC_PERIOD / 2, MAGIC_LOW + MAGIC_PERIOD / 2, &ratio);
+    for (int i = 0; i < 2; i++)
+    {
+        // Range of the previous approximation in float arithmetic gives the coefficients of the next iteration
+        range_flt(tuning->c, k, i, 1, DBL_MAX, &tmin, &tmax);
+        newton_coefficients(tmin, tmax, &k1, &k2);
+        k[2 * i] = k1;
+        k[2 * i + 1] = k2;
+        range_flt(tuning->c, k, i + 1, 1, DBL_MAX, &tmin, &tmax);
+        tuning->k[2 * i] = k[2 * i];
+        tuning->k[2 * i + 1] = k[2 * i + 1];
+        tuning->error[i] = fmax(1.0 - tmin, tmax - 1.0) * 100.0;
+    }
+}
+
+// Jointly tune MagicNumber and Newton coefficients for doubles
+static void tune_dbl(struct Tuning *tuning)
+{
+    double ratio;
+    double tmin;
+    double tmax;
+    double k[4];
+
+    tuning->c = search_dbl(ratio_metric_dbl, coarse_magicnumber_flt(ratio_metric_flt, MAGIC_LOW - MAGIC_PERIOD / 2, MAGIC_LOW + MAGIC_PERIOD / 2, &ratio), &ratio);
+    for (int i = 0; i < 2; i++)
+    {
+        range_dbl(tuning->c, k, i, &tmin, &tmax);
+        newton_coefficients(tmin, tmax, &k[2 * i], &k[2 * i + 1]);
+        range_dbl(tuning->c, k, i + 1, &tmin, &tmax);
+        tuning->k[2 * i] = k[2 * i];
+        tuning->k[2 * i + 1] = k[2 * i + 1];
+        tuning->error[i] = fmax(1.0 - tmin, tmax - 1.0) * 100.0;
+    }
+}
+
 // Print out the MagicNumber corresponding to the given type float/double
 void print_magicnumber(int db)
 {
     double error;
+    double start = curtime();
     if (!db)
     {
         printf("MagicNumber for Floats: 0x%x\n", magicnumber_flt(&error));
@@ -122,4 +740,51 @@ void print_magicnumber(int db)
         printf("MagicNumber for Doubles: 0x%lx\n", magicnumber_dbl(&error));
     }
     printf("With Maximum Error: %.10f\n", error);
+    printf("Total time: %.2f s\n", curtime() - start);
+}
+
+// Print out the tuned MagicNumber and Newton coefficients for float/double as defines for inverse_sqrt.h
+void print_tuning(int db)
+{
+    struct Tuning tuning;
+    double start = curtime();
+    const char *type = db ? "DBL" : "FLT";
+    const char *suffix = db ? "" : "f";
+    if (!db)
+    {
+        tune_flt(&tuning);
+    }
+    else
+    {
+        tune_dbl(&tuning);
+    }
+    printf("Maximum Error with 1 tuned Newton iteration: %.10f\n", tuning.error[0]);
+    printf("Maximum Error with 2 tuned Newton iterations: %.10f\n", tuning.error[1]);
+    printf("#define TUNED_MAGIC_%s 0x%" PRIX64 "\n", type, tuning.c);
+    for (int i = 0; i < 4; i++)
+    {
+        printf("#define TUNED_K%d_%s %.17g%s\n", i + 1, type, tuning.k[i], suffix);
+    }
+    printf("Total time: %.2f s\n", curtime() - start);
+}
+
+// Print out the MagicNumber of half precision (bf = 0) or bfloat16 (bf = 1), all 16-bit MagicNumbers of the interval are tested
+void print_magicnumber16(int bf)
+{
+    const struct Format16 *format = &formats16[bf];
+    double minMaxError = DBL_MAX;
+    uint16_t minMaxC = 0;
+    double start = curtime();
+    for (uint32_t c = MAGIC16_LOW; c < MAGIC16_HIGH; c++)
+    {
+        double maxError = max_error_16(format, c);
+        if (maxError < minMaxError)
+        {
+            minMaxError = maxError;
+            minMaxC = c;
+        }
+    }
+    printf("MagicNumber for %s: 0x%x\n", format->name, minMaxC);
+    printf("With Maximum Error: %.10f\n", minMaxError * 100.0);
+    printf("Total time: %.2f s\n", curtime() - start);
 }
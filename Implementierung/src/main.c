@@ -8,11 +8,32 @@
 #include <stdbool.h>
 #include <getopt.h> // use this library for getopt_long instead of <unistd.h> which is used for getopt
 #include <errno.h>
+#include <string.h>
 
 #include "../include/inverse_sqrt.h"
 #include "../include/magicnumber.h"
 #include "../include/parser.h"
 #include "../include/tests.h"
+#include "../include/threadpool.h"
+#include "../include/stream.h"
+#include "../include/format.h"
+#include "../include/binio.h"
+
+// Return 0 for "float" and 1 for "double", the value of db for the type given with --input-type or --output-type
+static int parse_type(const char *name)
+{
+    if (!strcmp(name, "float"))
+    {
+        return 0;
+    }
+    if (!strcmp(name, "double"))
+    {
+        return 1;
+    }
+    fprintf(stderr, "Type %s is neither float nor double\n", name);
+    exit_failure();
+    return -1;
+}
 
 int main(int argc, char *argv[])
 {
@@ -22,21 +43,40 @@ int main(int argc, char *argv[])
     }
 
     // Define and initialise standard values
-    char *version_name = "0"; // Basic version
-    int db = 0;               // db = 1 if option -d is set, otherwise 0
-    int b = 0;                // b = 1 if option -B is set, otherwise 0
-    int m = 0;                // m = 1 if option -m is set, otherwise 0
-    long loop = 1;            // Number of loop iterations to measure runtime if option -B is set
-    void *vals;               // Input array
-    size_t n;                 // Size of the input array
+    const char *version_name = "auto"; // Fastest version supported by the CPU
+    int db = 0;                   // db = 1 if option -d is set, otherwise 0
+    int b = 0;                    // b = 1 if option -B is set, otherwise 0
+    int m = 0;                    // m = 1 if option -m is set, otherwise 0
+    int tune = 0;                 // tune = 1 if option --tune is set, otherwise 0
+    int magic16 = -1;             // 0 for half precision, 1 for bfloat16 if option --magic16 is set, otherwise -1
+    long loop = 1;                // Number of loop iterations to measure runtime if option -B is set
+    long threads = 1;             // Number of threads if option -j is set
+    int stream = 0;               // stream = 1 if option --stream is set, otherwise 0
+    int format = FORMAT_FIXED;    // FORMAT_SHORTEST if option --shortest is set
+    int echo = 1;                 // echo = 0 if option --no-echo is set, otherwise 1
+    char *out_path = NULL;        // Path of the binary output file if option -o is set
+    double max_error = 0;         // Maximum relative error if option --max-rel-err is set, otherwise 0
+    int out_type = -1;            // db of the results if option --output-type is set, otherwise -1 for the input type
+    struct BinFile in_file = {0}; // Mapped input file, in_file.base != NULL if the input is a binary file
+    void *vals;                   // Input array
+    size_t n;                     // Size of the input array
 
     struct option long_options[] = {
-        // Define long option --help
+        // Define long options
         {"help", no_argument, 0, 'h'},
+        {"stream", no_argument, 0, 'S'},
+        {"shortest", no_argument, 0, 'F'},
+        {"no-echo", no_argument, 0, 'E'},
+        {"tune", no_argument, 0, 'U'},
+        {"max-rel-err", required_argument, 0, 'R'},
+        {"magic16", required_argument, 0, 'G'},
+        {"input-type", required_argument, 0, 'I'},
+        {"output-type", required_argument, 0, 'O'},
+        {0, 0, 0, 0},
     };
 
     int c;
-    while ((c = getopt_long(argc, argv, "V:B::dmht", long_options, NULL)) != -1)
+    while ((c = getopt_long(argc, argv, "V:B::j:o:dmht", long_options, NULL)) != -1)
     {
         switch (c)
         {
@@ -69,12 +109,89 @@ int main(int argc, char *argv[])
                 }
             }
             break;
+        case 'j': // Number of threads for the calculation
+        {
+            char *endptr;
+            errno = 0;
+            threads = strtol(optarg, &endptr, 10);
+            if (endptr == optarg || *endptr != '\0')
+            {
+                fprintf(stderr, "%s could not be converted to long\n", optarg);
+                exit_failure();
+            }
+            else if (errno == ERANGE || threads > 4096)
+            {
+                fprintf(stderr, "Number of threads %s is too large\n", optarg);
+                exit_failure();
+            }
+            else if (threads <= 0)
+            {
+                fprintf(stderr, "Number of threads %ld is not greater than 0\n", threads);
+                exit_failure();
+            }
+            break;
+        }
+        case 'R': // Choose the cheapest version meeting a maximum relative error
+        {
+            char *endptr;
+            errno = 0;
+            max_error = strtod(optarg, &endptr);
+            if (endptr == optarg || *endptr != '\0' || errno == ERANGE)
+            {
+                fprintf(stderr, "%s could not be converted to double\n", optarg);
+                exit_failure();
+            }
+            else if (!(max_error > 0))
+            {
+                fprintf(stderr, "Maximum relative error %s is not greater than 0\n", optarg);
+                exit_failure();
+            }
+            break;
+        }
+        case 'o': // Write the results to a binary file
+            out_path = optarg;
+            break;
         case 'd': // Interpret input values as double
             db = 1;
             break;
+        case 'I': // Type of the input values, like -d for double
+            db = parse_type(optarg);
+            break;
+        case 'O': // Type of the results, the input type if not given
+            out_type = parse_type(optarg);
+            break;
+        case 'S': // Process the input file block-wise
+            stream = 1;
+            break;
+        case 'F': // Print the shortest round-trip representation
+            format = FORMAT_SHORTEST;
+            break;
+        case 'E': // Do not print the input values
+            echo = 0;
+            break;
         case 'm': // Calculate and print magic number
             m = 1;
             break;
+        case 'U': // Tune magic number and Newton coefficients together, implies -m
+            m = 1;
+            tune = 1;
+            break;
+        case 'G': // Calculate the magic number of a 16-bit format, implies -m
+            if (!strcmp(optarg, "half"))
+            {
+                magic16 = 0;
+            }
+            else if (!strcmp(optarg, "bfloat16"))
+            {
+                magic16 = 1;
+            }
+            else
+            {
+                fprintf(stderr, "Format %s is neither half nor bfloat16\n", optarg);
+                exit_failure();
+            }
+            m = 1;
+            break;
         case 'h': // Show help message and exit
             print_help();
             return EXIT_SUCCESS;
@@ -89,14 +206,58 @@ int main(int argc, char *argv[])
         }
     }
 
-    // If option -m is set, print out the calculated magic number corresponding to type float/double and terminate the program.
-    // Options other than -m and -d are ignored.
+    // Start the worker pool before reading the input, so the input pages are first-touched by the threads using them
+    if (pool_init(threads))
+    {
+        fprintf(stderr, "Continuing with a single thread\n");
+    }
+
+    // If option -m, --tune or --magic16 is set, print out the calculated magic number corresponding to type float/double and terminate the program.
+    // Options other than -m, -d and -j are ignored.
     if (m)
     {
-        print_magicnumber(db);
+        if (magic16 >= 0)
+        {
+            print_magicnumber16(magic16);
+        }
+        else if (tune)
+        {
+            print_tuning(db);
+        }
+        else
+        {
+            print_magicnumber(db);
+        }
+        pool_destroy();
         return EXIT_SUCCESS;
     }
 
+    // The header of a binary input file determines the type float/double, it has to be read before the version is selected.
+    // A single positional argument starting with a number is interpreted as a number, not as a filename (see below).
+    int bin_db = -1;
+    if (optind == argc - 1 && !stream && strcmp(argv[optind], "-"))
+    {
+        char *endptr;
+        strtol(argv[optind], &endptr, 10);
+        if (endptr == argv[optind])
+            bin_db = bin_type(argv[optind]);
+    }
+    if (bin_db >= 0)
+        db = bin_db;
+
+    // The version is selected after all options are parsed, since it depends on -d and the type of a binary input file
+    if (max_error > 0)
+    {
+        if (strcmp(version_name, "auto"))
+        {
+            fprintf(stderr, "Options -V and --max-rel-err cannot be combined\n");
+            exit_failure();
+        }
+        version_name = select_version(db, max_error);
+    }
+    // The input has to be positive unless the version handles 0, inf, negative values and NaN itself
+    int positive = !version_special(db, version_name);
+
     // Positional argument is either an arbitrary amount of floating point numbers or a file name, in which floating point numbers are given.
     // Positional argument muss be given in terminal.
     if (optind == argc)
@@ -107,6 +268,39 @@ int main(int argc, char *argv[])
 
     if (optind == argc - 1)
     {
+        // A single "-" reads the numbers from stdin. Like --stream for files, the input is then processed block-wise with bounded memory.
+        if (stream || !strcmp(argv[optind], "-"))
+        {
+            if (out_path)
+            {
+                fprintf(stderr, "Option -o is not supported for streamed input\n");
+                exit_failure();
+            }
+            if (out_type >= 0 && out_type != db)
+            {
+                fprintf(stderr, "Different input and output types are not supported for streamed input\n");
+                exit_failure();
+            }
+            FILE *in = strcmp(argv[optind], "-") ? fopen(argv[optind], "r") : stdin;
+            if (!in)
+            {
+                perror("Error opening file");
+                exit_failure();
+            }
+            double time_stream;
+            int status = executeStream(db, version_name, in, format, &time_stream);
+            if (in != stdin)
+            {
+                fclose(in);
+            }
+            if (b && !status)
+            { // Print out the measured runtime if option -B is set, loop iterations are not supported for streams
+                printf("Runtime: %f\n", time_stream);
+            }
+            pool_destroy();
+            return status ? EXIT_FAILURE : EXIT_SUCCESS;
+        }
+
         // There is only one positional argument, which could either be a single number or a filename.
         // The filename may not start with a number. If this is the case, we interpret the argument as a number and jump to the command line "terminal".
         // Otherwise, we consider the argument as a filename.
@@ -115,11 +309,18 @@ int main(int argc, char *argv[])
         if (endptr != argv[optind])
             goto terminal; // Check whether the filename starts with a number
 
-        n = sizeReadFile(argv[optind]); // Count the total number of lines in the given file and allocate this to the size of input array n.
-        if (!n)
-            exit_failure();
+        // Binary files are mapped and used in place, their header determines the type float/double
+        if (bin_db >= 0)
+        {
+            if (bin_open(argv[optind], &in_file, positive))
+                exit_failure();
+            vals = in_file.data;
+            n = in_file.n;
+            db = in_file.db;
+            goto execute;
+        }
 
-        vals = readFile(db, n, argv[optind]); // Allocate floating point numbers read from the given file to the input array
+        vals = readFile(db, &n, argv[optind], positive); // Allocate floating point numbers read from the given file to the input array and their amount to n
         if (!vals)
             exit_failure();
 
@@ -129,18 +330,46 @@ int main(int argc, char *argv[])
 // Positional arguments are interpreted as floating point numbers here.
 terminal:
     n = argc - optind;                   // Allocate the amount of positional arguments to the size of input array n.
-    vals = readTerminal(db, argc, argv); // Allocate floating point numbers read directly from terminal to the input array
+    vals = readTerminal(db, argc, argv, positive); // Allocate floating point numbers read directly from terminal to the input array
 
 // Calculate the inverse square root based on selected options and measure runtime
 execute:
-    double time2 = execute(db, version_name, n, vals, loop);
+    double time2;
+    // With different input and output types the mixed-type kernels are used, there is only one of each
+    int convert = out_type >= 0 && out_type != db;
+    if (convert && strcmp(version_name, "auto"))
+    {
+        fprintf(stderr, "Options -V and --max-rel-err are not supported for different input and output types\n");
+        exit_failure();
+    }
+    if (out_path)
+    { // Write the results directly into the mapped output file instead of printing them
+        struct BinFile out_file;
+        if (bin_create(out_path, convert ? out_type : db, n, &out_file))
+            exit_failure();
+        time2 = convert ? computeConvert(db, n, vals, out_file.data, loop) : compute(db, version_name, n, vals, out_file.data, loop);
+        bin_close(&out_file);
+    }
+    else if (convert)
+    {
+        time2 = executeConvert(db, n, vals, loop, format, echo);
+    }
+    else
+    {
+        time2 = execute(db, version_name, n, vals, loop, format, echo);
+    }
 
     if (b)
     { // Print out the measured runtime if option -B is set
         printf("Runtime in %ld loops: %f\n", loop, time2);
     }
 
-    free(vals); // Release memory space allocated to input array
+    // Release memory space allocated to input array
+    if (in_file.base)
+        bin_close(&in_file);
+    else
+        free(vals);
+    pool_destroy();
 
     return EXIT_SUCCESS;
 }
\ No newline at end of file
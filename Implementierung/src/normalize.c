@@ -0,0 +1,442 @@
+/** @file normalize.c
+ *  @brief Implementation of the fused normalization of 3D vectors and matrix rows
+ *  @details For details of each function see normalize.h
+ *  @author Yll Kryeziu (ge94noh)
+ */
+
+#include <string.h>
+#include <immintrin.h>
+#include "../include/normalize.h"
+#include "../include/inverse_sqrt_inline.h"
+#include "../include/cpufeatures.h"
+#include "../include/threadpool.h"
+
+/* 1/sqrt of the squared lengths with 1 or 2 Newton iterations, newton is a constant after inlining.
+In the second iteration xhalf * y is computed first: for a zero vector y is huge after the first iteration
+and y * y would overflow to inf, so that 0 * inf would give NaN instead of 0 */
+static inline __m128 scale_ps(__m128 len2, int newton)
+{
+    __m128 y = fastInvSqrt4_flt(len2);
+    if (newton == 2)
+    {
+        __m128 xhalf = _mm_mul_ps(len2, _mm_set1_ps(0.5f));
+        y = _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_mul_ps(xhalf, y), y)));
+    }
+    return y;
+}
+
+static inline __m128d scale_pd(__m128d len2, int newton)
+{
+    __m128d y = fastInvSqrt2_dbl(len2);
+    if (newton == 2)
+    {
+        __m128d xhalf = _mm_mul_pd(len2, _mm_set1_pd(0.5));
+        y = _mm_mul_pd(y, _mm_sub_pd(_mm_set1_pd(1.5), _mm_mul_pd(_mm_mul_pd(xhalf, y), y)));
+    }
+    return y;
+}
+
+/* Normalize 4 interleaved vectors a = (x0 y0 z0 x1), b = (y1 z1 x2 y2), c = (z2 x3 y3 z3).
+The squares are regrouped into the x, y and z parts of the 4 vectors and added in the order
+x*x + y*y + z*z, then the factors are broadcast back: (s0 s0 s0 s1), (s1 s1 s2 s2), (s2 s3 s3 s3) */
+static inline void aos4_ps(const float *vals, float *out, int newton)
+{
+    __m128 a = _mm_loadu_ps(&vals[0]);
+    __m128 b = _mm_loadu_ps(&vals[4]);
+    __m128 c = _mm_loadu_ps(&vals[8]);
+    __m128 aa = _mm_mul_ps(a, a);
+    __m128 bb = _mm_mul_ps(b, b);
+    __m128 cc = _mm_mul_ps(c, c);
+
+    // xx = (aa0 aa3 bb2 cc1), yy = (aa1 bb0 bb3 cc2), zz = (aa2 bb1 cc0 cc3)
+    __m128 xx = _mm_shuffle_ps(aa, _mm_shuffle_ps(bb, cc, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+    __m128 yy = _mm_shuffle_ps(_mm_shuffle_ps(aa, bb, _MM_SHUFFLE(3, 0, 2, 1)), _mm_shuffle_ps(bb, cc, _MM_SHUFFLE(2, 2, 3, 3)),
+                               _MM_SHUFFLE(2, 0, 2, 0));
+    __m128 zz = _mm_shuffle_ps(_mm_shuffle_ps(aa, bb, _MM_SHUFFLE(1, 1, 2, 2)), cc, _MM_SHUFFLE(3, 0, 2, 0));
+    __m128 s = scale_ps(_mm_add_ps(_mm_add_ps(xx, yy), zz), newton);
+
+    _mm_storeu_ps(&out[0], _mm_mul_ps(a, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 0, 0, 0))));
+    _mm_storeu_ps(&out[4], _mm_mul_ps(b, _mm_shuffle_ps(s, s, _MM_SHUFFLE(2, 2, 1, 1))));
+    _mm_storeu_ps(&out[8], _mm_mul_ps(c, _mm_shuffle_ps(s, s, _MM_SHUFFLE(3, 3, 3, 2))));
+}
+
+/* The last n % 4 vectors are copied into a zero-padded buffer and normalized with the same SIMD step,
+so every vector gets the same result regardless of its position. Zero vectors stay zero. */
+static inline void aos_flt(size_t n, const float *vals, float *out, int newton)
+{
+    size_t j;
+    for (j = 0; j + 4 <= n; j += 4)
+    {
+        aos4_ps(&vals[3 * j], &out[3 * j], newton);
+    }
+    if (j < n)
+    {
+        float buf[12] = {0};
+        memcpy(buf, &vals[3 * j], 3 * (n - j) * sizeof(float));
+        aos4_ps(buf, buf, newton);
+        memcpy(&out[3 * j], buf, 3 * (n - j) * sizeof(float));
+    }
+}
+
+static inline void soa4_ps(const float *x, const float *y, const float *z, float *outX, float *outY, float *outZ, int newton)
+{
+    __m128 vx = _mm_loadu_ps(x);
+    __m128 vy = _mm_loadu_ps(y);
+    __m128 vz = _mm_loadu_ps(z);
+    __m128 s = scale_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz)), newton);
+    _mm_storeu_ps(outX, _mm_mul_ps(vx, s));
+    _mm_storeu_ps(outY, _mm_mul_ps(vy, s));
+    _mm_storeu_ps(outZ, _mm_mul_ps(vz, s));
+}
+
+static inline void soa_flt(size_t n, const float *x, const float *y, const float *z, float *outX, float *outY, float *outZ, int newton)
+{
+    size_t j;
+    for (j = 0; j + 4 <= n; j += 4)
+    {
+        soa4_ps(&x[j], &y[j], &z[j], &outX[j], &outY[j], &outZ[j], newton);
+    }
+    if (j < n)
+    {
+        float buf[3][4] = {{0}};
+        memcpy(buf[0], &x[j], (n - j) * sizeof(float));
+        memcpy(buf[1], &y[j], (n - j) * sizeof(float));
+        memcpy(buf[2], &z[j], (n - j) * sizeof(float));
+        soa4_ps(buf[0], buf[1], buf[2], buf[0], buf[1], buf[2], newton);
+        memcpy(&outX[j], buf[0], (n - j) * sizeof(float));
+        memcpy(&outY[j], buf[1], (n - j) * sizeof(float));
+        memcpy(&outZ[j], buf[2], (n - j) * sizeof(float));
+    }
+}
+
+// Normalize 2 interleaved vectors a = (x0 y0), b = (z0 x1), c = (y1 z1), the factors are broadcast as (s0 s0), (s0 s1), (s1 s1)
+static inline void aos2_pd(const double *vals, double *out, int newton)
+{
+    __m128d a = _mm_loadu_pd(&vals[0]);
+    __m128d b = _mm_loadu_pd(&vals[2]);
+    __m128d c = _mm_loadu_pd(&vals[4]);
+    __m128d aa = _mm_mul_pd(a, a);
+    __m128d bb = _mm_mul_pd(b, b);
+    __m128d cc = _mm_mul_pd(c, c);
+
+    __m128d xx = _mm_shuffle_pd(aa, bb, 2); // (aa0 bb1)
+    __m128d yy = _mm_shuffle_pd(aa, cc, 1); // (aa1 cc0)
+    __m128d zz = _mm_shuffle_pd(bb, cc, 2); // (bb0 cc1)
+    __m128d s = scale_pd(_mm_add_pd(_mm_add_pd(xx, yy), zz), newton);
+
+    _mm_storeu_pd(&out[0], _mm_mul_pd(a, _mm_unpacklo_pd(s, s)));
+    _mm_storeu_pd(&out[2], _mm_mul_pd(b, s));
+    _mm_storeu_pd(&out[4], _mm_mul_pd(c, _mm_unpackhi_pd(s, s)));
+}
+
+static inline void aos_dbl(size_t n, const double *vals, double *out, int newton)
+{
+    size_t j;
+    for (j = 0; j + 2 <= n; j += 2)
+    {
+        aos2_pd(&vals[3 * j], &out[3 * j], newton);
+    }
+    if (j < n)
+    {
+        double buf[6] = {0};
+        memcpy(buf, &vals[3 * j], 3 * sizeof(double));
+        aos2_pd(buf, buf, newton);
+        memcpy(&out[3 * j], buf, 3 * sizeof(double));
+    }
+}
+
+static inline void soa2_pd(const double *x, const double *y, const double *z, double *outX, double *outY, double *outZ, int newton)
+{
+    __m128d vx = _mm_loadu_pd(x);
+    __m128d vy = _mm_loadu_pd(y);
+    __m128d vz = _mm_loadu_pd(z);
+    __m128d s = scale_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(vx, vx), _mm_mul_pd(vy, vy)), _mm_mul_pd(vz, vz)), newton);
+    _mm_storeu_pd(outX, _mm_mul_pd(vx, s));
+    _mm_storeu_pd(outY, _mm_mul_pd(vy, s));
+    _mm_storeu_pd(outZ, _mm_mul_pd(vz, s));
+}
+
+static inline void soa_dbl(size_t n, const double *x, const double *y, const double *z, double *outX, double *outY, double *outZ, int newton)
+{
+    size_t j;
+    for (j = 0; j + 2 <= n; j += 2)
+    {
+        soa2_pd(&x[j], &y[j], &z[j], &outX[j], &outY[j], &outZ[j], newton);
+    }
+    if (j < n)
+    {
+        double buf[3][2] = {{x[j], 0.0}, {y[j], 0.0}, {z[j], 0.0}};
+        soa2_pd(buf[0], buf[1], buf[2], buf[0], buf[1], buf[2], newton);
+        outX[j] = buf[0][0];
+        outY[j] = buf[1][0];
+        outZ[j] = buf[2][0];
+    }
+}
+
+void normalizeAoS_flt(size_t n, const float *vals, float *out)
+{
+    aos_flt(n, vals, out, 1);
+}
+
+void normalizeAoS_flt_DoubleNewton(size_t n, const float *vals, float *out)
+{
+    aos_flt(n, vals, out, 2);
+}
+
+void normalizeSoA_flt(size_t n, const float *x, const float *y, const float *z, float *outX, float *outY, float *outZ)
+{
+    soa_flt(n, x, y, z, outX, outY, outZ, 1);
+}
+
+void normalizeSoA_flt_DoubleNewton(size_t n, const float *x, const float *y, const float *z, float *outX, float *outY, float *outZ)
+{
+    soa_flt(n, x, y, z, outX, outY, outZ, 2);
+}
+
+void normalizeAoS_dbl(size_t n, const double *vals, double *out)
+{
+    aos_dbl(n, vals, out, 1);
+}
+
+void normalizeAoS_dbl_DoubleNewton(size_t n, const double *vals, double *out)
+{
+    aos_dbl(n, vals, out, 2);
+}
+
+void normalizeSoA_dbl(size_t n, const double *x, const double *y, const double *z, double *outX, double *outY, double *outZ)
+{
+    soa_dbl(n, x, y, z, outX, outY, outZ, 1);
+}
+
+void normalizeSoA_dbl_DoubleNewton(size_t n, const double *x, const double *y, const double *z, double *outX, double *outY, double *outZ)
+{
+    soa_dbl(n, x, y, z, outX, outY, outZ, 2);
+}
+
+// Matrix and options of normalizeRows, passed to the tasks of the pool
+struct Rows
+{
+    size_t cols;
+    size_t stride;
+    void *matrix;
+    int newton;
+    int avx2; // 1 if AVX2 and FMA are used for the reduction and scaling
+};
+
+/* The squared norm of a row is reduced with 4 independent accumulators, so that the latency of the additions
+is hidden, and the partial sums are added in a fixed order. The factor is computed with scale_ps/scale_pd
+on a single lane, so rows of zeros stay zero as for the 3D vectors. */
+static void rows_flt_sse(size_t begin, size_t end, const struct Rows *job)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        float *row = (float *)job->matrix + i * job->stride;
+        __m128 acc[4] = {_mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps()};
+        size_t j;
+        for (j = 0; j + 16 <= job->cols; j += 16)
+        {
+            for (int k = 0; k < 4; k++)
+            {
+                __m128 v = _mm_loadu_ps(&row[j + 4 * k]);
+                acc[k] = _mm_add_ps(acc[k], _mm_mul_ps(v, v));
+            }
+        }
+        for (; j + 4 <= job->cols; j += 4)
+        {
+            __m128 v = _mm_loadu_ps(&row[j]);
+            acc[0] = _mm_add_ps(acc[0], _mm_mul_ps(v, v));
+        }
+        __m128 sum = _mm_add_ps(_mm_add_ps(acc[0], acc[1]), _mm_add_ps(acc[2], acc[3]));
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+        for (; j < job->cols; j++)
+        {
+            sum = _mm_add_ss(sum, _mm_set_ss(row[j] * row[j]));
+        }
+
+        __m128 s = scale_ps(sum, job->newton);
+        s = _mm_shuffle_ps(s, s, 0);
+        for (j = 0; j + 4 <= job->cols; j += 4)
+        {
+            _mm_storeu_ps(&row[j], _mm_mul_ps(_mm_loadu_ps(&row[j]), s));
+        }
+        for (; j < job->cols; j++)
+        {
+            row[j] *= _mm_cvtss_f32(s);
+        }
+    }
+}
+
+__attribute__((target("avx2,fma"))) static void rows_flt_avx2(size_t begin, size_t end, const struct Rows *job)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        float *row = (float *)job->matrix + i * job->stride;
+        __m256 acc[4] = {_mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps()};
+        size_t j;
+        for (j = 0; j + 32 <= job->cols; j += 32)
+        {
+            for (int k = 0; k < 4; k++)
+            {
+                __m256 v = _mm256_loadu_ps(&row[j + 8 * k]);
+                acc[k] = _mm256_fmadd_ps(v, v, acc[k]);
+            }
+        }
+        for (; j + 8 <= job->cols; j += 8)
+        {
+            __m256 v = _mm256_loadu_ps(&row[j]);
+            acc[0] = _mm256_fmadd_ps(v, v, acc[0]);
+        }
+        __m256 acc8 = _mm256_add_ps(_mm256_add_ps(acc[0], acc[1]), _mm256_add_ps(acc[2], acc[3]));
+        __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc8), _mm256_extractf128_ps(acc8, 1));
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+        for (; j < job->cols; j++)
+        {
+            sum = _mm_add_ss(sum, _mm_set_ss(row[j] * row[j]));
+        }
+
+        __m256 s = _mm256_broadcastss_ps(scale_ps(sum, job->newton));
+        for (j = 0; j + 8 <= job->cols; j += 8)
+        {
+            _mm256_storeu_ps(&row[j], _mm256_mul_ps(_mm256_loadu_ps(&row[j]), s));
+        }
+        for (; j < job->cols; j++)
+        {
+            row[j] *= _mm256_cvtss_f32(s);
+        }
+    }
+}
+
+static void rows_dbl_sse(size_t begin, size_t end, const struct Rows *job)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        double *row = (double *)job->matrix + i * job->stride;
+        __m128d acc[4] = {_mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd()};
+        size_t j;
+        for (j = 0; j + 8 <= job->cols; j += 8)
+        {
+            for (int k = 0; k < 4; k++)
+            {
+                __m128d v = _mm_loadu_pd(&row[j + 2 * k]);
+                acc[k] = _mm_add_pd(acc[k], _mm_mul_pd(v, v));
+            }
+        }
+        for (; j + 2 <= job->cols; j += 2)
+        {
+            __m128d v = _mm_loadu_pd(&row[j]);
+            acc[0] = _mm_add_pd(acc[0], _mm_mul_pd(v, v));
+        }
+        __m128d sum = _mm_add_pd(_mm_add_pd(acc[0], acc[1]), _mm_add_pd(acc[2], acc[3]));
+        sum = _mm_add_sd(sum, _mm_unpackhi_pd(sum, sum));
+        if (j < job->cols)
+        {
+            sum = _mm_add_sd(sum, _mm_set_sd(row[j] * row[j]));
+        }
+
+        __m128d s = scale_pd(sum, job->newton);
+        s = _mm_unpacklo_pd(s, s);
+        for (j = 0; j + 2 <= job->cols; j += 2)
+        {
+            _mm_storeu_pd(&row[j], _mm_mul_pd(_mm_loadu_pd(&row[j]), s));
+        }
+        if (j < job->cols)
+        {
+            row[j] *= _mm_cvtsd_f64(s);
+        }
+    }
+}
+
+__attribute__((target("avx2,fma"))) static void rows_dbl_avx2(size_t begin, size_t end, const struct Rows *job)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        double *row = (double *)job->matrix + i * job->stride;
+        __m256d acc[4] = {_mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd()};
+        size_t j;
+        for (j = 0; j + 16 <= job->cols; j += 16)
+        {
+            for (int k = 0; k < 4; k++)
+            {
+                __m256d v = _mm256_loadu_pd(&row[j + 4 * k]);
+                acc[k] = _mm256_fmadd_pd(v, v, acc[k]);
+            }
+        }
+        for (; j + 4 <= job->cols; j += 4)
+        {
+            __m256d v = _mm256_loadu_pd(&row[j]);
+            acc[0] = _mm256_fmadd_pd(v, v, acc[0]);
+        }
+        __m256d acc4 = _mm256_add_pd(_mm256_add_pd(acc[0], acc[1]), _mm256_add_pd(acc[2], acc[3]));
+        __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(acc4), _mm256_extractf128_pd(acc4, 1));
+        sum = _mm_add_sd(sum, _mm_unpackhi_pd(sum, sum));
+        for (; j < job->cols; j++)
+        {
+            sum = _mm_add_sd(sum, _mm_set_sd(row[j] * row[j]));
+        }
+
+        __m256d s = _mm256_broadcastsd_pd(scale_pd(sum, job->newton));
+        for (j = 0; j + 4 <= job->cols; j += 4)
+        {
+            _mm256_storeu_pd(&row[j], _mm256_mul_pd(_mm256_loadu_pd(&row[j]), s));
+        }
+        for (; j < job->cols; j++)
+        {
+            row[j] *= _mm256_cvtsd_f64(s);
+        }
+    }
+}
+
+static void rows_task_flt(size_t begin, size_t end, void *arg)
+{
+    const struct Rows *job = arg;
+    if (job->avx2)
+    {
+        rows_flt_avx2(begin, end, job);
+    }
+    else
+    {
+        rows_flt_sse(begin, end, job);
+    }
+}
+
+static void rows_task_dbl(size_t begin, size_t end, void *arg)
+{
+    const struct Rows *job = arg;
+    if (job->avx2)
+    {
+        rows_dbl_avx2(begin, end, job);
+    }
+    else
+    {
+        rows_dbl_sse(begin, end, job);
+    }
+}
+
+// Distribute the rows over the threads of the pool, chunk boundaries can be at any row
+static void normalize_rows(int db, size_t rows, size_t cols, size_t stride, void *matrix, int newton)
+{
+    struct Rows job = {cols, stride, matrix, newton, cpu_supports(CPU_AVX2 | CPU_FMA)};
+    pool_run(rows, 1, db ? rows_task_dbl : rows_task_flt, &job);
+}
+
+void normalizeRows_flt(size_t rows, size_t cols, size_t stride, float *matrix)
+{
+    normalize_rows(0, rows, cols, stride, matrix, 1);
+}
+
+void normalizeRows_flt_DoubleNewton(size_t rows, size_t cols, size_t stride, float *matrix)
+{
+    normalize_rows(0, rows, cols, stride, matrix, 2);
+}
+
+void normalizeRows_dbl(size_t rows, size_t cols, size_t stride, double *matrix)
+{
+    normalize_rows(1, rows, cols, stride, matrix, 1);
+}
+
+void normalizeRows_dbl_DoubleNewton(size_t rows, size_t cols, size_t stride, double *matrix)
+{
+    normalize_rows(1, rows, cols, stride, matrix, 2);
+}
@@ -3,22 +3,33 @@
  *
  *  @author Ngoc Kim Ngan Nguyen (ge23fak)
  */
-#define _POSIX_C_SOURCE 199309L
+#define _POSIX_C_SOURCE 200809L
 #include <stdio.h>
 #include <stdlib.h>
 #include <getopt.h>
 #include <string.h>
 #include <time.h>
 #include <errno.h>
+#include <float.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 
 #include "../include/parser.h"
 #include "../include/magicnumber.h"
 #include "../include/inverse_sqrt.h"
+#include "../include/cpufeatures.h"
+#include "../include/threadpool.h"
+#include "../include/numparse.h"
+#include "../include/format.h"
+#include "../include/kernelgen.h"
 
 const char *usage_msg = // Usage desciption
     "Usage: ./main [options] file_name      Calculate Fast Inverse Square Root of floating point numbers read from the file file_name given by the user\n"
     "or:    ./main [options] x1 x2 ...      Calculate Fast Inverse Square Root of an arbitrary amount of floating point numbers x1, x2, ... given by the user in terminal\n"
+    "or:    ./main [options] -              Calculate Fast Inverse Square Root of floating point numbers read from stdin\n"
     "or:    ./main -t                       Run tests and exit\n"
     "or:    ./main -h                       Show help message and exit\n"
     "or:    ./main --help                   Show help message and exit\n"
@@ -29,14 +40,45 @@ const char *help_msg = // Decription of all options
     "Positional arguments:\n"
     "  file_name                    The input file that contains an arbitrary amount of floating point numbers.\n"
     "                               File name is not allowed to start with a number.\n"
+    "                               Binary files written with -o are detected automatically and used without copying.\n"
     "  floating point numbers, ...  Arbitrary amount of floating point numbers\n"
     "\n"
     "Optional arguments:\n"
-    "  -V X     The Fast Inverse Squareroot function version, one of {0, 1, 2} (default: X = 0)\n"
+    "  -V X     The Fast Inverse Squareroot function version, one of {auto, 0, ..., 20, gen_...} (default: X = auto)\n"
+    "           auto: fastest version with 1 Newton iteration supported by the CPU,\n"
+    "           0: SSE, 1: Scalar, 2: AVX2/FMA, 3: AVX2/FMA with 2 Newton iterations,\n"
+    "           4: AVX-512, 5: AVX-512 with 2 Newton iterations,\n"
+    "           6: SSE with tuned Magic Number and Newton coefficients (see --tune), 7: 6 with 2 tuned Newton iterations,\n"
+    "           8, 9, 10: hardware estimate rsqrtps (SSE) with 0, 1, 2 Newton iterations instead of the Magic Number,\n"
+    "           11, 12, 13: hardware estimate rsqrt14 (AVX-512) with 0, 1, 2 Newton iterations,\n"
+    "           14, 15 (only with -d): float estimate (AVX2/FMA) refined with 1, 2 double Newton iterations, 16, 17: same with AVX-512\n"
+    "           18, 19, 20: 0, 2, 4 with results for all inputs: inf for 0, 0 for inf, NaN for negative values and NaN,\n"
+    "           the input numbers do not have to be positive then\n"
+    "           gen_W_uU_nN_M: generated kernel of width W (scalar, sse, avx2, avx512) with unroll factor U, N Newton iterations\n"
+    "           and MagicNumber M, e.g. gen_avx2_u2_n1_lomont, see kernelgen.h for the available combinations\n"
+    "  --max-rel-err E\n"
+    "           Use the fastest version supported by the CPU whose relative error is at most E instead of -V, e.g. 1e-5\n"
     "  -B X     Measure runtime of performing X (optional argument) loop iterations (default: X = 1), X should be greater than 0, if X is not present -B has to be the last argument\n"
+    "  -j N     Split the calculation into cache-line-aligned chunks processed by N threads pinned to cores (default: N = 1)\n"
     "  -d       Interpret the input numbers as double\n"
+    "  --input-type T\n"
+    "           Type of the input numbers, one of {float, double}, --input-type double is the same as -d\n"
+    "  --output-type T\n"
+    "           Type of the results, one of {float, double} (default: the input type). If it differs from the input type, the values\n"
+    "           are converted inside the kernel, -V, --max-rel-err and streamed input are not supported then\n"
+    "  --shortest\n"
+    "           Print the shortest decimal representation which reads back as the same value instead of 10 decimal places\n"
+    "  --no-echo\n"
+    "           Do not print the input numbers before the results\n"
+    "  -o FILE  Write the results as binary file (header and raw float32/float64 values) instead of printing them\n"
+    "  --stream\n"
+    "           Process the input file block-wise with bounded memory, only the results are printed (always used for stdin)\n"
     "  -t       Run tests and exit\n"
-    "  -m       Calculate Magic Number and print out to the console and exit program, no matter the other arguments except -d for Double MagicNumber\n"
+    "  -m       Calculate Magic Number and print out to the console and exit program, no matter the other arguments except -d for Double MagicNumber and -j for the number of threads. Floats are searched exhaustively\n"
+    "  --tune   Like -m, but tune the Magic Number together with the coefficients k1, k2 of the Newton iteration y * (k1 - k2 * x * y * y)\n"
+    "           for 1 and 2 iterations and print them as defines for inverse_sqrt.h\n"
+    "  --magic16 F\n"
+    "           Like -m for the 16-bit format F, one of {half, bfloat16}, the MagicNumber is applied to the 16-bit patterns\n"
     "  -h       Show help message (this text) and exit\n"
     "  --help   Show help message (this text) and exit\n";
 ;
@@ -61,40 +103,97 @@ void exit_failure(void)
     exit(EXIT_FAILURE);
 }
 
-typedef union
-{
-    void (*fn_flt)(size_t, float *, float *);   // Function type for floats
-    void (*fn_dbl)(size_t, double *, double *); // Function type for doubles
-} Func;
-
-struct Version
-{
-    const char *name; // Version name
-    Func fn;          // Corresponding function to version name
-};
-
-const struct Version versions[][2] = { // Look-up table for functions
+const struct Version versions[][MAX_VERSIONS] = { // Look-up table for functions
     {
-        {"0", {.fn_flt = fastInvSqrt_flt}},
-        {"1", {.fn_flt = fastInvSqrt_flt_V1}},
+        {"0", {.fn_flt = fastInvSqrt_flt}, CPU_SSE2, {.fn_flt = fastInvSqrt_flt_NT}, 1.76e-3, 0.45, 0},
+        {"1", {.fn_flt = fastInvSqrt_flt_V1}, 0, {NULL}, 1.76e-3, 1.76, 0},
+        {"2", {.fn_flt = fastInvSqrt_flt_AVX2}, CPU_AVX2 | CPU_FMA, {.fn_flt = fastInvSqrt_flt_AVX2_NT}, 1.76e-3, 0.26, 0},
+        {"3", {.fn_flt = fastInvSqrt_flt_AVX2_DoubleNewton}, CPU_AVX2 | CPU_FMA, {NULL}, 4.9e-6, 0.38, 0},
+        {"4", {.fn_flt = fastInvSqrt_flt_AVX512}, CPU_AVX512F, {.fn_flt = fastInvSqrt_flt_AVX512_NT}, 1.76e-3, 0.27, 0},
+        {"5", {.fn_flt = fastInvSqrt_flt_AVX512_DoubleNewton}, CPU_AVX512F, {NULL}, 4.9e-6, 0.30, 0},
+        {"6", {.fn_flt = fastInvSqrt_flt_Tuned}, CPU_SSE2, {NULL}, 6.6e-4, 0.47, 0},
+        {"7", {.fn_flt = fastInvSqrt_flt_Tuned_DoubleNewton}, CPU_SSE2, {NULL}, 5.5e-7, 0.82, 0},
+        {"8", {.fn_flt = fastInvSqrt_flt_RSQRT}, CPU_SSE2, {NULL}, 3.7e-4, 0.21, 0},
+        {"9", {.fn_flt = fastInvSqrt_flt_RSQRT_Newton}, CPU_SSE2, {NULL}, 3.0e-7, 0.46, 0},
+        {"10", {.fn_flt = fastInvSqrt_flt_RSQRT_DoubleNewton}, CPU_SSE2, {NULL}, 2.1e-7, 0.75, 0},
+        {"11", {.fn_flt = fastInvSqrt_flt_AVX512_RSQRT14}, CPU_AVX512F, {NULL}, 6.2e-5, 0.22, 0},
+        {"12", {.fn_flt = fastInvSqrt_flt_AVX512_RSQRT14_Newton}, CPU_AVX512F, {NULL}, 2.4e-7, 0.26, 0},
+        {"13", {.fn_flt = fastInvSqrt_flt_AVX512_RSQRT14_DoubleNewton}, CPU_AVX512F, {NULL}, 2.1e-7, 0.32, 0},
+        {"18", {.fn_flt = fastInvSqrt_flt_Special}, CPU_SSE2, {NULL}, 1.76e-3, 0.80, 1},
+        {"19", {.fn_flt = fastInvSqrt_flt_AVX2_Special}, CPU_AVX2 | CPU_FMA, {NULL}, 1.76e-3, 0.40, 1},
+        {"20", {.fn_flt = fastInvSqrt_flt_AVX512_Special}, CPU_AVX512F, {NULL}, 1.76e-3, 0.28, 1},
+        KERNEL_MATRIX_FLT(GEN_VERSION) // Generated versions gen_W_uU_nN_TAG, see kernelgen.h
         // Add more options for float here
     },
     {
-        {"0", {.fn_dbl = fastInvSqrt_dbl}},
-        {"1", {.fn_dbl = fastInvSqrt_dbl_V1}},
+        {"0", {.fn_dbl = fastInvSqrt_dbl}, CPU_SSE2, {.fn_dbl = fastInvSqrt_dbl_NT}, 1.76e-3, 0.90, 0},
+        {"1", {.fn_dbl = fastInvSqrt_dbl_V1}, 0, {NULL}, 1.76e-3, 1.76, 0},
+        {"2", {.fn_dbl = fastInvSqrt_dbl_AVX2}, CPU_AVX2 | CPU_FMA, {.fn_dbl = fastInvSqrt_dbl_AVX2_NT}, 1.76e-3, 0.50, 0},
+        {"3", {.fn_dbl = fastInvSqrt_dbl_AVX2_DoubleNewton}, CPU_AVX2 | CPU_FMA, {NULL}, 4.7e-6, 0.76, 0},
+        {"4", {.fn_dbl = fastInvSqrt_dbl_AVX512}, CPU_AVX512F, {.fn_dbl = fastInvSqrt_dbl_AVX512_NT}, 1.76e-3, 0.51, 0},
+        {"5", {.fn_dbl = fastInvSqrt_dbl_AVX512_DoubleNewton}, CPU_AVX512F, {NULL}, 4.7e-6, 0.54, 0},
+        {"6", {.fn_dbl = fastInvSqrt_dbl_Tuned}, CPU_SSE2, {NULL}, 6.6e-4, 0.93, 0},
+        {"7", {.fn_dbl = fastInvSqrt_dbl_Tuned_DoubleNewton}, CPU_SSE2, {NULL}, 3.3e-7, 1.64, 0},
+        {"8", {.fn_dbl = fastInvSqrt_dbl_RSQRT}, CPU_SSE2, {NULL}, 3.7e-4, 1.95, 0},
+        {"9", {.fn_dbl = fastInvSqrt_dbl_RSQRT_Newton}, CPU_SSE2, {NULL}, 2.1e-7, 2.65, 0},
+        {"10", {.fn_dbl = fastInvSqrt_dbl_RSQRT_DoubleNewton}, CPU_SSE2, {NULL}, 6.7e-14, 3.39, 0},
+        {"11", {.fn_dbl = fastInvSqrt_dbl_AVX512_RSQRT14}, CPU_AVX512F, {NULL}, 6.2e-5, 0.45, 0},
+        {"12", {.fn_dbl = fastInvSqrt_dbl_AVX512_RSQRT14_Newton}, CPU_AVX512F, {NULL}, 5.6e-9, 0.53, 0},
+        {"13", {.fn_dbl = fastInvSqrt_dbl_AVX512_RSQRT14_DoubleNewton}, CPU_AVX512F, {NULL}, 5.0e-16, 0.58, 0},
+        {"14", {.fn_dbl = fastInvSqrt_dbl_AVX2_Mixed}, CPU_AVX2 | CPU_FMA, {NULL}, 3.5e-11, 1.81, 0},
+        {"15", {.fn_dbl = fastInvSqrt_dbl_AVX2_Mixed_DoubleNewton}, CPU_AVX2 | CPU_FMA, {NULL}, 5.0e-16, 2.17, 0},
+        {"16", {.fn_dbl = fastInvSqrt_dbl_AVX512_Mixed}, CPU_AVX512F, {NULL}, 3.5e-11, 1.09, 0},
+        {"17", {.fn_dbl = fastInvSqrt_dbl_AVX512_Mixed_DoubleNewton}, CPU_AVX512F, {NULL}, 5.0e-16, 1.28, 0},
+        {"18", {.fn_dbl = fastInvSqrt_dbl_Special}, CPU_SSE2, {NULL}, 1.76e-3, 1.40, 1},
+        {"19", {.fn_dbl = fastInvSqrt_dbl_AVX2_Special}, CPU_AVX2 | CPU_FMA, {NULL}, 1.76e-3, 0.70, 1},
+        {"20", {.fn_dbl = fastInvSqrt_dbl_AVX512_Special}, CPU_AVX512F, {NULL}, 1.76e-3, 0.52, 1},
+        KERNEL_MATRIX_DBL(GEN_VERSION) // Generated versions gen_W_uU_nN_TAG, see kernelgen.h
         // Add more options for double here
     }};
 
-// Return the function corresponding to data type (float if db = 0, double if db = 1) and version name
-Func get_version(int db, const char *version_name)
+// Versions considered by -V auto, ordered from fastest to slowest. All of them use a single Newton iteration like the default version 0.
+const char *auto_versions[] = {"4", "2", "0", "1"};
+
+// Return the name of the fastest version of auto_versions which is supported by the CPU
+static const char *resolve_auto(int db)
+{
+    for (size_t i = 0; i < sizeof auto_versions / sizeof *auto_versions; i++)
+    {
+        for (size_t j = 0; j < MAX_VERSIONS && versions[db][j].name; j++)
+        {
+            const struct Version *ver = &versions[db][j];
+            if (!strcmp(ver->name, auto_versions[i]) && cpu_supports(ver->features))
+            {
+                return ver->name;
+            }
+        }
+    }
+    return "1"; // The scalar version runs everywhere
+}
+
+// Return the entry of the versions table corresponding to data type (float if db = 0, double if db = 1) and version name
+static const struct Version *find_version(int db, const char *version_name)
 {
-    for (size_t i = 0; i < (sizeof *versions) / (sizeof **versions); i++)
+    if (!strcmp(version_name, "auto"))
+    {
+        version_name = resolve_auto(db);
+    }
+
+    for (size_t i = 0; i < MAX_VERSIONS && versions[db][i].name; i++)
     {
         const struct Version *ver = &versions[db][i];
-        // check if AVX available here
         if (!strcmp(ver->name, version_name))
         {
-            return ver->fn;
+            // Refuse versions using instructions the CPU does not support instead of crashing with SIGILL
+            if (!cpu_supports(ver->features))
+            {
+                char missing[64];
+                cpu_feature_names(ver->features & ~cpu_features(), missing, sizeof missing);
+                fprintf(stderr, "The given function version -V%s requires %s, which is not supported by this CPU.\n", version_name, missing); // error message
+                print_usage();
+                exit(EXIT_FAILURE);
+            }
+            return ver;
         }
     }
     fprintf(stderr, "The given function version -V%s is invalid.\n", version_name); // error message
@@ -102,169 +201,213 @@ Func get_version(int db, const char *version_name)
     exit(EXIT_FAILURE);
 }
 
-// Print out an array with the length n and type float (db = 0) or double (db = 1) to the console
-void print_out(int db, size_t n, void *out)
+// Return the function corresponding to data type (float if db = 0, double if db = 1) and version name
+Func get_version(int db, const char *version_name)
 {
-    if (!db)
+    return find_version(db, version_name)->fn;
+}
+
+// Same as get_version, but use the variant with non-temporal stores if the arrays do not fit into the last-level cache
+Func get_version_for_size(int db, const char *version_name, size_t n)
+{
+    const struct Version *ver = find_version(db, version_name);
+    size_t bytes = 2 * n * (db ? sizeof(double) : sizeof(float)); // Input and output array
+    if (ver->stream.fn_flt && bytes > cpu_llc_size())
+    {
+        return ver->stream;
+    }
+    return ver->fn;
+}
+
+// Return the name of the cheapest version supported by the CPU whose relative error is at most max_error
+const char *select_version(int db, double max_error)
+{
+    const struct Version *best = NULL;
+    double smallest = 1.0; // Smallest error bound of the supported versions, for the error message
+    for (size_t i = 0; i < MAX_VERSIONS && versions[db][i].name; i++)
     {
-        float *out_flt = out;
-        for (size_t i = 0; i < n; i++)
+        const struct Version *ver = &versions[db][i];
+        if (!cpu_supports(ver->features))
+        {
+            continue;
+        }
+        smallest = ver->maxError < smallest ? ver->maxError : smallest;
+        if (ver->maxError <= max_error && (!best || ver->cost < best->cost))
         {
-            printf("%10.10f ", out_flt[i]);
+            best = ver;
         }
-        printf("\n");
     }
-    else
+    if (!best)
+    {
+        fprintf(stderr, "No function version reaches a maximum relative error of %g, the most accurate one supported by this CPU has %g.\n", max_error, smallest); // error message
+        print_usage();
+        exit(EXIT_FAILURE);
+    }
+    return best->name;
+}
+
+// Return 1 if the version handles all inputs itself, without resolving "auto" or terminating for invalid names
+int version_special(int db, const char *version_name)
+{
+    for (size_t i = 0; i < MAX_VERSIONS && versions[db][i].name; i++)
     {
-        double *out_dbl = out;
-        for (size_t i = 0; i < n; i++)
+        if (!strcmp(versions[db][i].name, version_name))
         {
-            printf("%10.10f ", out_dbl[i]);
+            return versions[db][i].special;
         }
-        printf("\n");
     }
+    return 0;
 }
 
-// Count the total number of lines in the file given by path
-size_t sizeReadFile(const char *path)
+// Print out an array with the length n and type float (db = 0) or double (db = 1) to the console
+void print_out(int db, size_t n, void *out, int format)
+{
+    struct Writer w;
+    fflush(stdout); // Keep the order with text printed by printf before
+    if (writer_init(&w, STDOUT_FILENO))
+    {
+        perror("Error allocating memory for output buffer"); // Error message
+        exit_failure();
+    }
+    if (!db)
+    {
+        write_flt(&w, n, out, format);
+    }
+    else
+    {
+        write_dbl(&w, n, out, format);
+    }
+    writer_putc(&w, '\n');
+    writer_close(&w);
+}
+
+// Read numbers from the file given by path in a single pass and return a pointer to an array storing these numbers
+void *readFile(int db, size_t *count, const char *path, int positive)
 {
     // Declare the necessary variables
-    FILE *file;     // File pointer
-    char line[350]; // Line buffer
-    int count = 0;  // Counter for the number of lines
+    void *res = NULL;
+    size_t size = 4 * db + 4; // size = 4 if db = 0 (float); size = 8 if db = 1 (double)
+    size_t n = 0;             // Number of values read so far
+    int fd;                   // File descriptor
 
     // Open file
-    if (!(file = fopen(path, "r")))
-    { // r: read file
+    if ((fd = open(path, O_RDONLY)) == -1)
+    {
         perror("Error opening file");
-        return count;
+        return NULL;
     }
 
     // Check if file type and mode is regular
     struct stat sb;
-    if (fstat(fileno(file), &sb) == -1)
+    if (fstat(fd, &sb) == -1)
     {
-        fprintf(stderr, "Error retrieving file stats");
-        goto cleanup;
+        perror("Error retrieving file stats");
+        close(fd);
+        return NULL;
     }
     if (!S_ISREG(sb.st_mode) || sb.st_size <= 0)
     {
         fprintf(stderr, "Error processing file: Not a regular file or invalid size \n");
-        goto cleanup;
+        close(fd);
+        return NULL;
     }
 
-    // Count the number of lines
-    while (fgets(line, sizeof(line), file))
+    // Map the file into memory, so the text is parsed in place without copying it into line buffers
+    const char *text = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (text == MAP_FAILED)
     {
-        count++;
+        perror("Error mapping file");
+        return NULL;
     }
-
-cleanup: // Close file
-    fclose(file);
-    return count;
-}
-
-// Read numbers from a the file given by path and return a pointer to an array storing these numbers
-void *readFile(int db, size_t count, const char *path)
-{
-    // Declare the necessary variables
-    void *res = NULL;
-    FILE *file;     // File pointer
-    char line[350]; // Line buffer
-
-    // Allocate memory for returned array
-    size_t size = 4 * db + 4; // size = 4 if db = 0 (float); size = 8 if db = 1 (double)
-    res = malloc(count * size);
+    posix_madvise((void *)text, sb.st_size, POSIX_MADV_SEQUENTIAL);
+    const char *p = text;
+    const char *end = text + sb.st_size;
+
+    /* Allocate memory for returned array. The number of values is not known before parsing,
+    so start with an estimate of 8 characters per value and double the capacity if needed */
+    size_t capacity = sb.st_size / 8 + 16;
+    res = malloc(capacity * size);
     if (!res)
     {
         perror("Error allocating memory for output array"); // Error message
-        exit_failure();
-    };
-
-    // Open file again to read the values.
-    // Here we do not need to check if opening file succeeds or not, as it was already done in the method sizeReadFile(const char* path).
-    file = fopen(path, "r");
-
-    if (!db)
-    { // Numbers are considered as float
-        float *numbers = res;
-        count = 0;
-        char *endptr;
+        goto cleanup;
+    }
 
-        // Read each line of the file until end-of-file or an error occurs and convert the read string to a float
-        while (fgets(line, sizeof(line), file))
+    // Parse all whitespace separated numbers, the positivity of the values is checked afterwards for the whole array if required
+    while ((p = skip_space(p, end)) < end)
+    {
+        if (n == capacity)
         {
-            endptr = NULL;
-            float xi = strtof(line, &endptr);
-            if (endptr == line || (*endptr != '\n' && *endptr != '\0'))
-            {
-                fprintf(stderr, "%s could not be converted to float\n", line);
-                free(res);
-                res = NULL;
-                goto cleanup;
-            }
-            else if (errno == ERANGE)
+            capacity *= 2;
+            void *tmp = realloc(res, capacity * size);
+            if (!tmp)
             {
-                fprintf(stderr, "%s over- or underflows float\n", line);
+                perror("Error allocating memory for output array"); // Error message
                 free(res);
                 res = NULL;
                 goto cleanup;
             }
-            else if (xi <= 0.0L)
-            { // Input is not a positive number
-                fprintf(stderr, "%s is not positive\n", line);
-                free(res);
-                res = NULL;
-                goto cleanup;
-            }
-            numbers[count++] = xi;
+            res = tmp;
         }
-    }
-    else
-    { // Numbers are considered as double
-        double *numbers = res;
-        file = fopen(path, "r");
-        count = 0;
-        char *endptr;
 
-        // Read each line of the file until end-of-file or an error occurs convert the read string to a double
-        while (fgets(line, sizeof(line), file))
+        const char *token = p;
+        int status = !db ? parse_flt(&p, end, (float *)res + n) : parse_dbl(&p, end, (double *)res + n);
+        if (status != PARSE_OK)
         {
-            endptr = NULL;
-            double xi = strtod(line, &endptr);
-            if (endptr == line || (*endptr != '\n' && *endptr != '\0'))
+            int len = 0;
+            while (token + len < end && !isspace((unsigned char)token[len]))
             {
-                fprintf(stderr, "%s could not be converted to double\n", line);
-                free(res);
-                res = NULL;
-                goto cleanup;
+                len++;
             }
-            else if (errno == ERANGE)
+            if (status == PARSE_RANGE)
             {
-                fprintf(stderr, "%s over- or underflows double\n", line);
-                free(res);
-                res = NULL;
-                goto cleanup;
+                fprintf(stderr, "%.*s over- or underflows %s\n", len, token, db ? "double" : "float");
             }
-            else if (xi <= 0.0L)
-            { // Input is not a positive number
-                fprintf(stderr, "%s is not positive\n", line);
-                free(res);
-                res = NULL;
-                goto cleanup;
+            else
+            {
+                fprintf(stderr, "%.*s could not be converted to %s\n", len, token, db ? "double" : "float");
             }
-            numbers[count++] = xi;
+            free(res);
+            res = NULL;
+            goto cleanup;
         }
+        n++;
     }
 
-cleanup: // Close file
-    fclose(file);
+    size_t invalid = !positive ? n : !db ? first_nonpositive_flt(n, res) : first_nonpositive_dbl(n, res);
+    if (invalid < n)
+    { // Input is not a positive number
+        fprintf(stderr, "%.10g (value %zu) is not positive\n", !db ? ((float *)res)[invalid] : ((double *)res)[invalid], invalid + 1);
+        free(res);
+        res = NULL;
+    }
+    else if (!n)
+    {
+        fprintf(stderr, "Error processing file: No numbers found\n");
+        free(res);
+        res = NULL;
+    }
+    else if (pool_size() > 1)
+    { /* The array grew on the parsing thread, so move it into memory first-touched by the threads
+        which process it later (see pool_alloc). If that fails, the unmoved array is still correct */
+        void *moved = pool_alloc(n, size);
+        if (moved)
+        {
+            memcpy(moved, res, n * size);
+            free(res);
+            res = moved;
+        }
+    }
 
+cleanup: // Unmap file
+    munmap((void *)text, sb.st_size);
+    *count = n;
     return res;
 }
 
 // Read floating point numbers directly from terminal and return a pointer to an array storing these numbers
-void *readTerminal(int db, int argc, char *argv[])
+void *readTerminal(int db, int argc, char *argv[], int positive)
 {
     // Note: optind does not need to be passed as a function argument because library getopt.h is already included.
 
@@ -302,7 +445,7 @@ void *readTerminal(int db, int argc, char *argv[])
                 free(vals);
                 exit_failure();
             }
-            else if (xi <= 0.0L)
+            else if (positive && xi <= 0.0L)
             { // Input is not a positive number
                 fprintf(stderr, "%s is not positive\n", arg);
                 free(vals);
@@ -331,7 +474,7 @@ void *readTerminal(int db, int argc, char *argv[])
                 free(vals);
                 exit_failure();
             }
-            else if (xi <= 0.0L)
+            else if (positive && xi <= 0.0L)
             { // Input is not a positive number
                 fprintf(stderr, "%s is not positive\n", arg);
                 free(vals);
@@ -351,35 +494,121 @@ static inline double curtime(void)
     return t.tv_sec + t.tv_nsec * 1e-9;
 }
 
-// Execute the function specified by version_name and type float/double with arguments n, vals in "loop" iterations
-double execute(int db, const char *version_name, size_t n, void *vals, int loop)
+// Execute the function specified by version_name and type float/double with arguments n, vals, out in "loop" iterations without printing
+double compute(int db, const char *version_name, size_t n, void *vals, void *out, int loop)
 {
-    Func fun = get_version(db, version_name); // Get the function specified by version_name and type float (db = 0) / double (db = 1)
+    Func fun = get_version_for_size(db, version_name, n); // Get the function specified by version_name and type float (db = 0) / double (db = 1)
     double start, end;
-    size_t size = 4 * db + 4; // size = 4 if db = 0 (float); size = 8 if db = 1 (double)
 
-    // Allocate memory for output array
-    void *out = malloc(n * size);
+    start = curtime();
+    for (long i = 0; i < loop; i++)
+    {
+        // Split the arrays among the threads of the pool, with a single thread the function is called directly
+        if (!db)
+        {
+            parallelInvSqrt_flt(fun.fn_flt, n, vals, out);
+        }
+        else
+        {
+            parallelInvSqrt_dbl(fun.fn_dbl, n, vals, out);
+        }
+    }
+    end = curtime();
+
+    return end - start;
+}
+
+// Execute the function specified by version_name and type float/double with arguments n, vals in "loop" iterations
+double execute(int db, const char *version_name, size_t n, void *vals, int loop, int format, int echo)
+{
+    get_version(db, version_name); // Check the version before printing anything
+    size_t size = 4 * db + 4;      // size = 4 if db = 0 (float); size = 8 if db = 1 (double)
+
+    // Allocate memory for output array, pages are first-touched by the threads which later write them
+    void *out = pool_alloc(n, size);
     if (!out)
     {
         perror("Error allocating memory for output array"); // Error message
         exit_failure();
     };
 
-    // Print out input array
-    print_out(db, n, vals);
+    // Print out input array unless disabled with --no-echo
+    if (echo)
+    {
+        print_out(db, n, vals, format);
+    }
+
+    double time = compute(db, version_name, n, vals, out, loop);
 
+    // Print out output array
+    print_out(db, n, out, format);
+
+    free(out); // Release memory space allocated to input array
+
+    return time;
+}
+
+// Doubles are narrowed to float before the computation of the mixed-type kernel, which only works within the range of normal floats
+static void check_float_range(int db, size_t n, const void *vals)
+{
+    for (size_t i = 0; db && i < n; i++)
+    {
+        double x = ((const double *)vals)[i];
+        if (x < FLT_MIN || x > FLT_MAX)
+        {
+            fprintf(stderr, "Input value %g is outside the range of normal floats and cannot be converted to float\n", x); // error message
+            exit_failure();
+        }
+    }
+}
+
+// Execute the mixed-type kernel converting from type float (db = 0) or double (db = 1) to the other type in "loop" iterations without printing
+double computeConvert(int db, size_t n, void *vals, void *out, int loop)
+{
+    int avx2 = cpu_supports(CPU_AVX2 | CPU_FMA);
+    double start, end;
+
+    check_float_range(db, n, vals);
     start = curtime();
     for (long i = 0; i < loop; i++)
     {
-        fun.fn_flt(n, vals, out);
+        if (db)
+        {
+            parallelInvSqrt_dbl_flt(avx2 ? fastInvSqrt_dbl_flt_AVX2 : fastInvSqrt_dbl_flt, n, vals, out);
+        }
+        else
+        {
+            parallelInvSqrt_flt_dbl(avx2 ? fastInvSqrt_flt_dbl_AVX2 : fastInvSqrt_flt_dbl, n, vals, out);
+        }
     }
     end = curtime();
 
-    // Print out output array
-    print_out(db, n, out);
+    return end - start;
+}
 
-    free(out); // Release memory space allocated to input array
+// Execute the mixed-type kernel converting from type float/double to the other type in "loop" iterations and print the results
+double executeConvert(int db, size_t n, void *vals, int loop, int format, int echo)
+{
+    check_float_range(db, n, vals); // Check the input before printing anything
+    size_t size = 4 * !db + 4;      // Size of the output type
 
-    return end - start;
-}
\ No newline at end of file
+    void *out = pool_alloc(n, size);
+    if (!out)
+    {
+        perror("Error allocating memory for output array"); // Error message
+        exit_failure();
+    };
+
+    if (echo)
+    {
+        print_out(db, n, vals, format);
+    }
+
+    double time = computeConvert(db, n, vals, out, loop);
+
+    print_out(!db, n, out, format);
+
+    free(out);
+
+    return time;
+}
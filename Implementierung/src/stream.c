@@ -0,0 +1,358 @@
+/** @file stream.c
+ *  @brief Implementation of the block-wise processing of input of arbitrary size
+ *  @details For details of each function see stream.h
+ *  @author Ngoc Kim Ngan Nguyen (ge23fak)
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "../include/stream.h"
+#include "../include/parser.h"
+#include "../include/threadpool.h"
+#include "../include/numparse.h"
+#include "../include/format.h"
+
+#define READ_SIZE 65536 // Number of bytes read from the input at once
+#define TOKEN_SIZE 64   // Initial size of the token buffer, it grows for longer numbers
+
+struct Block
+{
+    void *vals;  // Input values
+    void *out;   // Results
+    size_t n;    // Number of values in this block
+    int last;    // Set for the last block of the input
+    int error;   // Set if the input contained an invalid number after the values of this block
+};
+
+// Queue of blocks passed from one stage to the next, it can hold all blocks so pushing never waits
+struct Queue
+{
+    struct Block *items[STREAM_BLOCKS];
+    size_t head;
+    size_t count;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+};
+
+static void queue_push(struct Queue *q, struct Block *b)
+{
+    pthread_mutex_lock(&q->lock);
+    q->items[(q->head + q->count++) % STREAM_BLOCKS] = b;
+    pthread_cond_signal(&q->cond);
+    pthread_mutex_unlock(&q->lock);
+}
+
+static struct Block *queue_pop(struct Queue *q)
+{
+    pthread_mutex_lock(&q->lock);
+    while (!q->count)
+    {
+        pthread_cond_wait(&q->cond, &q->lock);
+    }
+    struct Block *b = q->items[q->head];
+    q->head = (q->head + 1) % STREAM_BLOCKS;
+    q->count--;
+    pthread_mutex_unlock(&q->lock);
+    return b;
+}
+
+struct Pipeline
+{
+    int db;
+    int format;         // Output format, see format.h
+    int positive;       // Reject values which are not positive, unless the version handles them (see version_special)
+    FILE *in;
+    struct Writer out;  // Output buffer of the writer stage
+    size_t count;       // Number of values printed by the writer stage
+    struct Queue free;      // Blocks which can be filled by the reader
+    struct Queue parsed;    // Blocks waiting for the calculation
+    struct Queue computed;  // Blocks waiting to be printed
+};
+
+struct Reader
+{
+    FILE *file;
+    char buf[READ_SIZE];
+    size_t pos;
+    size_t len;
+    char *tok;   // Current token, numbers of any length are accepted like in readFile
+    size_t cap;  // Size of tok
+};
+
+// Copy the next whitespace separated token into r->tok. Return its length, 0 at end of input and -1 if the token buffer could not be grown.
+static long next_token(struct Reader *r)
+{
+    size_t k = 0;
+    for (;;)
+    {
+        if (r->pos == r->len)
+        {
+            r->len = fread(r->buf, 1, READ_SIZE, r->file);
+            r->pos = 0;
+            if (!r->len)
+            {
+                break;
+            }
+        }
+        char c = r->buf[r->pos];
+        if (isspace((unsigned char)c))
+        {
+            r->pos++;
+            if (k)
+            {
+                break;
+            }
+            continue;
+        }
+        if (k + 1 == r->cap)
+        {
+            char *tmp = realloc(r->tok, 2 * r->cap);
+            if (!tmp)
+            {
+                return -1;
+            }
+            r->tok = tmp;
+            r->cap *= 2;
+        }
+        r->tok[k++] = c;
+        r->pos++;
+    }
+    r->tok[k] = '\0';
+    return (long)k;
+}
+
+// Convert tok of length len to a float/double and store it at index i of vals. Return 0 if the conversion succeeded, otherwise print an error and return -1.
+static int parse_value(int db, const char *tok, size_t len, void *vals, size_t i)
+{
+    const char *p = tok;
+    int status = !db ? parse_flt(&p, tok + len, (float *)vals + i) : parse_dbl(&p, tok + len, (double *)vals + i);
+    if (status == PARSE_RANGE)
+    {
+        fprintf(stderr, "%s over- or underflows %s\n", tok, db ? "double" : "float");
+        return -1;
+    }
+    else if (status != PARSE_OK)
+    {
+        fprintf(stderr, "%s could not be converted to %s\n", tok, db ? "double" : "float");
+        return -1;
+    }
+    return 0;
+}
+
+// First stage: fill free blocks with numbers parsed from the input
+static void *reader_stage(void *arg)
+{
+    struct Pipeline *p = arg;
+    struct Reader *r = malloc(sizeof *r);
+    int done = 0;
+    size_t total = 0; // Number of values in the previous blocks
+
+    if (r)
+    {
+        r->file = p->in;
+        r->pos = r->len = 0;
+        r->cap = TOKEN_SIZE;
+        r->tok = malloc(r->cap);
+        if (!r->tok)
+        {
+            free(r);
+            r = NULL;
+        }
+    }
+    while (!done)
+    {
+        struct Block *b = queue_pop(&p->free);
+        b->n = 0;
+        b->error = 0;
+        b->last = 0;
+        if (!r)
+        {
+            perror("Error allocating memory for input buffer");
+            b->error = 1;
+        }
+        while (r && b->n < STREAM_BLOCK)
+        {
+            long len = next_token(r);
+            if (len == 0)
+            {
+                b->error = ferror(p->in) != 0;
+                if (b->error)
+                {
+                    perror("Error reading input");
+                }
+                break;
+            }
+            if (len < 0)
+            {
+                perror("Error allocating memory for input buffer");
+                b->error = 1;
+                break;
+            }
+            if (parse_value(p->db, r->tok, len, b->vals, b->n))
+            {
+                b->error = 1;
+                break;
+            }
+            b->n++;
+        }
+        // Check the positivity of the whole block at once, only the values before the first invalid one are processed
+        size_t invalid = !p->positive ? b->n : !p->db ? first_nonpositive_flt(b->n, b->vals) : first_nonpositive_dbl(b->n, b->vals);
+        if (invalid < b->n)
+        { // Input is not a positive number
+            fprintf(stderr, "%.10g (value %zu) is not positive\n", !p->db ? ((float *)b->vals)[invalid] : ((double *)b->vals)[invalid], total + invalid + 1);
+            b->n = invalid;
+            b->error = 1;
+        }
+        total += b->n;
+
+        // The input ends if the block could not be filled completely
+        done = b->last = b->error || b->n < STREAM_BLOCK;
+        queue_push(&p->parsed, b);
+    }
+    if (r)
+    {
+        free(r->tok);
+    }
+    free(r);
+    return NULL;
+}
+
+// Last stage: print the results of computed blocks and hand the blocks back to the reader
+static void *writer_stage(void *arg)
+{
+    struct Pipeline *p = arg;
+    int last = 0;
+
+    while (!last)
+    {
+        struct Block *b = queue_pop(&p->computed);
+        if (!p->db)
+        {
+            write_flt(&p->out, b->n, b->out, p->format);
+        }
+        else
+        {
+            write_dbl(&p->out, b->n, b->out, p->format);
+        }
+        p->count += b->n;
+        last = b->last;
+        queue_push(&p->free, b);
+    }
+    if (p->count)
+    { // Like the file input, nothing is printed if there were no values
+        writer_putc(&p->out, '\n');
+    }
+    writer_flush(&p->out);
+    return NULL;
+}
+
+// Set up method to measure runtime
+static inline double curtime(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+int executeStream(int db, const char *version_name, FILE *in, int format, double *time)
+{
+    Func fun = get_version(db, version_name); // Get the function specified by version_name and type float (db = 0) / double (db = 1)
+    size_t size = 4 * db + 4;                 // size = 4 if db = 0 (float); size = 8 if db = 1 (double)
+    struct Block blocks[STREAM_BLOCKS] = {0};
+    struct Pipeline p = {
+        .db = db,
+        .format = format,
+        .positive = !version_special(db, version_name),
+        .in = in,
+        .free = {.lock = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER},
+        .parsed = {.lock = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER},
+        .computed = {.lock = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER},
+    };
+    int error = 0;
+    *time = 0.0;
+
+    fflush(stdout); // Keep the order with text printed by printf before
+    if (writer_init(&p.out, STDOUT_FILENO))
+    {
+        perror("Error allocating memory for output buffer"); // Error message
+        return -1;
+    }
+
+    // Allocate all blocks up front, this is the only memory depending on STREAM_BLOCK
+    for (size_t i = 0; i < STREAM_BLOCKS; i++)
+    {
+        blocks[i].vals = pool_alloc(STREAM_BLOCK, size);
+        blocks[i].out = pool_alloc(STREAM_BLOCK, size);
+        if (!blocks[i].vals || !blocks[i].out)
+        {
+            perror("Error allocating memory for stream blocks"); // Error message
+            error = 1;
+            goto cleanup;
+        }
+        queue_push(&p.free, &blocks[i]);
+    }
+
+    pthread_t reader, writer;
+    if (pthread_create(&reader, NULL, reader_stage, &p))
+    {
+        fprintf(stderr, "Error creating reader thread\n");
+        error = 1;
+        goto cleanup;
+    }
+    if (pthread_create(&writer, NULL, writer_stage, &p))
+    {
+        fprintf(stderr, "Error creating writer thread\n");
+        // Hand all parsed blocks back to the reader until it reached the end of the input, so it can be joined
+        for (int last = 0; !last;)
+        {
+            struct Block *b = queue_pop(&p.parsed);
+            last = b->last;
+            queue_push(&p.free, b);
+        }
+        pthread_join(reader, NULL);
+        error = 1;
+        goto cleanup;
+    }
+
+    // Second stage: calculate each parsed block while the next one is parsed and the previous one is printed
+    for (int last = 0; !last;)
+    {
+        struct Block *b = queue_pop(&p.parsed);
+        double start = curtime();
+        if (!db)
+        {
+            parallelInvSqrt_flt(fun.fn_flt, b->n, b->vals, b->out);
+        }
+        else
+        {
+            parallelInvSqrt_dbl(fun.fn_dbl, b->n, b->vals, b->out);
+        }
+        *time += curtime() - start;
+        error |= b->error;
+        last = b->last;
+        queue_push(&p.computed, b);
+    }
+
+    pthread_join(reader, NULL);
+    pthread_join(writer, NULL);
+    if (!error && !p.count)
+    {
+        fprintf(stderr, "Error processing file: No numbers found\n");
+        error = 1;
+    }
+
+cleanup: // Release memory space allocated to the blocks and the output buffer
+    for (size_t i = 0; i < STREAM_BLOCKS; i++)
+    {
+        free(blocks[i].vals);
+        free(blocks[i].out);
+    }
+    error |= writer_close(&p.out) != 0;
+    return error ? -1 : 0;
+}
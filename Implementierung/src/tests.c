@@ -8,14 +8,41 @@
 #define TRIALS 200
 #define STEPS 500000
 #define MAXINCREMENTS 20
+#define ACCURACY_BLOCK (1 << 16) // Number of values passed at once to the kernels in the accuracy benchmarks
+#define SWEEP_MIN_BYTES (1 << 12)       // Size of each array at the start of the size sweep, input and output fit into L1
+#define SWEEP_MAX_BYTES (1ul << 31)     // Upper limit of the size of each array in the size sweep
+#define LATENCY_MAX_N 64                // Largest number of values per call in the latency benchmark
+#define NORMALIZE_MIN_VECTORS (1 << 10) // Number of vectors at the start of the normalization benchmark
+#define NORMALIZE_MAX_VECTORS (1 << 22) // Number of vectors at the end of the normalization benchmark
+#define ROWS_ELEMENTS (1 << 24)         // Number of elements of the matrix in the row normalization benchmark
+#define ROWS_TRIALS 10                  // Number of timed calls per kernel in the row normalization benchmark
+#define FUSED_MIN_N (1 << 12)           // Number of values at the start of the benchmark of the fused kernels
+#define FUSED_MAX_N (1 << 24)           // Number of values at the end of the benchmark of the fused kernels
+#define HALF_MIN_N (1 << 12)            // Number of values at the start of the benchmark of the 16-bit kernels
+#define HALF_MAX_N (1 << 24)            // Number of values at the end of the benchmark of the 16-bit kernels
+#define MIXED_SIZES {1 << 14, 1 << 24}   // Numbers of values in the benchmark of the mixed-precision kernels, in the L1/L2 cache and beyond
+#define CONVERT_SIZES {1 << 14, 1 << 24} // Numbers of values in the benchmark of the mixed-type kernels
+#define MATRIX_SIZES {1 << 14, 1 << 24}  // Numbers of values in the benchmark of the kernel matrix
+#define FORMAT_N (1 << 18)               // Number of values of each type in the benchmark of the output formatter
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <math.h>
 #include <float.h>
 #include <time.h>
+#include <string.h>
+#include <unistd.h>
+#include <immintrin.h>
 #include "../include/tests.h"
 #include "../include/inverse_sqrt.h"
+#include "../include/inverse_sqrt_inline.h"
+#include "../include/cpufeatures.h"
+#include "../include/threadpool.h"
+#include "../include/parser.h"
+#include "../include/bench.h"
+#include "../include/kernelgen.h"
+#include "../include/normalize.h"
+#include "../include/format.h"
 
 void basicFunctionality_flt()
 {
@@ -63,7 +90,38 @@ void basicFunctionality_flt()
     {
         printf("%6.10f ", result[i]);
     }
-    printf("\n\n");
+    printf("\n");
+
+    if (cpu_supports(CPU_AVX2 | CPU_FMA))
+    {
+        fastInvSqrt_flt_AVX2(11, sample, result);
+        printf("AVX2 results:\n");
+        for (size_t i = 0; i < 11; i++)
+        {
+            printf("%6.10f ", result[i]);
+        }
+        printf("\n");
+    }
+
+    if (cpu_supports(CPU_AVX512F))
+    {
+        fastInvSqrt_flt_AVX512(11, sample, result);
+        printf("AVX-512 results:\n");
+        for (size_t i = 0; i < 11; i++)
+        {
+            printf("%6.10f ", result[i]);
+        }
+        printf("\n");
+    }
+
+    fastInvSqrt_flt_Tuned(11, sample, result);
+    printf("Tuned results:\n");
+    for (size_t i = 0; i < 11; i++)
+    {
+        printf("%6.10f ", result[i]);
+    }
+    printf("\n");
+    printf("\n");
 
     free(result);
 }
@@ -113,10 +171,102 @@ void basicFunctionality_dbl()
     {
         printf("%6.10f ", result[i]);
     }
-    printf("\n\n");
+    printf("\n");
+
+    if (cpu_supports(CPU_AVX2 | CPU_FMA))
+    {
+        fastInvSqrt_dbl_AVX2(15, sample, result);
+        printf("AVX2 results:\n");
+        for (size_t i = 0; i < 15; i++)
+        {
+            printf("%6.10f ", result[i]);
+        }
+        printf("\n");
+    }
+
+    if (cpu_supports(CPU_AVX512F))
+    {
+        fastInvSqrt_dbl_AVX512(15, sample, result);
+        printf("AVX-512 results:\n");
+        for (size_t i = 0; i < 15; i++)
+        {
+            printf("%6.10f ", result[i]);
+        }
+        printf("\n");
+    }
+
+    fastInvSqrt_dbl_Tuned(15, sample, result);
+    printf("Tuned results:\n");
+    for (size_t i = 0; i < 15; i++)
+    {
+        printf("%6.10f ", result[i]);
+    }
+    printf("\n");
+    printf("\n");
 
     free(result);
 }
+void specialValues()
+{
+    printf("Testing special values of the versions with special value handling...\n");
+
+    float sample_flt[] = {0.0f, -0.0f, INFINITY, -INFINITY, -1.0f, NAN, FLT_MIN, 4.0f, 0.25f};
+    double sample_dbl[] = {0.0, -0.0, INFINITY, -INFINITY, -1.0, NAN, DBL_MIN, 4.0, 0.25};
+    size_t n = sizeof sample_flt / sizeof *sample_flt;
+    float result_flt[sizeof sample_flt / sizeof *sample_flt];
+    double result_dbl[sizeof sample_dbl / sizeof *sample_dbl];
+    const struct
+    {
+        const char *name;
+        int features; // CpuFeature flags required by the kernels
+        void (*fn_flt)(size_t, float *, float *);
+        void (*fn_dbl)(size_t, double *, double *);
+    } kernels[] = {
+        {"SIMD", CPU_SSE2, fastInvSqrt_flt_Special, fastInvSqrt_dbl_Special},
+        {"AVX2", CPU_AVX2 | CPU_FMA, fastInvSqrt_flt_AVX2_Special, fastInvSqrt_dbl_AVX2_Special},
+        {"AVX-512", CPU_AVX512F, fastInvSqrt_flt_AVX512_Special, fastInvSqrt_dbl_AVX512_Special},
+    };
+
+    printf("Sample:\n");
+    for (size_t i = 0; i < n; i++)
+    {
+        printf("%g ", sample_dbl[i]);
+    }
+    printf("\nExact results (float, double):\n");
+    for (size_t i = 0; i < n; i++)
+    {
+        printf("%g ", 1.0f / sqrtf(sample_flt[i]));
+    }
+    printf("\n");
+    for (size_t i = 0; i < n; i++)
+    {
+        printf("%g ", 1.0 / sqrt(sample_dbl[i]));
+    }
+    printf("\n");
+
+    for (size_t k = 0; k < sizeof kernels / sizeof *kernels; k++)
+    {
+        if (!cpu_supports(kernels[k].features))
+        {
+            continue;
+        }
+        kernels[k].fn_flt(n, sample_flt, result_flt);
+        kernels[k].fn_dbl(n, sample_dbl, result_dbl);
+        printf("%s results (float, double):\n", kernels[k].name);
+        for (size_t i = 0; i < n; i++)
+        {
+            printf("%g ", result_flt[i]);
+        }
+        printf("\n");
+        for (size_t i = 0; i < n; i++)
+        {
+            printf("%g ", result_dbl[i]);
+        }
+        printf("\n");
+    }
+    printf("\n");
+}
+
 void plotRange()
 {
     printf("Generating data for plotting curve and error...\n");
@@ -167,26 +317,100 @@ void plotRange()
     free(sample);
     free(result);
 }
-void benchmarkAccuracy_flt()
+// Error statistics of one block of the accuracy sweep, relative errors in percent
+struct ErrorStats
 {
-    printf("Running benchmark for accuracy of inverse sqrt for floats...\n");
+    double maxUlp;
+    double sumUlp;
+    double maxRel;
+    double sumRel;
+};
 
-    /* Create arrays of size 4 to use for SIMD-optimized function
-    and handle failure of malloc */
-    double maxError = 0.0;
-    float *sample = (float *)malloc(4 * sizeof(float));
-    if (!sample)
+// Arguments of the accuracy tasks: version to test and statistics of every block
+struct AccuracySweep
+{
+    Func fn;
+    struct ErrorStats *blocks;
+};
+
+// Add the error of one result to the statistics
+static inline void add_error(struct ErrorStats *stats, double error, double ulp, double reference)
+{
+    double ulps = error / ulp;
+    double relativeError = 100 * error / reference;
+    stats->maxUlp = ulps > stats->maxUlp ? ulps : stats->maxUlp;
+    stats->sumUlp += ulps;
+    stats->maxRel = relativeError > stats->maxRel ? relativeError : stats->maxRel;
+    stats->sumRel += relativeError;
+}
+
+// Merge the statistics of count blocks into stats
+static void merge_errors(struct ErrorStats *stats, const struct ErrorStats *blocks, size_t count)
+{
+    for (size_t b = 0; b < count; b++)
     {
-        perror("Error allocating memory for sample array");
+        stats->maxUlp = blocks[b].maxUlp > stats->maxUlp ? blocks[b].maxUlp : stats->maxUlp;
+        stats->sumUlp += blocks[b].sumUlp;
+        stats->maxRel = blocks[b].maxRel > stats->maxRel ? blocks[b].maxRel : stats->maxRel;
+        stats->sumRel += blocks[b].sumRel;
+    }
+}
+
+/* Compare the maximum relative error (in %) of the sweep with the bound of version v in the versions table,
+which select_version relies on. Print a message and return 1 if the bound is exceeded */
+static int check_bound(int db, size_t v, double maxRel)
+{
+    if (maxRel / 100 <= versions[db][v].maxError)
+    {
+        return 0;
+    }
+    printf("Version %s:	FAILED, maximum relative error %.3e exceeds the bound %.3e of the versions table\n",
+           versions[db][v].name, maxRel / 100, versions[db][v].maxError);
+    return 1;
+}
+
+// Print whether all bounds of the versions table held in the sweep
+static void print_bounds(int failed)
+{
+    if (failed)
+    {
+        printf("%d error bounds of the versions table exceeded\n", failed);
+    }
+    else
+    {
+        printf("All error bounds of the versions table hold\n");
+    }
+}
+
+// Open the summary and per-binade .csv files of the accuracy sweep, handling fopen failure
+static void open_accuracy_files(const char *summaryPath, const char *binadePath, FILE **summary, FILE **binades)
+{
+    if (!(*summary = fopen(summaryPath, "w+")))
+    {
+        perror("Error opening file");
         exit(EXIT_FAILURE);
-    };
-    float *result = (float *)malloc(4 * sizeof(float));
-    if (!result)
+    }
+    if (!(*binades = fopen(binadePath, "w+")))
     {
-        perror("Error allocating memory for result array");
-        free(sample);
+        perror("Error opening file");
+        fclose(*summary);
         exit(EXIT_FAILURE);
-    };
+    }
+    fprintf(*summary, "version, maxUlp, meanUlp, maxRelError, meanRelError\n");             // print header of .csv file
+    fprintf(*binades, "version, exponent, maxUlp, meanUlp, maxRelError, meanRelError\n"); // print header of .csv file
+}
+
+// Compute the statistics of the floats of blocks [begin, end) of the positive normal floats, block by block through the vector kernel
+static void accuracy_task_flt(size_t begin, size_t end, void *arg)
+{
+    struct AccuracySweep *sweep = arg;
+    float *sample = (float *)malloc(ACCURACY_BLOCK * sizeof(float));
+    float *result = (float *)malloc(ACCURACY_BLOCK * sizeof(float));
+    if (!sample || !result)
+    {
+        perror("Error allocating memory for sample and result arrays");
+        exit(EXIT_FAILURE);
+    }
 
     // union for type-punning within defined behaviour
     union
@@ -194,76 +418,102 @@ void benchmarkAccuracy_flt()
         float f;
         uint32_t x;
     } conv;
-    maxError = 0.0;
-    // Iterate through every possible float by incrementing the integer representation
-    for (conv.x = 0x00800000; conv.x < 0x7f800000; conv.x++)
+    for (size_t b = begin; b < end; b++)
     {
-        sample[0] = conv.f;
-        fastInvSqrt_flt_V1(1, sample, result);
-        float reference = 1.0f / sqrtf(conv.f);
-        // Calculate relative error of implementation compared to 1/sqrt() and update maximum error
-        double relativeError = 100 * fabs(reference - result[0]) / reference;
-        maxError = relativeError > maxError ? relativeError : maxError;
+        // Every float of the block by incrementing the integer representation
+        for (uint32_t i = 0; i < ACCURACY_BLOCK; i++)
+        {
+            conv.x = 0x00800000 + b * ACCURACY_BLOCK + i;
+            sample[i] = conv.f;
+        }
+        sweep->fn.fn_flt(ACCURACY_BLOCK, sample, result);
+
+        struct ErrorStats stats = {0};
+        for (uint32_t i = 0; i < ACCURACY_BLOCK; i++)
+        {
+            double reference = 1.0 / sqrt((double)sample[i]);
+            // ULP of the float closest to the exact result: 2^-23 times its power of two
+            conv.f = (float)reference;
+            conv.x &= 0x7F800000;
+            add_error(&stats, fabs(reference - result[i]), conv.f * 0x1p-23, reference);
+        }
+        sweep->blocks[b] = stats;
     }
-    printf("Scalar Fast Inverse Square Root maximum relative error: \t%10.10f %%\n", maxError);
 
-    maxError = 0.0;
-    // Same as routine as fastInvSqrt_flt_V1
-    for (conv.x = 0x00800000; conv.x < 0x7f800000; conv.x++)
+    free(sample);
+    free(result);
+}
+
+void benchmarkAccuracy_flt()
+{
+    printf("Running benchmark for accuracy of inverse sqrt for floats...\n");
+    printf("Results will be stored in ./benchmark_outputs/results_accuracy_flt.csv and results_accuracy_binades_flt.csv\n");
+
+    FILE *summary;
+    FILE *binades;
+    open_accuracy_files("./benchmark_outputs/results_accuracy_flt.csv", "./benchmark_outputs/results_accuracy_binades_flt.csv", &summary, &binades);
+
+    // All 2^31 - 2^24 positive normal floats in blocks of ACCURACY_BLOCK, 2^23 / ACCURACY_BLOCK blocks per binade
+    const size_t count = 0x7F800000 - 0x00800000;
+    const size_t nblocks = count / ACCURACY_BLOCK;
+    const size_t perBinade = (1 << 23) / ACCURACY_BLOCK;
+    struct ErrorStats *blocks = (struct ErrorStats *)malloc(nblocks * sizeof(struct ErrorStats));
+    if (!blocks)
     {
-        sample[0] = conv.f;
-        fastInvSqrt_flt_DoubleNewton(1, sample, result);
-        float reference = 1.0f / sqrtf(conv.f);
-        double relativeError = 100 * fabs(reference - result[0]) / reference;
-        maxError = relativeError > maxError ? relativeError : maxError;
+        perror("Error allocating memory for error statistics");
+        fclose(summary);
+        fclose(binades);
+        exit(EXIT_FAILURE);
     }
-    printf("2x Newton Fast Inverse Square Root maximum relative error: \t%10.10f %%\n", maxError);
+    pool_init(sysconf(_SC_NPROCESSORS_ONLN));
 
-    maxError = 0.0;
-    // Same routine as above but this time stop incrementing so that the inner for-loop doesnt go above biggest float
-    for (conv.x = 0x00800000; conv.x + 4 < 0x7f800000; conv.x++)
+    int failed = 0;
+    for (size_t v = 0; v < MAX_VERSIONS && versions[0][v].name; v++)
     {
-        // Inner loop fills array with next 4 values to make use of SIMD
-        for (size_t i = 0; i < 4; i++)
+        if (!cpu_supports(versions[0][v].features))
         {
-            sample[i] = conv.f;
-            conv.x++;
+            printf("Version %s:\tnot supported by this CPU\n", versions[0][v].name);
+            continue;
         }
-        fastInvSqrt_flt(4, sample, result);
-        float reference;
-        for (size_t i = 0; i < 4; i++)
+        struct AccuracySweep sweep = {versions[0][v].fn, blocks};
+        pool_run(nblocks, 1, accuracy_task_flt, &sweep);
+
+        struct ErrorStats total = {0};
+        merge_errors(&total, blocks, nblocks);
+        printf("Version %s:\tmaximum error %12.4f ULP, mean error %12.4f ULP, maximum relative error %10.10f %%, mean relative error %10.10f %%\n",
+               versions[0][v].name, total.maxUlp, total.sumUlp / count, total.maxRel, total.sumRel / count);
+        fprintf(summary, "%s, %.6f, %.6f, %.12f, %.12f\n", versions[0][v].name, total.maxUlp, total.sumUlp / count, total.maxRel, total.sumRel / count);
+        failed += check_bound(0, v, total.maxRel);
+
+        // One line per binade [2^exponent, 2^(exponent + 1)) of the input
+        for (size_t b = 0; b < nblocks; b += perBinade)
         {
-            reference = 1.0f / sqrtf(sample[i]);
-            double relativeError = 100 * fabs(reference - result[i]) / reference;
-            maxError = relativeError > maxError ? relativeError : maxError;
+            struct ErrorStats binade = {0};
+            merge_errors(&binade, &blocks[b], perBinade);
+            fprintf(binades, "%s, %d, %.6f, %.6f, %.12f, %.12f\n", versions[0][v].name, (int)(b / perBinade) + 1 - 127,
+                    binade.maxUlp, binade.sumUlp / (1 << 23), binade.maxRel, binade.sumRel / (1 << 23));
         }
     }
-    printf("SIMD Fast Inverse Square Root maximum relative error: \t\t%10.10f %%\n", maxError);
+    print_bounds(failed);
     printf("\n");
 
-    free(result);
-    free(sample);
+    pool_destroy();
+    free(blocks);
+    fclose(summary);
+    fclose(binades);
 }
-void benchmarkAccuracy_dbl()
-{
-    printf("Running benchmark for accuracy of inverse sqrt for doubles...\n");
 
-    /* Create arrays of size 2 to use for SIMD-optimized function
-        and handle failure of malloc */
-    double maxError = 0.0;
-    double *sample = (double *)malloc(2 * sizeof(double));
-    if (!sample)
-    {
-        perror("Error allocating memory for sample array");
-        exit(EXIT_FAILURE);
-    };
-    double *result = (double *)malloc(2 * sizeof(double));
-    if (!result)
+// Compute the statistics of the sampled doubles of binades [begin, end), every binade is one block
+static void accuracy_task_dbl(size_t begin, size_t end, void *arg)
+{
+    struct AccuracySweep *sweep = arg;
+    double *sample = (double *)malloc(ACCURACY_BLOCK * sizeof(double));
+    double *result = (double *)malloc(ACCURACY_BLOCK * sizeof(double));
+    if (!sample || !result)
     {
-        perror("Error allocating memory for result array");
-        free(sample);
+        perror("Error allocating memory for sample and result arrays");
         exit(EXIT_FAILURE);
-    };
+    }
 
     // union for type-punning within defined behaviour
     union
@@ -271,57 +521,109 @@ void benchmarkAccuracy_dbl()
         double d;
         uint64_t x;
     } conv;
-    maxError = 0.0;
-    /* Iterate through doubles by incrementing the integer representation,
-    NOTE that integer representation is incremented by 1llu<<30 to reduce the amount of doubles to test */
-    for (conv.x = 0x10000000000000; conv.x < 0x7ff0000000000000; conv.x += 1llu << 30)
+    for (size_t b = begin; b < end; b++)
     {
-        sample[0] = conv.d;
-        fastInvSqrt_dbl_V1(1, sample, result);
-        double reference = 1.0 / sqrt(conv.d);
-        // Calculate relative error of implementation compared to 1/sqrt() and update maximum error
-        double relativeError = 100 * fabs(reference - result[0]) / reference;
-        maxError = relativeError > maxError ? relativeError : maxError;
+        /* Doubles of the binade are sampled: the upper 16 bits of the mantissa are counted up,
+        the lower 36 bits are filled with a hash so that not only round mantissas are tested */
+        for (uint64_t i = 0; i < ACCURACY_BLOCK; i++)
+        {
+            conv.x = ((b + 1) << 52) + (i << 36) + ((i * 0x9E3779B97F4A7C15) >> 28);
+            sample[i] = conv.d;
+        }
+        sweep->fn.fn_dbl(ACCURACY_BLOCK, sample, result);
+
+        struct ErrorStats stats = {0};
+        for (uint64_t i = 0; i < ACCURACY_BLOCK; i++)
+        {
+            // Reference in extended precision, as 1 / sqrt() in double precision is not exact to the last bit
+            long double reference = 1.0L / sqrtl(sample[i]);
+            conv.d = (double)reference;
+            conv.x &= 0x7FF0000000000000;
+            add_error(&stats, fabsl(reference - result[i]), conv.d * 0x1p-52, reference);
+        }
+        sweep->blocks[b] = stats;
     }
-    printf("Scalar Fast Inverse Square Root maximum relative error: \t%10.10f %%\n", maxError);
 
-    maxError = 0.0;
-    // Same as routine as fastInvSqrt_dbl_V1
-    for (conv.x = 0x10000000000000; conv.x < 0x7ff0000000000000; conv.x += 1llu << 30)
+    free(sample);
+    free(result);
+}
+
+void benchmarkAccuracy_dbl()
+{
+    printf("Running benchmark for accuracy of inverse sqrt for doubles...\n");
+    printf("Results will be stored in ./benchmark_outputs/results_accuracy_dbl.csv and results_accuracy_binades_dbl.csv\n");
+
+    FILE *summary;
+    FILE *binades;
+    open_accuracy_files("./benchmark_outputs/results_accuracy_dbl.csv", "./benchmark_outputs/results_accuracy_binades_dbl.csv", &summary, &binades);
+
+    // ACCURACY_BLOCK samples of each of the 2046 binades of positive normal doubles
+    const size_t nblocks = 2046;
+    const size_t count = nblocks * ACCURACY_BLOCK;
+    struct ErrorStats *blocks = (struct ErrorStats *)malloc(nblocks * sizeof(struct ErrorStats));
+    if (!blocks)
     {
-        sample[0] = conv.d;
-        fastInvSqrt_dbl_DoubleNewton(1, sample, result);
-        double reference = 1.0 / sqrt(conv.d);
-        double relativeError = 100 * fabs(reference - result[0]) / reference;
-        maxError = relativeError > maxError ? relativeError : maxError;
+        perror("Error allocating memory for error statistics");
+        fclose(summary);
+        fclose(binades);
+        exit(EXIT_FAILURE);
     }
-    printf("2x Newton Fast Inverse Square Root maximum relative error: \t%10.10f %%\n", maxError);
+    pool_init(sysconf(_SC_NPROCESSORS_ONLN));
 
-    maxError = 0.0;
-    // Same routine as above but this time stop incrementing so that the inner for-loop doesnt go above biggest double
-    for (conv.x = 0x10000000000000; conv.x + 2 < 0x7ff0000000000000; conv.x += 1llu << 30)
+    int failed = 0;
+    for (size_t v = 0; v < MAX_VERSIONS && versions[1][v].name; v++)
     {
-        // Inner loop fills array with next 2 values to make use of SIMD
-        for (size_t i = 0; i < 2; i++)
+        if (!cpu_supports(versions[1][v].features))
         {
-            sample[i] = conv.d;
-            conv.x++;
+            printf("Version %s:\tnot supported by this CPU\n", versions[1][v].name);
+            continue;
         }
-        fastInvSqrt_dbl(2, sample, result);
-        double reference;
-        for (size_t i = 0; i < 2; i++)
+        struct AccuracySweep sweep = {versions[1][v].fn, blocks};
+        pool_run(nblocks, 1, accuracy_task_dbl, &sweep);
+
+        struct ErrorStats total = {0};
+        merge_errors(&total, blocks, nblocks);
+        printf("Version %s:\tmaximum error %12.4f ULP, mean error %12.4f ULP, maximum relative error %10.10f %%, mean relative error %10.10f %%\n",
+               versions[1][v].name, total.maxUlp, total.sumUlp / count, total.maxRel, total.sumRel / count);
+        fprintf(summary, "%s, %.6f, %.6f, %.12f, %.12f\n", versions[1][v].name, total.maxUlp, total.sumUlp / count, total.maxRel, total.sumRel / count);
+        failed += check_bound(1, v, total.maxRel);
+
+        for (size_t b = 0; b < nblocks; b++)
         {
-            reference = 1.0 / sqrt(sample[i]);
-            double relativeError = 100 * fabs(reference - result[i]) / reference;
-            maxError = relativeError > maxError ? relativeError : maxError;
+            fprintf(binades, "%s, %d, %.6f, %.6f, %.12f, %.12f\n", versions[1][v].name, (int)b + 1 - 1023,
+                    blocks[b].maxUlp, blocks[b].sumUlp / ACCURACY_BLOCK, blocks[b].maxRel, blocks[b].sumRel / ACCURACY_BLOCK);
         }
     }
-    printf("SIMD Fast Inverse Square Root maximum relative error: \t\t%10.10f %%\n", maxError);
-
+    print_bounds(failed);
     printf("\n");
 
-    free(result);
-    free(sample);
+    pool_destroy();
+    free(blocks);
+    fclose(summary);
+    fclose(binades);
+}
+/* Measure the reference implementations and every version of the versions table supported by the CPU
+on the same sample and write one line per kernel to file */
+static void benchmarkVersions(int db, int sampleSize, void *sample, void *result, FILE *file)
+{
+    struct BenchResult res;
+    Func native = db ? (Func){.fn_dbl = nativeSqrt_dbl} : (Func){.fn_flt = nativeSqrt_flt};
+    Func doubleNewton = db ? (Func){.fn_dbl = fastInvSqrt_dbl_DoubleNewton} : (Func){.fn_flt = fastInvSqrt_flt_DoubleNewton};
+
+    bench_run(db, native, sampleSize, sample, result, &res);
+    bench_print(file, sampleSize, "native", &res);
+    bench_run(db, doubleNewton, sampleSize, sample, result, &res);
+    bench_print(file, sampleSize, "2Newton", &res);
+
+    for (size_t v = 0; v < MAX_VERSIONS && versions[db][v].name; v++)
+    {
+        // Versions which are not supported by the CPU are left out
+        if (cpu_supports(versions[db][v].features))
+        {
+            bench_run(db, versions[db][v].fn, sampleSize, sample, result, &res);
+            bench_print(file, sampleSize, versions[db][v].name, &res);
+        }
+    }
 }
 void benchmarkTime_flt_wrapper(int maxIncrements)
 {
@@ -335,7 +637,7 @@ void benchmarkTime_flt_wrapper(int maxIncrements)
     {
         printf("Running runtime benchmark for float algorithms...\n");
         printf("Results will be stored in ./benchmark_outputs/results_speed_flt.csv\n\n");
-        fprintf(file, "sampleSize, timeNative, timeFISQ, time2Newton, timeSSE\n"); // print header for .csv file
+        bench_print_header(file); // print header for .csv file
 
         /* Runs the time benchmark for certain array sizes. maxIncrements determines
         how often the benchmark is run and how often the array size is incread.
@@ -349,14 +651,6 @@ void benchmarkTime_flt_wrapper(int maxIncrements)
 }
 void benchmarkTime_flt(int sampleSize, FILE **file)
 {
-    // Variables to store runtime
-    double timeNative = 0.0;
-    double timeV1 = 0.0;
-    double timeSSE = 0.0;
-    double time2Newton = 0.0;
-    struct timespec start;
-    struct timespec stop;
-
     srand(time(0));
 
     // Create array with samples and output array and handle malloc failures
@@ -386,47 +680,7 @@ void benchmarkTime_flt(int sampleSize, FILE **file)
         sample[i] = ((float)rand() / RAND_MAX) * pow(10, (rand() % 20 - 10));
     }
 
-    /* Mark time before for-loop, then run function TRIALS times.
-    Stop time and divide total time by TRIALS to get avg time
-    Repeat for every implementation. */
-    clock_gettime(CLOCK_MONOTONIC, &start);
-    for (int i = 0; i < TRIALS; i++)
-    {
-        nativeSqrt_flt(sampleSize, sample, result);
-    }
-    clock_gettime(CLOCK_MONOTONIC, &stop);
-    timeNative += (stop.tv_sec - start.tv_sec + 1e-9 * (stop.tv_nsec - start.tv_nsec));
-    timeNative /= TRIALS;
-
-    clock_gettime(CLOCK_MONOTONIC, &start);
-    for (int i = 0; i < TRIALS; i++)
-    {
-        fastInvSqrt_flt_V1(sampleSize, sample, result);
-    }
-    clock_gettime(CLOCK_MONOTONIC, &stop);
-    timeV1 += (stop.tv_sec - start.tv_sec + 1e-9 * (stop.tv_nsec - start.tv_nsec));
-    timeV1 /= TRIALS;
-
-    clock_gettime(CLOCK_MONOTONIC, &start);
-    for (int i = 0; i < TRIALS; i++)
-    {
-        fastInvSqrt_flt_DoubleNewton(sampleSize, sample, result);
-    }
-    clock_gettime(CLOCK_MONOTONIC, &stop);
-    time2Newton += (stop.tv_sec - start.tv_sec + 1e-9 * (stop.tv_nsec - start.tv_nsec));
-    time2Newton /= TRIALS;
-
-    clock_gettime(CLOCK_MONOTONIC, &start);
-    for (int i = 0; i < TRIALS; i++)
-    {
-        fastInvSqrt_flt(sampleSize, sample, result);
-    }
-    clock_gettime(CLOCK_MONOTONIC, &stop);
-    timeSSE += (stop.tv_sec - start.tv_sec + 1e-9 * (stop.tv_nsec - start.tv_nsec));
-    timeSSE /= TRIALS;
-
-    // Print sample size and times to .csv
-    fprintf(*file, "%i, %10.10f, %10.10f, %10.10f, %10.10f\n", sampleSize, timeNative, timeV1, time2Newton, timeSSE);
+    benchmarkVersions(0, sampleSize, sample, result, *file);
 
     free(sample);
     free(result);
@@ -443,7 +697,7 @@ void benchmarkTime_dbl_wrapper(int maxIncrements)
     {
         printf("Running runtime benchmark for float algorithms...\n");
         printf("Results will be stored in ./benchmark_outputs/results_speed_dbl.csv\n\n");
-        fprintf(file, "sampleSize, timeNative, timeFISQ, time2Newton, timeSSE\n"); // print header for .csv files
+        bench_print_header(file); // print header for .csv file
 
         /* Runs the time benchmark for certain array sizes. maxIncrements determines
         how often the benchmark is run and how often the array size is incread.
@@ -457,14 +711,6 @@ void benchmarkTime_dbl_wrapper(int maxIncrements)
 }
 void benchmarkTime_dbl(int sampleSize, FILE **file)
 {
-    // Variables to store runtime
-    double timeNative = 0.0;
-    double timeV1 = 0.0;
-    double timeSSE = 0.0;
-    double time2Newton = 0.0;
-    struct timespec start;
-    struct timespec stop;
-
     srand(time(0));
 
     // Create array with samples and output array and handle malloc failures
@@ -494,55 +740,1479 @@ void benchmarkTime_dbl(int sampleSize, FILE **file)
         sample[i] = ((double)rand() / RAND_MAX) * pow(10, (rand() % 20 - 10));
     }
 
-    /* Mark time before for-loop, then run function TRIALS times.
-    Stop time and divide total time by TRIALS to get avg time
-    Repeat for every implementation. */
-    clock_gettime(CLOCK_MONOTONIC, &start);
-    for (int i = 0; i < TRIALS; i++)
+    benchmarkVersions(1, sampleSize, sample, result, *file);
+
+    free(sample);
+    free(result);
+}
+void benchmarkThreads(int sampleSize)
+{
+    FILE *file;
+    if (!(file = fopen("./benchmark_outputs/results_threads.csv", "w+")))
     {
-        nativeSqrt_dbl(sampleSize, sample, result);
+        perror("Error opening file");
+        exit(EXIT_FAILURE);
     }
-    clock_gettime(CLOCK_MONOTONIC, &stop);
-    timeNative += (stop.tv_sec - start.tv_sec + 1e-9 * (stop.tv_nsec - start.tv_nsec));
-    timeNative /= TRIALS;
+    printf("Running thread scaling benchmark...\n");
+    printf("Results will be stored in ./benchmark_outputs/results_threads.csv\n\n");
+    fprintf(file, "threads, timeSSE_flt, timeSSE_dbl\n"); // print header for .csv file
+
+    srand(time(0));
 
-    clock_gettime(CLOCK_MONOTONIC, &start);
-    for (int i = 0; i < TRIALS; i++)
+    // Create arrays with samples and output arrays and handle malloc failures
+    float *sample_flt = (float *)malloc(sampleSize * sizeof(float));
+    float *result_flt = (float *)malloc(sampleSize * sizeof(float));
+    double *sample_dbl = (double *)malloc(sampleSize * sizeof(double));
+    double *result_dbl = (double *)malloc(sampleSize * sizeof(double));
+    if (!sample_flt || !result_flt || !sample_dbl || !result_dbl)
+    {
+        perror("Error allocating memory for sample and result arrays");
+        free(sample_flt);
+        free(result_flt);
+        free(sample_dbl);
+        free(result_dbl);
+        fclose(file);
+        exit(EXIT_FAILURE);
+    };
+    for (int i = 0; i < sampleSize; i++)
     {
-        fastInvSqrt_dbl_V1(sampleSize, sample, result);
+        sample_dbl[i] = ((double)rand() / RAND_MAX) * pow(10, (rand() % 20 - 10));
+        sample_flt[i] = (float)sample_dbl[i];
     }
-    clock_gettime(CLOCK_MONOTONIC, &stop);
-    timeV1 += (stop.tv_sec - start.tv_sec + 1e-9 * (stop.tv_nsec - start.tv_nsec));
-    timeV1 /= TRIALS;
 
-    clock_gettime(CLOCK_MONOTONIC, &start);
-    for (int i = 0; i < TRIALS; i++)
+    // Double the number of threads until all cores are used, the last step always uses all cores
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    for (long threads = 1;; threads = threads * 2 < cores ? threads * 2 : cores)
     {
-        fastInvSqrt_dbl_DoubleNewton(sampleSize, sample, result);
+        pool_init(threads);
+        double timeFlt = 0.0;
+        double timeDbl = 0.0;
+        struct timespec start;
+        struct timespec stop;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < TRIALS; i++)
+        {
+            parallelInvSqrt_flt(fastInvSqrt_flt, sampleSize, sample_flt, result_flt);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+        timeFlt += (stop.tv_sec - start.tv_sec + 1e-9 * (stop.tv_nsec - start.tv_nsec));
+        timeFlt /= TRIALS;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < TRIALS; i++)
+        {
+            parallelInvSqrt_dbl(fastInvSqrt_dbl, sampleSize, sample_dbl, result_dbl);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+        timeDbl += (stop.tv_sec - start.tv_sec + 1e-9 * (stop.tv_nsec - start.tv_nsec));
+        timeDbl /= TRIALS;
+
+        fprintf(file, "%ld, %10.10f, %10.10f\n", threads, timeFlt, timeDbl);
+        if (threads >= cores)
+        {
+            break;
+        }
     }
-    clock_gettime(CLOCK_MONOTONIC, &stop);
-    time2Newton += (stop.tv_sec - start.tv_sec + 1e-9 * (stop.tv_nsec - start.tv_nsec));
-    time2Newton /= TRIALS;
+    pool_destroy();
+
+    fclose(file);
+    free(sample_flt);
+    free(result_flt);
+    free(sample_dbl);
+    free(result_dbl);
+}
+// Bandwidth references of the size sweep: memcpy moves the same bytes as a kernel, the triad reads 2 and writes 1 array like STREAM
+static void copy_flt(size_t n, float vals[n], float out[n])
+{
+    memcpy(out, vals, n * sizeof(float));
+}
+
+static void copy_dbl(size_t n, double vals[n], double out[n])
+{
+    memcpy(out, vals, n * sizeof(double));
+}
 
-    clock_gettime(CLOCK_MONOTONIC, &start);
-    for (int i = 0; i < TRIALS; i++)
+// The triad uses SSE like version 0, -O2 does not vectorize the loop, which would make it a compute-bound reference
+static void triad_flt(size_t n, float vals[n], float out[n])
+{
+    const __m128 half = _mm_set1_ps(0.5f);
+    size_t i;
+    for (i = 0; i < (n & ~3ul); i += 4)
+    {
+        _mm_storeu_ps(&out[i], _mm_add_ps(_mm_loadu_ps(&vals[i]), _mm_mul_ps(half, _mm_loadu_ps(&out[i]))));
+    }
+    for (; i < n; i++)
     {
-        fastInvSqrt_dbl(sampleSize, sample, result);
+        out[i] = vals[i] + 0.5f * out[i];
     }
-    clock_gettime(CLOCK_MONOTONIC, &stop);
-    timeSSE += (stop.tv_sec - start.tv_sec + 1e-9 * (stop.tv_nsec - start.tv_nsec));
-    timeSSE /= TRIALS;
-    // Print sample size and times to .csv
-    fprintf(*file, "%i, %10.10f, %10.10f, %10.10f, %10.10f\n", sampleSize, timeNative, timeV1, time2Newton, timeSSE);
+}
 
-    free(sample);
-    free(result);
+static void triad_dbl(size_t n, double vals[n], double out[n])
+{
+    const __m128d half = _mm_set1_pd(0.5);
+    size_t i;
+    for (i = 0; i < (n & ~1ul); i += 2)
+    {
+        _mm_storeu_pd(&out[i], _mm_add_pd(_mm_loadu_pd(&vals[i]), _mm_mul_pd(half, _mm_loadu_pd(&out[i]))));
+    }
+    for (; i < n; i++)
+    {
+        out[i] = vals[i] + 0.5 * out[i];
+    }
 }
+
+void benchmarkSizes(int db)
+{
+    const char *path = db ? "./benchmark_outputs/results_sizes_dbl.csv" : "./benchmark_outputs/results_sizes_flt.csv";
+    FILE *file;
+    if (!(file = fopen(path, "w+")))
+    {
+        perror("Error opening file");
+        exit(EXIT_FAILURE);
+    }
+    printf("Running cache size sweep for %s...\n", db ? "doubles" : "floats");
+    printf("Results will be stored in %s\n\n", path);
+    fprintf(file, "bytes, sampleSize, version, timeMedian, cyclesPerElement, GBps, fractionCopy, fractionTriad\n"); // print header for .csv file
+
+    // Largest array size: power of two up to SWEEP_MAX_BYTES, so that input and output take at most half of the memory
+    size_t elem = db ? sizeof(double) : sizeof(float);
+    size_t maxBytes = SWEEP_MAX_BYTES;
+    size_t memory = (size_t)sysconf(_SC_PHYS_PAGES) * (size_t)sysconf(_SC_PAGESIZE);
+    while (maxBytes > SWEEP_MIN_BYTES && 4 * maxBytes > memory)
+    {
+        maxBytes /= 2;
+    }
+
+    // Create arrays with samples and output arrays and handle malloc failures, smaller sizes use the beginning of the arrays
+    void *sample = aligned_alloc(CACHE_LINE, maxBytes);
+    void *result = aligned_alloc(CACHE_LINE, maxBytes);
+    if (!sample || !result)
+    {
+        perror("Error allocating memory for sample and result arrays");
+        free(sample);
+        free(result);
+        fclose(file);
+        exit(EXIT_FAILURE);
+    }
+    // The size of the numbers has no effect on speed, so a cheap pattern is used instead of rand() for the large arrays
+    for (size_t i = 0; i < maxBytes / elem; i++)
+    {
+        double value = ((i * 2654435761u) % 1000000 + 1) * 1e-3;
+        if (db)
+        {
+            ((double *)sample)[i] = value;
+            ((double *)result)[i] = 0.0;
+        }
+        else
+        {
+            ((float *)sample)[i] = value;
+            ((float *)result)[i] = 0.0f;
+        }
+    }
+
+    Func copy = db ? (Func){.fn_dbl = copy_dbl} : (Func){.fn_flt = copy_flt};
+    Func triad = db ? (Func){.fn_dbl = triad_dbl} : (Func){.fn_flt = triad_flt};
+    Func native = db ? (Func){.fn_dbl = nativeSqrt_dbl} : (Func){.fn_flt = nativeSqrt_flt};
+
+    // Double the size of the arrays from L1-resident to DRAM-resident
+    for (size_t bytes = SWEEP_MIN_BYTES; bytes <= maxBytes; bytes *= 2)
+    {
+        size_t n = bytes / elem;
+        struct BenchResult res;
+        struct BenchResult copyRes;
+        struct BenchResult triadRes;
+        bench_run(db, copy, n, sample, result, &copyRes);
+        bench_run(db, triad, n, sample, result, &triadRes);
+        double copyGBps = copyRes.gbps;
+        double triadGBps = 3 * bytes / triadRes.median * 1e-9; // The triad moves 3 arrays
+        fprintf(file, "%zu, %zu, memcpy, %10.10f, %.4f, %.4f, 1.0000, %.4f\n", 2 * bytes, n, copyRes.median, copyRes.cyclesPerElement,
+                copyGBps, copyGBps / triadGBps);
+        fprintf(file, "%zu, %zu, triad, %10.10f, %.4f, %.4f, %.4f, 1.0000\n", 2 * bytes, n, triadRes.median, triadRes.cyclesPerElement,
+                triadGBps, triadGBps / copyGBps);
+
+        // Throughput of every kernel as fraction of the bandwidth of memcpy and triad at the same size
+        bench_run(db, native, n, sample, result, &res);
+        fprintf(file, "%zu, %zu, native, %10.10f, %.4f, %.4f, %.4f, %.4f\n", 2 * bytes, n, res.median, res.cyclesPerElement,
+                res.gbps, res.gbps / copyGBps, res.gbps / triadGBps);
+        for (size_t v = 0; v < MAX_VERSIONS && versions[db][v].name; v++)
+        {
+            if (cpu_supports(versions[db][v].features))
+            {
+                bench_run(db, versions[db][v].fn, n, sample, result, &res);
+                fprintf(file, "%zu, %zu, %s, %10.10f, %.4f, %.4f, %.4f, %.4f\n", 2 * bytes, n, versions[db][v].name, res.median,
+                        res.cyclesPerElement, res.gbps, res.gbps / copyGBps, res.gbps / triadGBps);
+            }
+            // Variant with non-temporal stores, which the dispatcher uses above the size of the last-level cache
+            if (cpu_supports(versions[db][v].features) && versions[db][v].stream.fn_flt)
+            {
+                bench_run(db, versions[db][v].stream, n, sample, result, &res);
+                fprintf(file, "%zu, %zu, %s-NT, %10.10f, %.4f, %.4f, %.4f, %.4f\n", 2 * bytes, n, versions[db][v].name, res.median,
+                        res.cyclesPerElement, res.gbps, res.gbps / copyGBps, res.gbps / triadGBps);
+            }
+        }
+    }
+
+    free(sample);
+    free(result);
+    fclose(file);
+}
+// Kernel called through a function pointer in the dependent chains of the latency benchmark
+struct LatencyKernel
+{
+    int db;
+    Func fn;
+};
+
+static void chain_kernel(const void *arg, size_t n, void *buf, size_t calls)
+{
+    const struct LatencyKernel *kernel = arg;
+    for (size_t c = 0; c < calls; c++)
+    {
+        if (kernel->db)
+        {
+            kernel->fn.fn_dbl(n, buf, buf);
+        }
+        else
+        {
+            kernel->fn.fn_flt(n, buf, buf);
+        }
+    }
+}
+
+// Chains with the inline API, the loops of fastInvSqrtSmall are inlined into the chain
+static void chain_inline_flt(const void *arg, size_t n, void *buf, size_t calls)
+{
+    (void)arg;
+    for (size_t c = 0; c < calls; c++)
+    {
+        fastInvSqrtSmall_flt(n, buf, buf);
+    }
+}
+
+static void chain_inline_dbl(const void *arg, size_t n, void *buf, size_t calls)
+{
+    (void)arg;
+    for (size_t c = 0; c < calls; c++)
+    {
+        fastInvSqrtSmall_dbl(n, buf, buf);
+    }
+}
+
+// Write one line of the latency benchmark, the buffer is reset so that every chain starts from the same values
+static void latency_row(FILE *file, int db, BenchChain chain, const void *arg, size_t n, void *buf, const char *name)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        if (db)
+        {
+            ((double *)buf)[i] = 1.0 + i;
+        }
+        else
+        {
+            ((float *)buf)[i] = 1.0f + i;
+        }
+    }
+    double cycles = bench_latency(chain, arg, n, buf);
+    fprintf(file, "%zu, %s, %.2f, %.4f\n", n, name, cycles, cycles / n);
+}
+
+void benchmarkLatency(int db)
+{
+    const char *path = db ? "./benchmark_outputs/results_latency_dbl.csv" : "./benchmark_outputs/results_latency_flt.csv";
+    FILE *file;
+    if (!(file = fopen(path, "w+")))
+    {
+        perror("Error opening file");
+        exit(EXIT_FAILURE);
+    }
+    printf("Running small batch latency benchmark for %s...\n", db ? "doubles" : "floats");
+    printf("Results will be stored in %s\n\n", path);
+    fprintf(file, "sampleSize, version, cyclesPerCall, cyclesPerElement\n"); // print header for .csv file
+
+    // Aligned, because version 0 stores with aligned SSE instructions
+    void *buf = aligned_alloc(CACHE_LINE, LATENCY_MAX_N * sizeof(double));
+    if (!buf)
+    {
+        perror("Error allocating memory for latency buffer");
+        fclose(file);
+        exit(EXIT_FAILURE);
+    }
+
+    struct LatencyKernel native = {db, db ? (Func){.fn_dbl = nativeSqrt_dbl} : (Func){.fn_flt = nativeSqrt_flt}};
+    BenchChain inlineChain = db ? chain_inline_dbl : chain_inline_flt;
+    for (size_t n = 1; n <= LATENCY_MAX_N; n++)
+    {
+        latency_row(file, db, chain_kernel, &native, n, buf, "native");
+        for (size_t v = 0; v < MAX_VERSIONS && versions[db][v].name; v++)
+        {
+            if (cpu_supports(versions[db][v].features))
+            {
+                struct LatencyKernel kernel = {db, versions[db][v].fn};
+                latency_row(file, db, chain_kernel, &kernel, n, buf, versions[db][v].name);
+            }
+        }
+        latency_row(file, db, inlineChain, NULL, n, buf, "inline");
+    }
+
+    free(buf);
+    fclose(file);
+}
+
+/* Normalization as it is done without the fused kernels: squared lengths, fastInvSqrt on them and scaling,
+each in its own pass. The first n elements of out are the temporary array, the scaling runs backwards so that
+every factor is read before its position is overwritten. */
+static void unfused_flt(size_t n, float vals[], float out[])
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        out[i] = vals[3 * i] * vals[3 * i] + vals[3 * i + 1] * vals[3 * i + 1] + vals[3 * i + 2] * vals[3 * i + 2];
+    }
+    fastInvSqrt_flt(n, out, out);
+    for (size_t i = n; i-- > 0;)
+    {
+        float s = out[i];
+        out[3 * i] = vals[3 * i] * s;
+        out[3 * i + 1] = vals[3 * i + 1] * s;
+        out[3 * i + 2] = vals[3 * i + 2] * s;
+    }
+}
+
+static void unfused_dbl(size_t n, double vals[], double out[])
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        out[i] = vals[3 * i] * vals[3 * i] + vals[3 * i + 1] * vals[3 * i + 1] + vals[3 * i + 2] * vals[3 * i + 2];
+    }
+    fastInvSqrt_dbl(n, out, out);
+    for (size_t i = n; i-- > 0;)
+    {
+        double s = out[i];
+        out[3 * i] = vals[3 * i] * s;
+        out[3 * i + 1] = vals[3 * i + 1] * s;
+        out[3 * i + 2] = vals[3 * i + 2] * s;
+    }
+}
+
+// Wrappers with the kernel signature, so that bench_run can measure them. vals and out hold 3 * n values.
+static void aos_flt(size_t n, float vals[], float out[])
+{
+    normalizeAoS_flt(n, vals, out);
+}
+
+static void aos_flt_DoubleNewton(size_t n, float vals[], float out[])
+{
+    normalizeAoS_flt_DoubleNewton(n, vals, out);
+}
+
+static void soa_flt(size_t n, float vals[], float out[])
+{
+    normalizeSoA_flt(n, vals, vals + n, vals + 2 * n, out, out + n, out + 2 * n);
+}
+
+static void soa_flt_DoubleNewton(size_t n, float vals[], float out[])
+{
+    normalizeSoA_flt_DoubleNewton(n, vals, vals + n, vals + 2 * n, out, out + n, out + 2 * n);
+}
+
+static void aos_dbl(size_t n, double vals[], double out[])
+{
+    normalizeAoS_dbl(n, vals, out);
+}
+
+static void aos_dbl_DoubleNewton(size_t n, double vals[], double out[])
+{
+    normalizeAoS_dbl_DoubleNewton(n, vals, out);
+}
+
+static void soa_dbl(size_t n, double vals[], double out[])
+{
+    normalizeSoA_dbl(n, vals, vals + n, vals + 2 * n, out, out + n, out + 2 * n);
+}
+
+static void soa_dbl_DoubleNewton(size_t n, double vals[], double out[])
+{
+    normalizeSoA_dbl_DoubleNewton(n, vals, vals + n, vals + 2 * n, out, out + n, out + 2 * n);
+}
+
+static const struct
+{
+    const char *name;
+    int soa; // 1 if the vectors are stored as separate arrays of the components
+    Func fn[2];
+} normalizers[] = {
+    {"unfused", 0, {{.fn_flt = unfused_flt}, {.fn_dbl = unfused_dbl}}},
+    {"AoS", 0, {{.fn_flt = aos_flt}, {.fn_dbl = aos_dbl}}},
+    {"AoS_DoubleNewton", 0, {{.fn_flt = aos_flt_DoubleNewton}, {.fn_dbl = aos_dbl_DoubleNewton}}},
+    {"SoA", 1, {{.fn_flt = soa_flt}, {.fn_dbl = soa_dbl}}},
+    {"SoA_DoubleNewton", 1, {{.fn_flt = soa_flt_DoubleNewton}, {.fn_dbl = soa_dbl_DoubleNewton}}},
+};
+
+// Largest deviation of the length of the n normalized vectors in out from 1, computed in double precision
+static double length_error(int db, int soa, size_t n, const void *out)
+{
+    double maxError = 0.0;
+    for (size_t i = 0; i < n; i++)
+    {
+        double c[3];
+        for (size_t k = 0; k < 3; k++)
+        {
+            size_t index = soa ? k * n + i : 3 * i + k;
+            c[k] = db ? ((const double *)out)[index] : ((const float *)out)[index];
+        }
+        double error = fabs(sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]) - 1.0);
+        maxError = error > maxError ? error : maxError;
+    }
+    return maxError;
+}
+
+void benchmarkNormalize(int db)
+{
+    const char *path = db ? "./benchmark_outputs/results_normalize_dbl.csv" : "./benchmark_outputs/results_normalize_flt.csv";
+    FILE *file;
+    if (!(file = fopen(path, "w+")))
+    {
+        perror("Error opening file");
+        exit(EXIT_FAILURE);
+    }
+    printf("Running 3D vector normalization benchmark for %s...\n", db ? "doubles" : "floats");
+    printf("Results will be stored in %s\n\n", path);
+    fprintf(file, "vectors, version, timeMedian, nsPerVector, GBps, maxLengthError\n"); // print header for .csv file
+
+    // Create arrays with random components in [-1, 1] and handle malloc failures, smaller sizes use the beginning of the arrays
+    size_t elem = db ? sizeof(double) : sizeof(float);
+    void *sample = aligned_alloc(CACHE_LINE, 3 * NORMALIZE_MAX_VECTORS * elem);
+    void *result = aligned_alloc(CACHE_LINE, 3 * NORMALIZE_MAX_VECTORS * elem);
+    if (!sample || !result)
+    {
+        perror("Error allocating memory for sample and result arrays");
+        free(sample);
+        free(result);
+        fclose(file);
+        exit(EXIT_FAILURE);
+    }
+    srand(time(0));
+    for (size_t i = 0; i < 3 * NORMALIZE_MAX_VECTORS; i++)
+    {
+        double value = 2.0 * rand() / RAND_MAX - 1.0;
+        if (db)
+        {
+            ((double *)sample)[i] = value;
+        }
+        else
+        {
+            ((float *)sample)[i] = value;
+        }
+    }
+
+    for (size_t n = NORMALIZE_MIN_VECTORS; n <= NORMALIZE_MAX_VECTORS; n *= 16)
+    {
+        for (size_t v = 0; v < sizeof normalizers / sizeof *normalizers; v++)
+        {
+            struct BenchResult res;
+            bench_run(db, normalizers[v].fn[db], n, sample, result, &res);
+            double gbps = 6 * n * elem / res.median * 1e-9; // 3 components are read and written per vector
+            fprintf(file, "%zu, %s, %10.10f, %.4f, %.4f, %.3e\n", n, normalizers[v].name, res.median, res.median / n * 1e9, gbps,
+                    length_error(db, normalizers[v].soa, n, result));
+        }
+    }
+
+    free(sample);
+    free(result);
+    fclose(file);
+}
+
+// Row normalization without the fused kernel: squared norms into norms, fastInvSqrt on them and scaling of the rows
+static void unfusedRows_flt(size_t rows, size_t cols, float *matrix, float *norms)
+{
+    for (size_t i = 0; i < rows; i++)
+    {
+        float sum = 0.0f;
+        for (size_t j = 0; j < cols; j++)
+        {
+            sum += matrix[i * cols + j] * matrix[i * cols + j];
+        }
+        norms[i] = sum;
+    }
+    fastInvSqrt_flt(rows, norms, norms);
+    for (size_t i = 0; i < rows; i++)
+    {
+        for (size_t j = 0; j < cols; j++)
+        {
+            matrix[i * cols + j] *= norms[i];
+        }
+    }
+}
+
+static void unfusedRows_dbl(size_t rows, size_t cols, double *matrix, double *norms)
+{
+    for (size_t i = 0; i < rows; i++)
+    {
+        double sum = 0.0;
+        for (size_t j = 0; j < cols; j++)
+        {
+            sum += matrix[i * cols + j] * matrix[i * cols + j];
+        }
+        norms[i] = sum;
+    }
+    fastInvSqrt_dbl(rows, norms, norms);
+    for (size_t i = 0; i < rows; i++)
+    {
+        for (size_t j = 0; j < cols; j++)
+        {
+            matrix[i * cols + j] *= norms[i];
+        }
+    }
+}
+
+// Normalize the matrix with version v (0 = unfused, 1 = normalizeRows, 2 = normalizeRows_DoubleNewton)
+static void normalizeRowsVersion(int db, int v, size_t rows, size_t cols, void *matrix, void *norms)
+{
+    if (v == 0)
+    {
+        db ? unfusedRows_dbl(rows, cols, matrix, norms) : unfusedRows_flt(rows, cols, matrix, norms);
+    }
+    else if (v == 1)
+    {
+        db ? normalizeRows_dbl(rows, cols, cols, matrix) : normalizeRows_flt(rows, cols, cols, matrix);
+    }
+    else
+    {
+        db ? normalizeRows_dbl_DoubleNewton(rows, cols, cols, matrix) : normalizeRows_flt_DoubleNewton(rows, cols, cols, matrix);
+    }
+}
+
+void benchmarkRows(int db)
+{
+    const char *path = db ? "./benchmark_outputs/results_rows_dbl.csv" : "./benchmark_outputs/results_rows_flt.csv";
+    const char *names[] = {"unfused", "normalizeRows", "normalizeRows_DoubleNewton"};
+    FILE *file;
+    if (!(file = fopen(path, "w+")))
+    {
+        perror("Error opening file");
+        exit(EXIT_FAILURE);
+    }
+    printf("Running row normalization benchmark for %s...\n", db ? "doubles" : "floats");
+    printf("Results will be stored in %s\n\n", path);
+    fprintf(file, "cols, rows, threads, version, timeMean, GBps, maxNormError\n"); // print header for .csv file
+
+    size_t elem = db ? sizeof(double) : sizeof(float);
+    void *matrix = aligned_alloc(CACHE_LINE, ROWS_ELEMENTS * elem);
+    void *norms = aligned_alloc(CACHE_LINE, ROWS_ELEMENTS / 64 * elem);
+    if (!matrix || !norms)
+    {
+        perror("Error allocating memory for matrix");
+        free(matrix);
+        free(norms);
+        fclose(file);
+        exit(EXIT_FAILURE);
+    }
+    srand(time(0));
+
+    // The fused kernels run single-threaded and on all cores, the unfused version only single-threaded
+    long threadCounts[] = {1, sysconf(_SC_NPROCESSORS_ONLN)};
+    for (size_t cols = 64; cols <= 4096; cols *= 4)
+    {
+        size_t rows = ROWS_ELEMENTS / cols;
+        for (int v = 0; v < 3; v++)
+        {
+            for (int t = 0; t < (v && threadCounts[1] > 1 ? 2 : 1); t++)
+            {
+                long threads = threadCounts[t];
+                pool_init(threads);
+                for (size_t i = 0; i < ROWS_ELEMENTS; i++)
+                {
+                    double value = 2.0 * rand() / RAND_MAX - 1.0;
+                    if (db)
+                    {
+                        ((double *)matrix)[i] = value;
+                    }
+                    else
+                    {
+                        ((float *)matrix)[i] = value;
+                    }
+                }
+
+                // The error is measured after the first call, the timed calls normalize the already normalized rows again
+                normalizeRowsVersion(db, v, rows, cols, matrix, norms);
+                double maxError = 0.0;
+                for (size_t i = 0; i < rows; i++)
+                {
+                    double sum = 0.0;
+                    for (size_t j = 0; j < cols; j++)
+                    {
+                        double x = db ? ((double *)matrix)[i * cols + j] : ((float *)matrix)[i * cols + j];
+                        sum += x * x;
+                    }
+                    maxError = fmax(maxError, fabs(sqrt(sum) - 1.0));
+                }
+
+                struct timespec start;
+                struct timespec stop;
+                clock_gettime(CLOCK_MONOTONIC, &start);
+                for (int i = 0; i < ROWS_TRIALS; i++)
+                {
+                    normalizeRowsVersion(db, v, rows, cols, matrix, norms);
+                }
+                clock_gettime(CLOCK_MONOTONIC, &stop);
+                double time = (stop.tv_sec - start.tv_sec + 1e-9 * (stop.tv_nsec - start.tv_nsec)) / ROWS_TRIALS;
+                fprintf(file, "%zu, %zu, %ld, %s, %10.10f, %.4f, %.3e\n", cols, rows, threads, names[v], time,
+                        2.0 * ROWS_ELEMENTS * elem / time * 1e-9, maxError);
+                pool_destroy();
+            }
+        }
+    }
+
+    free(matrix);
+    free(norms);
+    fclose(file);
+}
+
+/* sqrt(x) and a / sqrt(b) as they are computed without the fused kernels: fastInvSqrt into out and a second
+pass over out. vals holds x, or a followed by b (2 * n values). */
+static void twoPassSqrt_flt(size_t n, float vals[], float out[])
+{
+    fastInvSqrt_flt(n, vals, out);
+    for (size_t i = 0; i < n; i++)
+    {
+        out[i] *= vals[i];
+    }
+}
+
+static void twoPassMul_flt(size_t n, float vals[], float out[])
+{
+    fastInvSqrt_flt(n, vals + n, out);
+    for (size_t i = 0; i < n; i++)
+    {
+        out[i] *= vals[i];
+    }
+}
+
+static void twoPassSqrt_dbl(size_t n, double vals[], double out[])
+{
+    fastInvSqrt_dbl(n, vals, out);
+    for (size_t i = 0; i < n; i++)
+    {
+        out[i] *= vals[i];
+    }
+}
+
+static void twoPassMul_dbl(size_t n, double vals[], double out[])
+{
+    fastInvSqrt_dbl(n, vals + n, out);
+    for (size_t i = 0; i < n; i++)
+    {
+        out[i] *= vals[i];
+    }
+}
+
+// Wrappers with the kernel signature, so that bench_run can measure the fused kernels
+static void fusedSqrt_flt(size_t n, float vals[], float out[])
+{
+    fastSqrt_flt(n, vals, out);
+}
+
+static void fusedSqrt_flt_AVX2(size_t n, float vals[], float out[])
+{
+    fastSqrt_flt_AVX2(n, vals, out);
+}
+
+static void fusedMul_flt(size_t n, float vals[], float out[])
+{
+    mulInvSqrt_flt(n, vals, vals + n, out);
+}
+
+static void fusedMul_flt_AVX2(size_t n, float vals[], float out[])
+{
+    mulInvSqrt_flt_AVX2(n, vals, vals + n, out);
+}
+
+static void fusedSqrt_dbl(size_t n, double vals[], double out[])
+{
+    fastSqrt_dbl(n, vals, out);
+}
+
+static void fusedSqrt_dbl_AVX2(size_t n, double vals[], double out[])
+{
+    fastSqrt_dbl_AVX2(n, vals, out);
+}
+
+static void fusedMul_dbl(size_t n, double vals[], double out[])
+{
+    mulInvSqrt_dbl(n, vals, vals + n, out);
+}
+
+static void fusedMul_dbl_AVX2(size_t n, double vals[], double out[])
+{
+    mulInvSqrt_dbl_AVX2(n, vals, vals + n, out);
+}
+
+static const struct
+{
+    const char *name;
+    int arrays;   // Number of arrays read and written
+    int features; // CpuFeature flags required by the kernel
+    Func fn[2];
+} fusedKernels[] = {
+    {"sqrt_twoPass", 2, CPU_SSE2, {{.fn_flt = twoPassSqrt_flt}, {.fn_dbl = twoPassSqrt_dbl}}},
+    {"fastSqrt", 2, CPU_SSE2, {{.fn_flt = fusedSqrt_flt}, {.fn_dbl = fusedSqrt_dbl}}},
+    {"fastSqrt_AVX2", 2, CPU_AVX2 | CPU_FMA, {{.fn_flt = fusedSqrt_flt_AVX2}, {.fn_dbl = fusedSqrt_dbl_AVX2}}},
+    {"mul_twoPass", 3, CPU_SSE2, {{.fn_flt = twoPassMul_flt}, {.fn_dbl = twoPassMul_dbl}}},
+    {"mulInvSqrt", 3, CPU_SSE2, {{.fn_flt = fusedMul_flt}, {.fn_dbl = fusedMul_dbl}}},
+    {"mulInvSqrt_AVX2", 3, CPU_AVX2 | CPU_FMA, {{.fn_flt = fusedMul_flt_AVX2}, {.fn_dbl = fusedMul_dbl_AVX2}}},
+};
+
+void benchmarkFused(int db)
+{
+    const char *path = db ? "./benchmark_outputs/results_fused_dbl.csv" : "./benchmark_outputs/results_fused_flt.csv";
+    FILE *file;
+    if (!(file = fopen(path, "w+")))
+    {
+        perror("Error opening file");
+        exit(EXIT_FAILURE);
+    }
+    printf("Running benchmark of the fused sqrt and a/sqrt(b) kernels for %s...\n", db ? "doubles" : "floats");
+    printf("Results will be stored in %s\n\n", path);
+    fprintf(file, "sampleSize, version, timeMedian, cyclesPerElement, GBps\n"); // print header for .csv file
+
+    // Create arrays with samples (a followed by b) and output array and handle malloc failures
+    size_t elem = db ? sizeof(double) : sizeof(float);
+    void *sample = aligned_alloc(CACHE_LINE, 2 * FUSED_MAX_N * elem);
+    void *result = aligned_alloc(CACHE_LINE, FUSED_MAX_N * elem);
+    if (!sample || !result)
+    {
+        perror("Error allocating memory for sample and result arrays");
+        free(sample);
+        free(result);
+        fclose(file);
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < 2 * FUSED_MAX_N; i++)
+    {
+        double value = ((i * 2654435761u) % 1000000 + 1) * 1e-3;
+        if (db)
+        {
+            ((double *)sample)[i] = value;
+        }
+        else
+        {
+            ((float *)sample)[i] = value;
+        }
+    }
+
+    for (size_t n = FUSED_MIN_N; n <= FUSED_MAX_N; n *= 16)
+    {
+        for (size_t v = 0; v < sizeof fusedKernels / sizeof *fusedKernels; v++)
+        {
+            if (cpu_supports(fusedKernels[v].features))
+            {
+                struct BenchResult res;
+                bench_run(db, fusedKernels[v].fn[db], n, sample, result, &res);
+                fprintf(file, "%zu, %s, %10.10f, %.4f, %.4f\n", n, fusedKernels[v].name, res.median, res.cyclesPerElement,
+                        fusedKernels[v].arrays * n * elem / res.median * 1e-9);
+            }
+        }
+    }
+
+    free(sample);
+    free(result);
+    fclose(file);
+}
+
+/* Conversion passes of the widening baseline, which converts the 16-bit arrays to float, calls fastInvSqrt_flt_AVX2
+and converts the results back. They use the same instructions as the 16-bit kernels. */
+__attribute__((target("avx2,f16c"))) static void widen_f16(size_t n, const uint16_t *in, float *out)
+{
+    size_t j;
+    for (j = 0; j + 8 <= n; j += 8)
+    {
+        _mm256_storeu_ps(&out[j], _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)&in[j])));
+    }
+    for (; j < n; j++)
+    {
+        out[j] = _cvtsh_ss(in[j]);
+    }
+}
+
+__attribute__((target("avx2,f16c"))) static void narrow_f16(size_t n, const float *in, uint16_t *out)
+{
+    size_t j;
+    for (j = 0; j + 8 <= n; j += 8)
+    {
+        _mm_storeu_si128((__m128i *)&out[j], _mm256_cvtps_ph(_mm256_loadu_ps(&in[j]), _MM_FROUND_TO_NEAREST_INT));
+    }
+    for (; j < n; j++)
+    {
+        out[j] = _cvtss_sh(in[j], _MM_FROUND_TO_NEAREST_INT);
+    }
+}
+
+__attribute__((target("avx2"))) static void widen_bf16(size_t n, const uint16_t *in, float *out)
+{
+    size_t j;
+    for (j = 0; j + 8 <= n; j += 8)
+    {
+        __m256i u = _mm256_slli_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)&in[j])), 16);
+        _mm256_storeu_ps(&out[j], _mm256_castsi256_ps(u));
+    }
+    for (; j < n; j++)
+    {
+        uint32_t u = (uint32_t)in[j] << 16;
+        memcpy(&out[j], &u, sizeof u);
+    }
+}
+
+__attribute__((target("avx2"))) static void narrow_bf16(size_t n, const float *in, uint16_t *out)
+{
+    size_t j;
+    for (j = 0; j + 8 <= n; j += 8)
+    {
+        __m256i u = _mm256_castps_si256(_mm256_loadu_ps(&in[j]));
+        __m256i odd = _mm256_and_si256(_mm256_srli_epi32(u, 16), _mm256_set1_epi32(1));
+        u = _mm256_srli_epi32(_mm256_add_epi32(u, _mm256_add_epi32(odd, _mm256_set1_epi32(0x7FFF))), 16); // Round to nearest even
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(u, _mm256_setzero_si256()), 0x08);
+        _mm_storeu_si128((__m128i *)&out[j], _mm256_castsi256_si128(packed));
+    }
+    for (; j < n; j++)
+    {
+        uint32_t u;
+        memcpy(&u, &in[j], sizeof u);
+        out[j] = (u + 0x7FFF + ((u >> 16) & 1)) >> 16;
+    }
+}
+
+static float *halfScratch; // Float array of the widening baseline, HALF_MAX_N values
+
+// Wrappers with the kernel signature, so that bench_run can measure the 16-bit kernels. vals and out hold n 16-bit values.
+static void widened_f16(size_t n, float vals[], float out[])
+{
+    widen_f16(n, (const uint16_t *)vals, halfScratch);
+    fastInvSqrt_flt_AVX2(n, halfScratch, halfScratch);
+    narrow_f16(n, halfScratch, (uint16_t *)out);
+}
+
+static void direct_f16(size_t n, float vals[], float out[])
+{
+    fastInvSqrt_f16(n, (const uint16_t *)vals, (uint16_t *)out);
+}
+
+static void direct_f16_AVX512(size_t n, float vals[], float out[])
+{
+    fastInvSqrt_f16_AVX512(n, (const uint16_t *)vals, (uint16_t *)out);
+}
+
+static void widened_bf16(size_t n, float vals[], float out[])
+{
+    widen_bf16(n, (const uint16_t *)vals, halfScratch);
+    fastInvSqrt_flt_AVX2(n, halfScratch, halfScratch);
+    narrow_bf16(n, halfScratch, (uint16_t *)out);
+}
+
+static void direct_bf16(size_t n, float vals[], float out[])
+{
+    fastInvSqrt_bf16(n, (const uint16_t *)vals, (uint16_t *)out);
+}
+
+static void direct_bf16_AVX512(size_t n, float vals[], float out[])
+{
+    fastInvSqrt_bf16_AVX512(n, (const uint16_t *)vals, (uint16_t *)out);
+}
+
+static const struct
+{
+    const char *name;
+    int bf;       // 0 for half precision, 1 for bfloat16
+    int features; // CpuFeature flags required by the kernel
+    Func fn;
+} halfKernels[] = {
+    {"f16_widened", 0, CPU_AVX2 | CPU_FMA | CPU_F16C, {.fn_flt = widened_f16}},
+    {"f16", 0, CPU_F16C, {.fn_flt = direct_f16}},
+    {"f16_AVX512", 0, CPU_AVX512F, {.fn_flt = direct_f16_AVX512}},
+    {"bf16_widened", 1, CPU_AVX2 | CPU_FMA, {.fn_flt = widened_bf16}},
+    {"bf16", 1, CPU_AVX2, {.fn_flt = direct_bf16}},
+    {"bf16_AVX512", 1, CPU_AVX512F, {.fn_flt = direct_bf16_AVX512}},
+};
+
+void benchmarkHalf(void)
+{
+    const char *path = "./benchmark_outputs/results_half.csv";
+    FILE *file;
+    if (!(file = fopen(path, "w+")))
+    {
+        perror("Error opening file");
+        exit(EXIT_FAILURE);
+    }
+    printf("Running benchmark of the half precision and bfloat16 kernels...\n");
+    printf("Results will be stored in %s\n\n", path);
+    fprintf(file, "sampleSize, version, timeMedian, cyclesPerElement, GBps, maxRelError\n"); // print header for .csv file
+
+    // Create arrays with random samples of both formats, the output array and the float array of the baseline
+    uint16_t *sample[2] = {aligned_alloc(CACHE_LINE, HALF_MAX_N * sizeof(uint16_t)), aligned_alloc(CACHE_LINE, HALF_MAX_N * sizeof(uint16_t))};
+    uint16_t *result = aligned_alloc(CACHE_LINE, HALF_MAX_N * sizeof(uint16_t));
+    halfScratch = aligned_alloc(CACHE_LINE, HALF_MAX_N * sizeof(float));
+    if (!sample[0] || !sample[1] || !result || !halfScratch)
+    {
+        perror("Error allocating memory for sample and result arrays");
+        free(sample[0]);
+        free(sample[1]);
+        free(result);
+        free(halfScratch);
+        fclose(file);
+        exit(EXIT_FAILURE);
+    }
+    // Both formats cover the range of the positive normal half precision values [2^-14, 2^16). For bfloat16 values close to
+    // FLT_MIN, x / 2 would be subnormal and the slow microcode assists would dominate the measured time.
+    for (size_t i = 0; i < HALF_MAX_N; i++)
+    {
+        sample[0][i] = 0x0400 + (i * 2654435761u) % (0x7C00 - 0x0400);
+        sample[1][i] = 0x3880 + (i * 2654435761u) % (0x4780 - 0x3880);
+    }
+
+    for (size_t n = HALF_MIN_N; n <= HALF_MAX_N; n *= 16)
+    {
+        for (size_t v = 0; v < sizeof halfKernels / sizeof *halfKernels; v++)
+        {
+            int bf = halfKernels[v].bf;
+            // The results are checked with the conversion passes of the baseline
+            if (!cpu_supports(halfKernels[v].features) || !cpu_supports(bf ? CPU_AVX2 : CPU_AVX2 | CPU_F16C))
+            {
+                continue;
+            }
+            struct BenchResult res;
+            bench_run(0, halfKernels[v].fn, n, sample[bf], result, &res);
+
+            // Relative error of the results against 1/sqrt in double precision, both widened to float
+            float *x = halfScratch;
+            float y[256];
+            double maxError = 0.0;
+            for (size_t i = 0; i < n; i += 256)
+            {
+                size_t count = n - i < 256 ? n - i : 256;
+                (bf ? widen_bf16 : widen_f16)(count, &sample[bf][i], x);
+                (bf ? widen_bf16 : widen_f16)(count, &result[i], y);
+                for (size_t k = 0; k < count; k++)
+                {
+                    double error = fabs(y[k] * sqrt((double)x[k]) - 1.0);
+                    maxError = error > maxError ? error : maxError;
+                }
+            }
+            fprintf(file, "%zu, %s, %10.10f, %.4f, %.4f, %.3e\n", n, halfKernels[v].name, res.median, res.cyclesPerElement,
+                    2 * n * sizeof(uint16_t) / res.median * 1e-9, maxError);
+        }
+    }
+
+    free(sample[0]);
+    free(sample[1]);
+    free(result);
+    free(halfScratch);
+    fclose(file);
+}
+
+static const struct
+{
+    const char *name;
+    int features; // CpuFeature flags required by the kernel
+    void (*fn)(size_t, double *, double *);
+} mixedKernels[] = {
+    {"native", CPU_SSE2, nativeSqrt_dbl},
+    {"DoubleNewton", CPU_SSE2, fastInvSqrt_dbl_DoubleNewton},
+    {"AVX2_DoubleNewton", CPU_AVX2 | CPU_FMA, fastInvSqrt_dbl_AVX2_DoubleNewton},
+    {"AVX512_DoubleNewton", CPU_AVX512F, fastInvSqrt_dbl_AVX512_DoubleNewton},
+    {"AVX512_RSQRT14_DoubleNewton", CPU_AVX512F, fastInvSqrt_dbl_AVX512_RSQRT14_DoubleNewton},
+    {"AVX2_Mixed", CPU_AVX2 | CPU_FMA, fastInvSqrt_dbl_AVX2_Mixed},
+    {"AVX2_Mixed_DoubleNewton", CPU_AVX2 | CPU_FMA, fastInvSqrt_dbl_AVX2_Mixed_DoubleNewton},
+    {"AVX512_Mixed", CPU_AVX512F, fastInvSqrt_dbl_AVX512_Mixed},
+    {"AVX512_Mixed_DoubleNewton", CPU_AVX512F, fastInvSqrt_dbl_AVX512_Mixed_DoubleNewton},
+};
+
+void benchmarkMixed(void)
+{
+    const char *path = "./benchmark_outputs/results_mixed.csv";
+    FILE *file;
+    if (!(file = fopen(path, "w+")))
+    {
+        perror("Error opening file");
+        exit(EXIT_FAILURE);
+    }
+    printf("Running benchmark of the mixed-precision double kernels...\n");
+    printf("Results will be stored in %s\n\n", path);
+    fprintf(file, "sampleSize, version, timeMedian, cyclesPerElement, GBps, maxRelError\n"); // print header for .csv file
+
+    // Random positive normal doubles of all binades, so that the range reduction of the mixed kernels is covered
+    const size_t sizes[] = MIXED_SIZES;
+    size_t maxN = sizes[sizeof sizes / sizeof *sizes - 1];
+    double *sample = aligned_alloc(CACHE_LINE, maxN * sizeof(double));
+    double *result = aligned_alloc(CACHE_LINE, maxN * sizeof(double));
+    if (!sample || !result)
+    {
+        perror("Error allocating memory for sample and result arrays");
+        free(sample);
+        free(result);
+        fclose(file);
+        exit(EXIT_FAILURE);
+    }
+    srand(time(0));
+    for (size_t i = 0; i < maxN; i++)
+    {
+        union
+        {
+            double d;
+            uint64_t u;
+        } conv = {.u = (uint64_t)(1 + rand() % 2046) << 52 | (((uint64_t)rand() << 31 ^ (uint64_t)rand()) & 0x000FFFFFFFFFFFFF)};
+        sample[i] = conv.d;
+    }
+
+    for (size_t s = 0; s < sizeof sizes / sizeof *sizes; s++)
+    {
+        size_t n = sizes[s];
+        for (size_t v = 0; v < sizeof mixedKernels / sizeof *mixedKernels; v++)
+        {
+            if (!cpu_supports(mixedKernels[v].features))
+            {
+                continue;
+            }
+            struct BenchResult res;
+            bench_run(1, (Func){.fn_dbl = mixedKernels[v].fn}, n, sample, result, &res);
+
+            // Relative error in extended precision, as the best kernels are close to the rounding error of doubles
+            long double maxError = 0.0L;
+            for (size_t i = 0; i < n; i++)
+            {
+                long double error = fabsl(result[i] * sqrtl(sample[i]) - 1.0L);
+                maxError = error > maxError ? error : maxError;
+            }
+            fprintf(file, "%zu, %s, %10.10f, %.4f, %.4f, %.3Le\n", n, mixedKernels[v].name, res.median, res.cyclesPerElement, res.gbps, maxError);
+        }
+    }
+
+    free(sample);
+    free(result);
+    fclose(file);
+}
+
+static void *convertScratch; // Array of the conversion pass of the two-pass baseline, the largest size of CONVERT_SIZES in doubles
+
+// Wrappers with the kernel signature, so that bench_run can measure the mixed-type kernels. The baseline converts the whole
+// array first and then calls the kernel of the computation type. vals holds n doubles or floats, out n values of the other type.
+static void twoPass_dbl_flt(size_t n, float vals[], float out[])
+{
+    const double *in = (const double *)vals;
+    float *tmp = convertScratch;
+    for (size_t i = 0; i < n; i++)
+    {
+        tmp[i] = (float)in[i];
+    }
+    fastInvSqrt_flt_AVX2(n, tmp, out);
+}
+
+static void direct_dbl_flt(size_t n, float vals[], float out[])
+{
+    fastInvSqrt_dbl_flt(n, (const double *)vals, out);
+}
+
+static void direct_dbl_flt_AVX2(size_t n, float vals[], float out[])
+{
+    fastInvSqrt_dbl_flt_AVX2(n, (const double *)vals, out);
+}
+
+static void twoPass_flt_dbl(size_t n, float vals[], float out[])
+{
+    double *tmp = convertScratch;
+    for (size_t i = 0; i < n; i++)
+    {
+        tmp[i] = vals[i];
+    }
+    fastInvSqrt_dbl_AVX2(n, tmp, (double *)out);
+}
+
+static void direct_flt_dbl(size_t n, float vals[], float out[])
+{
+    fastInvSqrt_flt_dbl(n, vals, (double *)out);
+}
+
+static void direct_flt_dbl_AVX2(size_t n, float vals[], float out[])
+{
+    fastInvSqrt_flt_dbl_AVX2(n, vals, (double *)out);
+}
+
+static const struct
+{
+    const char *name;
+    int db;       // Type of the input, db = 1 for double input and float output
+    int features; // CpuFeature flags required by the kernel
+    Func fn;
+} convertKernels[] = {
+    {"dbl_flt_twoPass", 1, CPU_AVX2 | CPU_FMA, {.fn_flt = twoPass_dbl_flt}},
+    {"dbl_flt", 1, CPU_SSE2, {.fn_flt = direct_dbl_flt}},
+    {"dbl_flt_AVX2", 1, CPU_AVX2 | CPU_FMA, {.fn_flt = direct_dbl_flt_AVX2}},
+    {"flt_dbl_twoPass", 0, CPU_AVX2 | CPU_FMA, {.fn_flt = twoPass_flt_dbl}},
+    {"flt_dbl", 0, CPU_SSE2, {.fn_flt = direct_flt_dbl}},
+    {"flt_dbl_AVX2", 0, CPU_AVX2 | CPU_FMA, {.fn_flt = direct_flt_dbl_AVX2}},
+};
+
+void benchmarkConvert(void)
+{
+    const char *path = "./benchmark_outputs/results_convert.csv";
+    FILE *file;
+    if (!(file = fopen(path, "w+")))
+    {
+        perror("Error opening file");
+        exit(EXIT_FAILURE);
+    }
+    printf("Running benchmark of the mixed-type kernels...\n");
+    printf("Results will be stored in %s\n\n", path);
+    fprintf(file, "sampleSize, version, timeMedian, cyclesPerElement, GBps\n"); // print header for .csv file
+
+    // Create the input arrays of both types with the same values, the output array and the array of the conversion pass
+    const size_t sizes[] = CONVERT_SIZES;
+    size_t maxN = sizes[sizeof sizes / sizeof *sizes - 1];
+    void *sample[2] = {aligned_alloc(CACHE_LINE, maxN * sizeof(float)), aligned_alloc(CACHE_LINE, maxN * sizeof(double))};
+    void *result = aligned_alloc(CACHE_LINE, maxN * sizeof(double));
+    convertScratch = aligned_alloc(CACHE_LINE, maxN * sizeof(double));
+    if (!sample[0] || !sample[1] || !result || !convertScratch)
+    {
+        perror("Error allocating memory for sample and result arrays");
+        free(sample[0]);
+        free(sample[1]);
+        free(result);
+        free(convertScratch);
+        fclose(file);
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < maxN; i++)
+    {
+        double value = ((i * 2654435761u) % 1000000 + 1) * 1e-3;
+        ((float *)sample[0])[i] = value;
+        ((double *)sample[1])[i] = value;
+    }
+
+    for (size_t s = 0; s < sizeof sizes / sizeof *sizes; s++)
+    {
+        size_t n = sizes[s];
+        for (size_t v = 0; v < sizeof convertKernels / sizeof *convertKernels; v++)
+        {
+            if (cpu_supports(convertKernels[v].features))
+            {
+                struct BenchResult res;
+                bench_run(0, convertKernels[v].fn, n, sample[convertKernels[v].db], result, &res);
+                fprintf(file, "%zu, %s, %10.10f, %.4f, %.4f\n", n, convertKernels[v].name, res.median, res.cyclesPerElement,
+                        n * (sizeof(float) + sizeof(double)) / res.median * 1e-9);
+            }
+        }
+    }
+
+    free(sample[0]);
+    free(sample[1]);
+    free(result);
+    free(convertScratch);
+    fclose(file);
+}
+
+#define MATRIX_DB_flt 0
+#define MATRIX_DB_dbl 1
+#define MATRIX_ROW(T, W, U, N, MAGIC, TAG, ERR, COST) \
+    {MATRIX_DB_##T, "gen_" #W "_u" #U "_n" #N "_" #TAG, #W, U, N, #TAG, GEN_FEATURES_##W, {.fn_##T = GEN_NAME(T, W, U, N, TAG)}},
+
+static const struct
+{
+    int db;
+    const char *name;  // Name in the versions table
+    const char *width; // Parameters of the kernel, see kernelgen.h
+    int unroll;
+    int newton;
+    const char *magic;
+    int features; // CpuFeature flags required by the kernel
+    Func fn;
+} matrixKernels[] = {KERNEL_MATRIX_FLT(MATRIX_ROW) KERNEL_MATRIX_DBL(MATRIX_ROW)};
+
+void benchmarkKernelMatrix(void)
+{
+    const char *path = "./benchmark_outputs/results_kernelmatrix.csv";
+    FILE *file;
+    if (!(file = fopen(path, "w+")))
+    {
+        perror("Error opening file");
+        exit(EXIT_FAILURE);
+    }
+    printf("Running benchmark of the kernel matrix...\n");
+    printf("Results will be stored in %s\n\n", path);
+    fprintf(file, "type, sampleSize, version, width, unroll, newton, magic, timeMedian, cyclesPerElement, GBps, maxRelError\n"); // print header for .csv file
+
+    // Create the input arrays of both types with the same values and the output array
+    const size_t sizes[] = MATRIX_SIZES;
+    size_t maxN = sizes[sizeof sizes / sizeof *sizes - 1];
+    void *sample[2] = {aligned_alloc(CACHE_LINE, maxN * sizeof(float)), aligned_alloc(CACHE_LINE, maxN * sizeof(double))};
+    void *result = aligned_alloc(CACHE_LINE, maxN * sizeof(double));
+    if (!sample[0] || !sample[1] || !result)
+    {
+        perror("Error allocating memory for sample and result arrays");
+        free(sample[0]);
+        free(sample[1]);
+        free(result);
+        fclose(file);
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < maxN; i++)
+    {
+        double value = ((i * 2654435761u) % 1000000 + 1) * 1e-3;
+        ((float *)sample[0])[i] = value;
+        ((double *)sample[1])[i] = value;
+    }
+
+    for (size_t s = 0; s < sizeof sizes / sizeof *sizes; s++)
+    {
+        size_t n = sizes[s];
+        size_t fastest[2][4] = {{SIZE_MAX, SIZE_MAX, SIZE_MAX, SIZE_MAX}, {SIZE_MAX, SIZE_MAX, SIZE_MAX, SIZE_MAX}}; // Per type and Newton count
+        double fastestCycles[2][4];
+        for (size_t v = 0; v < sizeof matrixKernels / sizeof *matrixKernels; v++)
+        {
+            int db = matrixKernels[v].db;
+            if (!cpu_supports(matrixKernels[v].features))
+            {
+                continue;
+            }
+            struct BenchResult res;
+            bench_run(db, matrixKernels[v].fn, n, sample[db], result, &res);
+
+            double maxError = 0.0;
+            for (size_t i = 0; i < n; i++)
+            {
+                double x = db ? ((double *)sample[1])[i] : ((float *)sample[0])[i];
+                double y = db ? ((double *)result)[i] : ((float *)result)[i];
+                double error = fabs(y * sqrt(x) - 1.0);
+                maxError = error > maxError ? error : maxError;
+            }
+            fprintf(file, "%s, %zu, %s, %s, %d, %d, %s, %10.10f, %.4f, %.4f, %.3e\n", db ? "double" : "float", n, matrixKernels[v].name,
+                    matrixKernels[v].width, matrixKernels[v].unroll, matrixKernels[v].newton, matrixKernels[v].magic, res.median,
+                    res.cyclesPerElement, res.gbps, maxError);
+
+            int newton = matrixKernels[v].newton;
+            if (fastest[db][newton] == SIZE_MAX || res.cyclesPerElement < fastestCycles[db][newton])
+            {
+                fastest[db][newton] = v;
+                fastestCycles[db][newton] = res.cyclesPerElement;
+            }
+        }
+
+        // Report the fastest configuration of this CPU for every type and number of Newton iterations
+        for (int db = 0; db < 2; db++)
+        {
+            for (int newton = 0; newton < 4; newton++)
+            {
+                if (fastest[db][newton] != SIZE_MAX)
+                {
+                    printf("Fastest %s kernel with %d Newton iteration(s) for %zu values: %s (%.4f cycles per element)\n", db ? "double" : "float",
+                           newton, n, matrixKernels[fastest[db][newton]].name, fastestCycles[db][newton]);
+                }
+            }
+        }
+    }
+    printf("\n");
+
+    free(sample[0]);
+    free(sample[1]);
+    free(result);
+    fclose(file);
+}
+
+// The formatter benchmark stores the length of the text of every value in out, the text itself is overwritten
+static void shortest_flt(size_t n, float vals[n], float out[n])
+{
+    char buf[FORMAT_MAX];
+    for (size_t i = 0; i < n; i++)
+    {
+        out[i] = format_shortest_flt(buf, vals[i]);
+    }
+}
+
+static void printfShortest_flt(size_t n, float vals[n], float out[n])
+{
+    char buf[FORMAT_MAX];
+    for (size_t i = 0; i < n; i++)
+    {
+        out[i] = snprintf(buf, FORMAT_MAX, "%.9g", vals[i]);
+    }
+}
+
+static void fixed_flt(size_t n, float vals[n], float out[n])
+{
+    char buf[FORMAT_MAX];
+    for (size_t i = 0; i < n; i++)
+    {
+        out[i] = format_fixed(buf, vals[i], FORMAT_PRECISION);
+    }
+}
+
+static void printfFixed_flt(size_t n, float vals[n], float out[n])
+{
+    char buf[FORMAT_MAX];
+    for (size_t i = 0; i < n; i++)
+    {
+        out[i] = snprintf(buf, FORMAT_MAX, "%.*f", FORMAT_PRECISION, vals[i]);
+    }
+}
+
+static void shortest_dbl(size_t n, double vals[n], double out[n])
+{
+    char buf[FORMAT_MAX];
+    for (size_t i = 0; i < n; i++)
+    {
+        out[i] = format_shortest_dbl(buf, vals[i]);
+    }
+}
+
+static void printfShortest_dbl(size_t n, double vals[n], double out[n])
+{
+    char buf[FORMAT_MAX];
+    for (size_t i = 0; i < n; i++)
+    {
+        out[i] = snprintf(buf, FORMAT_MAX, "%.17g", vals[i]);
+    }
+}
+
+static void fixed_dbl(size_t n, double vals[n], double out[n])
+{
+    char buf[FORMAT_MAX];
+    for (size_t i = 0; i < n; i++)
+    {
+        out[i] = format_fixed(buf, vals[i], FORMAT_PRECISION);
+    }
+}
+
+static void printfFixed_dbl(size_t n, double vals[n], double out[n])
+{
+    char buf[FORMAT_MAX];
+    for (size_t i = 0; i < n; i++)
+    {
+        out[i] = snprintf(buf, FORMAT_MAX, "%.*f", FORMAT_PRECISION, vals[i]);
+    }
+}
+
+static const struct
+{
+    const char *name;
+    int db;
+    Func fn;
+} formatKernels[] = {
+    {"shortest", 0, {.fn_flt = shortest_flt}},
+    {"printf_%.9g", 0, {.fn_flt = printfShortest_flt}},
+    {"fixed", 0, {.fn_flt = fixed_flt}},
+    {"printf_%.10f", 0, {.fn_flt = printfFixed_flt}},
+    {"shortest", 1, {.fn_dbl = shortest_dbl}},
+    {"printf_%.17g", 1, {.fn_dbl = printfShortest_dbl}},
+    {"fixed", 1, {.fn_dbl = fixed_dbl}},
+    {"printf_%.10f", 1, {.fn_dbl = printfFixed_dbl}},
+};
+
+void benchmarkFormat(void)
+{
+    const char *path = "./benchmark_outputs/results_format.csv";
+    FILE *file;
+    if (!(file = fopen(path, "w+")))
+    {
+        perror("Error opening file");
+        exit(EXIT_FAILURE);
+    }
+    printf("Running benchmark of the output formatter...\n");
+    printf("Results will be stored in %s\n\n", path);
+    fprintf(file, "type, sampleSize, version, timeMedian, cyclesPerElement\n"); // print header for .csv file
+
+    void *sample[2] = {malloc(FORMAT_N * sizeof(float)), malloc(FORMAT_N * sizeof(double))};
+    void *result = malloc(FORMAT_N * sizeof(double));
+    if (!sample[0] || !sample[1] || !result)
+    {
+        perror("Error allocating memory for sample and result arrays");
+        free(sample[0]);
+        free(sample[1]);
+        free(result);
+        fclose(file);
+        exit(EXIT_FAILURE);
+    }
+    // Finite values of all binades including subnormal ones and both signs, from hashed bit patterns
+    for (size_t i = 0; i < FORMAT_N; i++)
+    {
+        union
+        {
+            float x;
+            uint32_t u;
+        } f = {.u = (uint32_t)(i * 2654435761u)};
+        union
+        {
+            double x;
+            uint64_t u;
+        } d = {.u = i * 0x9E3779B97F4A7C15ull};
+        if (!isfinite(f.x))
+        {
+            f.u ^= 0x40000000;
+        }
+        if (!isfinite(d.x))
+        {
+            d.u ^= 0x4000000000000000ull;
+        }
+        ((float *)sample[0])[i] = f.x;
+        ((double *)sample[1])[i] = d.x;
+    }
+
+    /* The shortest text has to be read back as exactly the same value as the %.9g/%.17g text, and the fixed text
+    has to be identical to the printf text */
+    size_t roundTrip[2] = {0, 0};
+    size_t fixedDiff[2] = {0, 0};
+    char text[FORMAT_MAX + 1];
+    char reference[FORMAT_MAX + 1];
+    for (size_t i = 0; i < FORMAT_N; i++)
+    {
+        float x = ((float *)sample[0])[i];
+        text[format_shortest_flt(text, x)] = '\0';
+        snprintf(reference, sizeof reference, "%.9g", x);
+        float y = strtof(text, NULL);
+        float z = strtof(reference, NULL);
+        roundTrip[0] += memcmp(&y, &z, sizeof y) != 0;
+        text[format_fixed(text, x, FORMAT_PRECISION)] = '\0';
+        snprintf(reference, sizeof reference, "%.*f", FORMAT_PRECISION, x);
+        fixedDiff[0] += strcmp(text, reference) != 0;
+
+        double xd = ((double *)sample[1])[i];
+        text[format_shortest_dbl(text, xd)] = '\0';
+        snprintf(reference, sizeof reference, "%.17g", xd);
+        double yd = strtod(text, NULL);
+        double zd = strtod(reference, NULL);
+        roundTrip[1] += memcmp(&yd, &zd, sizeof yd) != 0;
+        text[format_fixed(text, xd, FORMAT_PRECISION)] = '\0';
+        snprintf(reference, sizeof reference, "%.*f", FORMAT_PRECISION, xd);
+        fixedDiff[1] += strcmp(text, reference) != 0;
+    }
+    for (int db = 0; db < 2; db++)
+    {
+        printf("%s: %zu of %d shortest texts are not read back as the %s value, %zu fixed texts differ from printf\n",
+               db ? "double" : "float", roundTrip[db], FORMAT_N, db ? "%.17g" : "%.9g", fixedDiff[db]);
+    }
+    printf("\n");
+
+    for (size_t v = 0; v < sizeof formatKernels / sizeof *formatKernels; v++)
+    {
+        int db = formatKernels[v].db;
+        struct BenchResult res;
+        bench_run(db, formatKernels[v].fn, FORMAT_N, sample[db], result, &res);
+        fprintf(file, "%s, %d, %s, %10.10f, %.4f\n", db ? "double" : "float", FORMAT_N, formatKernels[v].name, res.median,
+                res.cyclesPerElement);
+    }
+
+    free(sample[0]);
+    free(sample[1]);
+    free(result);
+    fclose(file);
+}
+
 void runTests(void)
 {
+#if defined(__SANITIZE_ADDRESS__)
+    // GCC defines this macro with -fsanitize=address, the instrumentation distorts all measured times
+    printf("Warning: built with AddressSanitizer, the runtime benchmarks are not representative. Build with make bench and run ./main_bench -t\n\n");
+#endif
     // kick off all tests and benchmarks
     basicFunctionality_flt();
     basicFunctionality_dbl();
+    specialValues();
     plotRange();
 
     benchmarkAccuracy_flt();
@@ -550,4 +2220,20 @@ void runTests(void)
 
     benchmarkTime_flt_wrapper(MAXINCREMENTS);
     benchmarkTime_dbl_wrapper(MAXINCREMENTS);
+    benchmarkThreads(MAXINCREMENTS * STEPS);
+    benchmarkSizes(0);
+    benchmarkSizes(1);
+    benchmarkLatency(0);
+    benchmarkLatency(1);
+    benchmarkNormalize(0);
+    benchmarkNormalize(1);
+    benchmarkRows(0);
+    benchmarkRows(1);
+    benchmarkFused(0);
+    benchmarkFused(1);
+    benchmarkHalf();
+    benchmarkMixed();
+    benchmarkConvert();
+    benchmarkKernelMatrix();
+    benchmarkFormat();
 }
\ No newline at end of file
@@ -0,0 +1,294 @@
+/** @file threadpool.c
+ *  @brief Implementation of the persistent worker pool
+ *  @details For details of each function see threadpool.h
+ *  @author Yll Kryeziu (ge94noh)
+ */
+
+#define _GNU_SOURCE // pthread_setaffinity_np
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "../include/threadpool.h"
+
+// State of the pool, shared by all threads and protected by lock
+static struct
+{
+    pthread_t *threads;    // Worker threads 1 .. size - 1
+    int size;              // Total number of threads including the caller
+    int cpus[CPU_SETSIZE]; // CPUs the process may run on, in ascending order
+    int ncpus;             // Number of entries in cpus, 0 if the affinity mask is unknown
+    cpu_set_t caller;      // Affinity mask of the calling thread before pool_init, restored by pool_destroy
+    pthread_mutex_t lock;
+    pthread_cond_t start;  // Signalled when a new job is published
+    pthread_cond_t done;   // Signalled when the last worker finished its chunk
+    unsigned long job;     // Incremented for each job, workers compare it to the last job they ran
+    int pending;           // Number of workers which have not finished the current job
+    int stop;              // Set to shut the workers down
+    void (*task)(size_t, size_t, void *);
+    void *arg;
+    size_t n;
+    size_t chunk;          // Elements per thread, multiple of the grain
+} pool = {
+    .size = 1,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .start = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+};
+
+// Pin the given thread to a core, thread i is placed on the i-th CPU of the affinity mask modulo their number
+static void pin_thread(pthread_t thread, int i)
+{
+    if (!pool.ncpus)
+    {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(pool.cpus[i % pool.ncpus], &set);
+    pthread_setaffinity_np(thread, sizeof set, &set); // Pinning is only an optimisation, so failures are ignored
+}
+
+// Process the chunk of thread i of the current job
+static void run_chunk(int i, void (*task)(size_t, size_t, void *), void *arg, size_t n, size_t chunk)
+{
+    size_t begin = i * chunk;
+    if (begin >= n)
+    {
+        return;
+    }
+    size_t end = n - begin < chunk ? n : begin + chunk;
+    task(begin, end, arg);
+}
+
+static void *worker(void *param)
+{
+    int i = (int)(size_t)param;
+    unsigned long seen = 0;
+
+    pthread_mutex_lock(&pool.lock);
+    for (;;)
+    {
+        while (pool.job == seen && !pool.stop)
+        {
+            pthread_cond_wait(&pool.start, &pool.lock);
+        }
+        if (pool.stop)
+        {
+            break;
+        }
+        seen = pool.job;
+        void (*task)(size_t, size_t, void *) = pool.task;
+        void *arg = pool.arg;
+        size_t n = pool.n;
+        size_t chunk = pool.chunk;
+        pthread_mutex_unlock(&pool.lock);
+
+        run_chunk(i, task, arg, n, chunk);
+
+        pthread_mutex_lock(&pool.lock);
+        if (--pool.pending == 0)
+        {
+            pthread_cond_signal(&pool.done);
+        }
+    }
+    pthread_mutex_unlock(&pool.lock);
+    return NULL;
+}
+
+int pool_init(int nthreads)
+{
+    pool_destroy();
+    if (nthreads <= 1)
+    {
+        return 0;
+    }
+
+    pool.threads = malloc((nthreads - 1) * sizeof *pool.threads);
+    if (!pool.threads)
+    {
+        perror("Error allocating memory for worker threads");
+        return -1;
+    }
+
+    /* Only use the CPUs the process may run on (taskset, cgroups). The mask of the caller is kept,
+    so that it runs unrestricted again after pool_destroy */
+    pool.ncpus = 0;
+    if (!pthread_getaffinity_np(pthread_self(), sizeof pool.caller, &pool.caller))
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu, &pool.caller))
+            {
+                pool.cpus[pool.ncpus++] = cpu;
+            }
+        }
+    }
+
+    pool.stop = 0;
+    pool.job = 0;
+    pin_thread(pthread_self(), 0);
+    for (int i = 1; i < nthreads; i++)
+    {
+        if (pthread_create(&pool.threads[i - 1], NULL, worker, (void *)(size_t)i))
+        {
+            fprintf(stderr, "Error creating worker thread %d\n", i);
+            pool.size = i; // Join the threads created so far
+            pool_destroy();
+            return -1;
+        }
+        pin_thread(pool.threads[i - 1], i);
+    }
+    pool.size = nthreads;
+    return 0;
+}
+
+void pool_destroy(void)
+{
+    if (pool.size <= 1)
+    {
+        return;
+    }
+    pthread_mutex_lock(&pool.lock);
+    pool.stop = 1;
+    pthread_cond_broadcast(&pool.start);
+    pthread_mutex_unlock(&pool.lock);
+
+    for (int i = 1; i < pool.size; i++)
+    {
+        pthread_join(pool.threads[i - 1], NULL);
+    }
+    free(pool.threads);
+    pool.threads = NULL;
+    pool.size = 1;
+    if (pool.ncpus)
+    {
+        pthread_setaffinity_np(pthread_self(), sizeof pool.caller, &pool.caller);
+    }
+}
+
+int pool_size(void)
+{
+    return pool.size;
+}
+
+void pool_run(size_t n, size_t grain, void (*task)(size_t begin, size_t end, void *arg), void *arg)
+{
+    if (pool.size <= 1 || n <= grain)
+    {
+        task(0, n, arg);
+        return;
+    }
+
+    // Divide evenly and round up to the grain, so every chunk but the last starts and ends on a grain boundary
+    size_t chunk = (n + pool.size - 1) / pool.size;
+    chunk = (chunk + grain - 1) / grain * grain;
+
+    pthread_mutex_lock(&pool.lock);
+    pool.task = task;
+    pool.arg = arg;
+    pool.n = n;
+    pool.chunk = chunk;
+    pool.pending = pool.size - 1;
+    pool.job++;
+    pthread_cond_broadcast(&pool.start);
+    pthread_mutex_unlock(&pool.lock);
+
+    run_chunk(0, task, arg, n, chunk); // The caller works on the first chunk itself
+
+    pthread_mutex_lock(&pool.lock);
+    while (pool.pending)
+    {
+        pthread_cond_wait(&pool.done, &pool.lock);
+    }
+    pthread_mutex_unlock(&pool.lock);
+}
+
+// Arguments of the tasks below
+struct Touch
+{
+    char *buf;
+    size_t size;
+};
+
+struct Kernel
+{
+    union
+    {
+        void (*flt)(size_t, float *, float *);
+        void (*dbl)(size_t, double *, double *);
+        void (*dbl_flt)(size_t, const double *, float *);
+        void (*flt_dbl)(size_t, const float *, double *);
+    } fn;
+    void *vals;
+    void *out;
+};
+
+static void touch_task(size_t begin, size_t end, void *arg)
+{
+    struct Touch *t = arg;
+    memset(t->buf + begin * t->size, 0, (end - begin) * t->size);
+}
+
+void *pool_alloc(size_t n, size_t size)
+{
+    // aligned_alloc requires the size to be a multiple of the alignment
+    size_t bytes = (n * size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+    char *buf = aligned_alloc(CACHE_LINE, bytes ? bytes : CACHE_LINE);
+    if (!buf)
+    {
+        return NULL;
+    }
+    struct Touch t = {buf, size};
+    pool_run(n, POOL_GRAIN, touch_task, &t);
+    return buf;
+}
+
+static void flt_task(size_t begin, size_t end, void *arg)
+{
+    struct Kernel *k = arg;
+    k->fn.flt(end - begin, (float *)k->vals + begin, (float *)k->out + begin);
+}
+
+static void dbl_task(size_t begin, size_t end, void *arg)
+{
+    struct Kernel *k = arg;
+    k->fn.dbl(end - begin, (double *)k->vals + begin, (double *)k->out + begin);
+}
+
+void parallelInvSqrt_flt(void (*fn)(size_t, float *, float *), size_t n, float vals[n], float out[n])
+{
+    struct Kernel k = {{.flt = fn}, vals, out};
+    pool_run(n, POOL_GRAIN, flt_task, &k);
+}
+
+void parallelInvSqrt_dbl(void (*fn)(size_t, double *, double *), size_t n, double vals[n], double out[n])
+{
+    struct Kernel k = {{.dbl = fn}, vals, out};
+    pool_run(n, POOL_GRAIN, dbl_task, &k);
+}
+
+static void dbl_flt_task(size_t begin, size_t end, void *arg)
+{
+    struct Kernel *k = arg;
+    k->fn.dbl_flt(end - begin, (double *)k->vals + begin, (float *)k->out + begin);
+}
+
+static void flt_dbl_task(size_t begin, size_t end, void *arg)
+{
+    struct Kernel *k = arg;
+    k->fn.flt_dbl(end - begin, (float *)k->vals + begin, (double *)k->out + begin);
+}
+
+void parallelInvSqrt_dbl_flt(void (*fn)(size_t, const double *, float *), size_t n, const double *vals, float *out)
+{
+    struct Kernel k = {{.dbl_flt = fn}, (void *)vals, out};
+    pool_run(n, POOL_GRAIN, dbl_flt_task, &k);
+}
+
+void parallelInvSqrt_flt_dbl(void (*fn)(size_t, const float *, double *), size_t n, const float *vals, double *out)
+{
+    struct Kernel k = {{.flt_dbl = fn}, (void *)vals, out};
+    pool_run(n, POOL_GRAIN, flt_dbl_task, &k);
+}